@@ -0,0 +1,42 @@
+#include "ansi_terminal.h"
+#include <cerrno>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace SnakeGame {
+
+AnsiTerminal::AnsiTerminal(int fd)
+    : fd(fd), columns(80), rows(24) {
+    querySize();
+    // Alternate screen, hidden cursor, cleared screen
+    write("\x1b[?1049h\x1b[?25l\x1b[2J");
+}
+
+AnsiTerminal::~AnsiTerminal() {
+    write("\x1b[0m\x1b[?25h\x1b[?1049l");
+}
+
+bool AnsiTerminal::write(const std::string& data) {
+    const char* cursor = data.data();
+    size_t remaining = data.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, cursor, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        cursor += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void AnsiTerminal::querySize() {
+    struct winsize size;
+    if (ioctl(fd, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0) {
+        columns = size.ws_col;
+        rows = size.ws_row;
+    }
+}
+
+} // namespace SnakeGame
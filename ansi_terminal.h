@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+namespace SnakeGame {
+
+// Minimal POSIX terminal output: takes over the screen on construction,
+// restores it on destruction, and sends each frame with a single write().
+class AnsiTerminal {
+public:
+    explicit AnsiTerminal(int fd = 1);
+    ~AnsiTerminal();
+
+    AnsiTerminal(const AnsiTerminal&) = delete;
+    AnsiTerminal& operator=(const AnsiTerminal&) = delete;
+
+    // Write all of data, retrying on short writes and EINTR
+    bool write(const std::string& data);
+
+    // Terminal size, or 80x24 when fd is not a terminal
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+    void querySize();
+
+private:
+    int fd;
+    int columns;
+    int rows;
+};
+
+} // namespace SnakeGame
@@ -0,0 +1,274 @@
+#include "arena.h"
+#include "rng.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace SnakeGame {
+
+namespace {
+
+constexpr int START_LENGTH = 3;
+constexpr int POINTS_PER_FOOD = 10;
+
+// Random spots tried for a new snake or food before waiting a tick
+constexpr int SPAWN_ATTEMPTS = 16;
+
+constexpr Direction DIRECTIONS[] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+
+const Point NOWHERE(-1, -1);
+
+int axisDistance(int a, int b, int size, bool wraps) {
+    int d = std::abs(a - b);
+    return wraps ? std::min(d, size - d) : d;
+}
+
+} // namespace
+
+Arena::Arena(const GameConfig& config, int snakeCount, int foodCount, uint32_t seed, int respawnTicks)
+    : config(config)
+    , snakes(snakeCount)
+    , food(foodCount, NOWHERE)
+    , foodCells(foodCount)
+    , occupancy(config.width, config.height)
+    , claims(snakeCount)
+    , rng(seed)
+    , tick(0)
+    , alive(0)
+    , respawnTicks(respawnTicks)
+    , missingFood(0) {
+    moves.reserve(snakeCount);
+    occupancy.enableFreeCellIndex(1, 1, config.width - 2, config.height - 2, true);
+    for (int i = 0; i < snakeCount; ++i) {
+        // A crowded board seats the rest as room frees up
+        if (!spawn(i)) snakes[i].respawnTick = 1;
+    }
+    for (size_t i = 0; i < food.size(); ++i) {
+        placeFood(i);
+    }
+}
+
+ArenaEvents Arena::step(const Direction* inputs) {
+    ArenaEvents events;
+    tick++;
+
+    if (alive < static_cast<int>(snakes.size())) {
+        for (int i = 0; i < static_cast<int>(snakes.size()); ++i) {
+            ArenaSnake& snake = snakes[i];
+            if (snake.alive || snake.respawnTick == 0 || tick < snake.respawnTick) continue;
+            if (spawn(i)) {
+                events.respawned++;
+            } else {
+                snake.respawnTick = tick + 1;
+            }
+        }
+    }
+    if (missingFood > 0) {
+        missingFood = 0;
+        for (size_t i = 0; i < food.size(); ++i) {
+            if (food[i] == NOWHERE) placeFood(i);
+        }
+    }
+
+    // Every head picks its cell; a cell picked twice is a head-on collision
+    moves.clear();
+    claims.clear();
+    for (int i = 0; i < static_cast<int>(snakes.size()); ++i) {
+        ArenaSnake& snake = snakes[i];
+        if (!snake.alive) continue;
+        Direction dir = snake.human ? (inputs ? inputs[i] : Direction::NONE) : botMove(i);
+        if (dir != Direction::NONE && !DirectionManager::isOpposite(dir, snake.heading)) {
+            snake.heading = dir;
+        }
+        bool offBoard;
+        Point head = ahead(snake.body.front(), snake.heading, offBoard);
+        moves.push_back({i, head, offBoard ? DeathCause::WALL_COLLISION : DeathCause::NONE});
+        if (offBoard) continue;
+        int first = claims.insert(SnakeBody::pack(head), static_cast<int>(moves.size() - 1));
+        if (first != CellHash::NOT_FOUND) {
+            moves[first].death = DeathCause::HEAD_ON_COLLISION;
+            moves.back().death = DeathCause::HEAD_ON_COLLISION;
+        }
+    }
+
+    // Tails out, then each head against every body in one lookup
+    for (const Move& move : moves) {
+        ArenaSnake& snake = snakes[move.snake];
+        occupancy.remove(snake.body.back());
+        snake.body.popBack();
+    }
+    for (Move& move : moves) {
+        if (move.death == DeathCause::NONE && occupancy.isOccupied(move.head)) {
+            move.death = DeathCause::SNAKE_COLLISION;
+        }
+    }
+
+    for (const Move& move : moves) {
+        if (move.death != DeathCause::NONE) {
+            kill(move.snake, move.death);
+            events.died++;
+            if (move.death == DeathCause::HEAD_ON_COLLISION) events.headOn++;
+            continue;
+        }
+        ArenaSnake& snake = snakes[move.snake];
+        snake.body.pushFront(move.head);
+        occupancy.add(move.head);
+    }
+
+    // Food last, so none respawns under a head that has not moved in yet
+    for (const Move& move : moves) {
+        if (move.death != DeathCause::NONE) continue;
+        uint32_t cell = SnakeBody::pack(move.head);
+        int eaten = foodCells.find(cell);
+        if (eaten == CellHash::NOT_FOUND) continue;
+        ArenaSnake& snake = snakes[move.snake];
+        snake.body.pushBack(snake.body.back());
+        occupancy.add(snake.body.back());
+        snake.score += POINTS_PER_FOOD;
+        events.ateFood++;
+        foodCells.erase(cell);
+        placeFood(eaten);
+    }
+
+    return events;
+}
+
+Direction Arena::botMove(int index) {
+    ArenaSnake& snake = snakes[index];
+    if (!isFood(snake.target) && !food.empty()) {
+        snake.target = food[boundedRandom(rng, static_cast<uint32_t>(food.size()))];
+    }
+
+    // Of the moves that do not hit anything now, the one nearest the food;
+    // boxed in, it carries on and dies
+    Point head = snake.body.front();
+    Direction best = snake.heading;
+    int bestDistance = INT_MAX;
+    for (Direction dir : DIRECTIONS) {
+        if (DirectionManager::isOpposite(dir, snake.heading)) continue;
+        bool offBoard;
+        Point next = ahead(head, dir, offBoard);
+        if (offBoard || occupancy.isOccupied(next)) continue;
+        int distance = snake.target == NOWHERE ? 0 :
+            axisDistance(next.x, snake.target.x, config.width, config.wrapAround) +
+            axisDistance(next.y, snake.target.y, config.height, config.wrapAround);
+        // Ties keep the heading, so a bot without a target runs straight
+        if (distance < bestDistance || (distance == bestDistance && dir == snake.heading)) {
+            best = dir;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+Point Arena::ahead(const Point& head, Direction dir, bool& offBoard) const {
+    Point next = head + DirectionManager::getDirectionVector(dir);
+    offBoard = false;
+    if (config.wrapAround) {
+        if (next.x < 0) next.x += config.width;
+        if (next.x >= config.width) next.x -= config.width;
+        if (next.y < 0) next.y += config.height;
+        if (next.y >= config.height) next.y -= config.height;
+    } else {
+        offBoard = !occupancy.contains(next);
+    }
+    return next;
+}
+
+void Arena::save(ArenaSnapshot& out) const {
+    out.snakes = snakes;
+    out.food = food;
+    out.rng = rng;
+    out.tick = tick;
+    out.alive = alive;
+    out.missingFood = missingFood;
+}
+
+void Arena::restore(const ArenaSnapshot& in) {
+    // Swap the bodies on the grid; draws only look at which cells are free
+    for (const ArenaSnake& snake : snakes) {
+        for (Point p : snake.body) occupancy.remove(p);
+    }
+    snakes = in.snakes;
+    for (const ArenaSnake& snake : snakes) {
+        for (Point p : snake.body) occupancy.add(p);
+    }
+    foodCells.clear();
+    food = in.food;
+    for (size_t i = 0; i < food.size(); ++i) {
+        if (food[i] != NOWHERE) foodCells.insert(SnakeBody::pack(food[i]), static_cast<int>(i));
+    }
+    rng = in.rng;
+    tick = in.tick;
+    alive = in.alive;
+    missingFood = in.missingFood;
+}
+
+bool Arena::spawn(int index) {
+    for (int attempt = 0; attempt < SPAWN_ATTEMPTS; ++attempt) {
+        Point head;
+        if (!occupancy.randomFreeCell(rng, head)) return false;
+        Direction heading = DIRECTIONS[boundedRandom(rng, 4)];
+
+        // The body trails behind the head and the cell in front is clear
+        Direction back = heading == Direction::UP ? Direction::DOWN :
+                         heading == Direction::DOWN ? Direction::UP :
+                         heading == Direction::LEFT ? Direction::RIGHT : Direction::LEFT;
+        Point cells[START_LENGTH + 1];
+        bool offBoard;
+        cells[0] = ahead(head, heading, offBoard);
+        bool clear = !offBoard;
+        cells[1] = head;
+        for (int i = 2; i <= START_LENGTH && clear; ++i) {
+            cells[i] = ahead(cells[i - 1], back, offBoard);
+            clear = !offBoard;
+        }
+        for (int i = 0; i <= START_LENGTH && clear; ++i) {
+            clear = !occupancy.isOccupied(cells[i]) && !isFood(cells[i]);
+        }
+        if (!clear) continue;
+
+        ArenaSnake& snake = snakes[index];
+        snake.body.clear();
+        for (int i = 1; i <= START_LENGTH; ++i) {
+            snake.body.pushBack(cells[i]);
+            occupancy.add(cells[i]);
+        }
+        snake.heading = heading;
+        snake.alive = true;
+        snake.respawnTick = 0;
+        snake.target = NOWHERE;
+        alive++;
+        return true;
+    }
+    return false;
+}
+
+void Arena::kill(int index, DeathCause cause) {
+    ArenaSnake& snake = snakes[index];
+    for (Point p : snake.body) {
+        occupancy.remove(p);
+    }
+    snake.body.clear();
+    snake.alive = false;
+    snake.deaths++;
+    snake.lastDeath = cause;
+    snake.respawnTick = respawnTicks > 0 ? tick + respawnTicks : 0;
+    alive--;
+}
+
+void Arena::placeFood(size_t index) {
+    food[index] = NOWHERE;
+    for (int attempt = 0; attempt < SPAWN_ATTEMPTS; ++attempt) {
+        Point p;
+        if (!occupancy.randomFreeCell(rng, p)) break;
+        if (foodCells.insert(SnakeBody::pack(p), static_cast<int>(index)) == CellHash::NOT_FOUND) {
+            food[index] = p;
+            return;
+        }
+    }
+    // Tried again next tick
+    missingFood++;
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "cell_hash.h"
+#include "constants.h"
+#include "direction.h"
+#include "occupancy.h"
+#include "point.h"
+#include "rng.h"
+#include "sim.h"
+#include "snake_body.h"
+
+namespace SnakeGame {
+
+struct ArenaSnake {
+    SnakeBody body;
+    Direction heading = Direction::RIGHT;
+    bool alive = false;
+    bool human = false;           // steered by step()'s inputs rather than the built-in bot
+    int score = 0;
+    uint32_t deaths = 0;
+    DeathCause lastDeath = DeathCause::NONE;
+    uint64_t respawnTick = 0;     // while dead: first tick it may come back, 0 for never
+    Point target = Point(-1, -1); // bot: the food it is heading for
+};
+
+// Everything that happened during one arena tick, summed over the snakes
+struct ArenaEvents {
+    int died = 0;
+    int headOn = 0;   // of those, lost to head-on collisions
+    int ateFood = 0;
+    int respawned = 0;
+};
+
+// An arena's state without the occupancy grid, which restore() rebuilds
+// from the bodies: a few hundred bytes, the generator's single word
+// included. Reusing one snapshot object keeps save() free of allocations
+// once bodies stop growing.
+struct ArenaSnapshot {
+    std::vector<ArenaSnake> snakes;
+    std::vector<Point> food;
+    SplitMix64 rng;
+    uint64_t tick = 0;
+    int alive = 0;
+    int missingFood = 0;
+};
+
+// Many snakes on one board, some steered by players and the rest by a
+// cheap greedy bot.
+//
+// Every body is counted in one shared OccupancyGrid, so a head is checked
+// against all of them (its own included) with a single lookup, and the
+// cells heads move into this tick go through a CellHash to find head-on
+// collisions. Food is another CellHash. A tick is therefore a few lookups
+// per live head; only a death costs its snake's length, to take the body
+// off the board.
+//
+// Snakes move together. All tails move out first, so a head may follow
+// any tail, including its own. A head that enters a body dies. Heads that
+// enter the same cell all die. Two heads that swap cells each hit the
+// other's neck. Boards that do not wrap have walls. Portals and special
+// food are off. Food spawns on the interior, and eating grows the snake by
+// one and scores 10. Dead snakes leave the board and come back after
+// respawnTicks ticks at a random free spot, heading a random way.
+//
+// The arena holds no pointers and draws only from its own generator, so a
+// copy is a complete snapshot and the same seed and inputs replay exactly.
+// Free cells are drawn by sampling rather than from the grid's dense index,
+// whose order depends on history. That way save() only has to keep the
+// bodies, food and generator, and restore() costs the length of the bodies
+// rather than the area of the board.
+class Arena {
+public:
+    // respawnTicks 0 keeps dead snakes out for good
+    Arena(const GameConfig& config, int snakes, int foods, uint32_t seed, int respawnTicks = 0);
+
+    void setHuman(int snake, bool human) { snakes[snake].human = human; }
+
+    // Advances every live snake one tick. inputs[i] steers snake i if it is
+    // human; Direction::NONE keeps its heading and reversals are ignored.
+    // inputs may be null when every snake is a bot.
+    ArenaEvents step(const Direction* inputs);
+
+    // What the built-in bot would do: the free move closest to its food
+    Direction botMove(int snake);
+
+    void save(ArenaSnapshot& out) const;
+    // Back to a state saved from this arena (or one built the same way)
+    void restore(const ArenaSnapshot& in);
+
+    const GameConfig& getConfig() const { return config; }
+    uint64_t getTick() const { return tick; }
+    int getSnakeCount() const { return static_cast<int>(snakes.size()); }
+    int getAliveCount() const { return alive; }
+    const ArenaSnake& getSnake(int snake) const { return snakes[snake]; }
+    const std::vector<Point>& getFood() const { return food; }
+    bool isFood(const Point& p) const { return foodCells.find(SnakeBody::pack(p)) != CellHash::NOT_FOUND; }
+    // Segments of every snake
+    const OccupancyGrid& getOccupancy() const { return occupancy; }
+
+private:
+    struct Move {
+        int snake;
+        Point head;
+        DeathCause death;
+    };
+
+    GameConfig config;
+    std::vector<ArenaSnake> snakes;
+    std::vector<Point> food;    // (-1, -1) while waiting for a free cell
+    CellHash foodCells;         // food cell -> index in food
+    OccupancyGrid occupancy;
+    CellHash claims;            // this tick: new head cell -> snake
+    std::vector<Move> moves;
+    SplitMix64 rng;
+    uint64_t tick;
+    int alive;
+    int respawnTicks;
+    int missingFood;            // food slots waiting for a free cell
+
+    Point ahead(const Point& head, Direction dir, bool& offBoard) const;
+    bool spawn(int snake);
+    void kill(int snake, DeathCause cause);
+    void placeFood(size_t index);
+};
+
+} // namespace SnakeGame
@@ -0,0 +1,234 @@
+#include "autopilot.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace SnakeGame {
+
+namespace {
+
+constexpr Direction MOVES[] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+
+// A fallback move with at least this much room counts as open space; more
+// would only make large boards flood further for no better choice
+constexpr uint32_t ROOM_SLACK = 16;
+
+} // namespace
+
+Autopilot::Autopilot()
+    : width(0), height(0), wraps(false), generation(0), bodyGeneration(0) {
+}
+
+Direction Autopilot::decide(const SimState& state) {
+    const Snake& snake = state.snake;
+    if (snake.isTeleporting()) return Direction::NONE;  // step() ignores it anyway
+
+    prepare(state);
+    stats.decisions++;
+
+    Point head = snake.getHead();
+    if (head.x < 0 || head.x >= width || head.y < 0 || head.y >= height) {
+        return snake.getCurrentDirection();
+    }
+    uint32_t length = static_cast<uint32_t>(snake.getLength());
+
+    Point goal = state.food.isPlaced() ? state.food.getPosition() : head;
+    if (goal != head) {
+        Direction move = findPath(head, goal);
+        Point next;
+        if (move != Direction::NONE && advance(head, move, 1, next) &&
+            floodCount(next, length) >= length) {
+            stats.pathsFound++;
+            return move;
+        }
+    }
+
+    // No safe path: take the move with the most room, nearest the food
+    // among equally roomy ones
+    stats.fallbacks++;
+    Direction best = snake.getCurrentDirection();
+    uint32_t bestRoom = 0;
+    uint32_t bestDistance = 0;
+    for (Direction dir : MOVES) {
+        Point next;
+        if (!advance(head, dir, 1, next)) continue;
+        uint32_t room = floodCount(next, 2 * length + ROOM_SLACK);
+        uint32_t toGoal = distance(next, goal);
+        if (room > bestRoom || (room == bestRoom && toGoal < bestDistance)) {
+            best = dir;
+            bestRoom = room;
+            bestDistance = toGoal;
+        }
+    }
+    return best;
+}
+
+void Autopilot::prepare(const SimState& state) {
+    const GameConfig& config = state.config;
+    if (config.width != width || config.height != height) {
+        width = config.width;
+        height = config.height;
+        size_t area = static_cast<size_t>(width) * height;
+        cells.assign(area, Cell());
+        frontier.reserve(area);
+        for (auto& bucket : open) {
+            bucket.reserve(area);
+        }
+        generation = 0;
+        bodyGeneration = 0;
+    }
+    wraps = config.wrapAround;
+
+    auto onBoard = [this](const Point& p) {
+        return p.x >= 0 && p.x < width && p.y >= 0 && p.y < height;
+    };
+    portals.clear();
+    for (const auto& portal : state.portals) {
+        if (portal.active && onBoard(portal.position) && onBoard(portal.destination)) {
+            portals.push_back({portal.position, portal.destination});
+        }
+    }
+
+    if (++bodyGeneration == 0) {
+        for (auto& cell : cells) {
+            cell.bodyStamp = 0;
+        }
+        bodyGeneration = 1;
+    }
+    // Segment i clears its cell after length - i moves. Walking tail to
+    // head lets the segment nearest the head win where two share a cell.
+    const SnakeBody& body = state.snake.getBody();
+    uint32_t length = static_cast<uint32_t>(body.size());
+    for (size_t i = body.size(); i-- > 0;) {
+        Point p = body[i];
+        if (!onBoard(p)) continue;
+        Cell& cell = cells[index(p)];
+        cell.bodyStamp = bodyGeneration;
+        cell.freeAfter = length - static_cast<uint32_t>(i);
+    }
+}
+
+void Autopilot::nextGeneration() {
+    if (++generation == 0) {
+        for (auto& cell : cells) {
+            cell.searchStamp = 0;
+            cell.closedStamp = 0;
+        }
+        generation = 1;
+    }
+}
+
+bool Autopilot::advance(const Point& from, Direction dir, uint32_t moves, Point& out) const {
+    out = from + DirectionManager::getDirectionVector(dir);
+    if (out.x < 0 || out.x >= width || out.y < 0 || out.y >= height) {
+        if (!wraps) return false;
+        out = out.wrap(width, height);
+    }
+    if (blocked(out, moves)) return false;
+
+    // The head lands on the far portal and sits out a tick there, during
+    // which nothing else moves
+    for (const auto& portal : portals) {
+        if (portal.entry == out) {
+            out = portal.exit;
+            return !blocked(out, moves);
+        }
+    }
+    return true;
+}
+
+uint32_t Autopilot::distance(const Point& from, const Point& to) const {
+    int dx = std::abs(from.x - to.x);
+    int dy = std::abs(from.y - to.y);
+    if (wraps) {
+        dx = std::min(dx, width - dx);
+        dy = std::min(dy, height - dy);
+    }
+    return static_cast<uint32_t>(dx + dy);
+}
+
+uint32_t Autopilot::heuristic(const Point& from, const Point& goal) const {
+    uint32_t best = distance(from, goal);
+    for (const auto& portal : portals) {
+        best = std::min(best, distance(from, portal.entry) + distance(portal.exit, goal));
+    }
+    return best;
+}
+
+Direction Autopilot::findPath(const Point& start, const Point& goal) {
+    nextGeneration();
+    for (auto& bucket : open) {
+        bucket.clear();
+    }
+    size_t startCell = index(start);
+    cells[startCell].searchStamp = generation;
+    cells[startCell].g = 0;
+    uint32_t f = heuristic(start, goal);
+    open[f % 3].push_back(SnakeBody::pack(start));
+
+    for (int idle = 0; idle < 3;) {
+        std::vector<uint32_t>& bucket = open[f % 3];
+        if (bucket.empty()) {
+            f++;
+            idle++;
+            continue;
+        }
+        idle = 0;
+        Point current = SnakeBody::unpack(bucket.back());
+        bucket.pop_back();
+        Cell& node = cells[index(current)];
+        if (node.closedStamp == generation) continue;  // superseded entry
+        node.closedStamp = generation;
+        stats.nodesExpanded++;
+
+        if (current == goal) {
+            uint32_t link = node.cameFrom;
+            while (link >> 2 != startCell) {
+                link = cells[link >> 2].cameFrom;
+            }
+            return static_cast<Direction>(link & 3);
+        }
+
+        // Obstacles only ever clear, so the first arrival at a cell is the
+        // best one and a closed cell never needs reopening
+        uint32_t from = static_cast<uint32_t>(index(current));
+        uint32_t g = node.g + 1;
+        for (Direction dir : MOVES) {
+            Point next;
+            if (!advance(current, dir, g, next)) continue;
+            Cell& neighbour = cells[index(next)];
+            if (neighbour.closedStamp == generation) continue;
+            if (neighbour.searchStamp == generation && neighbour.g <= g) continue;
+            neighbour.searchStamp = generation;
+            neighbour.g = g;
+            neighbour.cameFrom = from << 2 | static_cast<uint32_t>(dir);
+            open[(g + heuristic(next, goal)) % 3].push_back(SnakeBody::pack(next));
+        }
+    }
+    return Direction::NONE;
+}
+
+uint32_t Autopilot::floodCount(const Point& from, uint32_t limit) {
+    nextGeneration();
+    frontier.clear();
+    frontier.push_back(SnakeBody::pack(from));
+    cells[index(from)].searchStamp = generation;
+    cells[index(from)].g = 1;
+
+    size_t head = 0;
+    while (head < frontier.size() && head < limit) {
+        Point current = SnakeBody::unpack(frontier[head++]);
+        uint32_t moves = cells[index(current)].g + 1;
+        for (Direction dir : MOVES) {
+            Point next;
+            if (!advance(current, dir, moves, next)) continue;
+            Cell& neighbour = cells[index(next)];
+            if (neighbour.searchStamp == generation) continue;
+            neighbour.searchStamp = generation;
+            neighbour.g = moves;
+            frontier.push_back(SnakeBody::pack(next));
+        }
+    }
+    return static_cast<uint32_t>(std::min<size_t>(frontier.size(), limit));
+}
+
+} // namespace SnakeGame
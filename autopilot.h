@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "sim.h"
+
+namespace SnakeGame {
+
+struct AutopilotStats {
+    uint64_t decisions = 0;
+    uint64_t pathsFound = 0;    // A* reached the food with a safe first move
+    uint64_t fallbacks = 0;     // no safe path: picked the roomiest move instead
+    uint64_t nodesExpanded = 0;
+};
+
+// Food-seeking controller for demo mode and as a baseline bot.
+//
+// Each decision runs A* from the head to the food over the board as
+// step() sees it: edges wrap on a wrap-around board, stepping onto an
+// active portal lands on its destination, and a body segment blocks its
+// cell only until the tail has moved past it. The heuristic is the
+// toroidal Manhattan distance, also tried through each portal, so it
+// stays admissible. When there is no path, or the path's first move leads
+// into a pocket smaller than the snake, a breadth-first flood from each
+// legal move picks the one with the most room.
+//
+// The per-cell buffers are sized once per board and stamped with a
+// generation number instead of being cleared, so a decision touches only
+// the cells it searches and never allocates once the open list has grown
+// to its working size.
+class Autopilot {
+public:
+    Autopilot();
+
+    // Direction to feed step() on the next tick; NONE while the snake waits
+    // out a portal
+    Direction decide(const SimState& state);
+
+    const AutopilotStats& getStats() const { return stats; }
+
+private:
+    struct PortalLink {
+        Point entry;
+        Point exit;
+    };
+
+    // Everything a search reads about one cell, together so a visit costs
+    // one cache line. Search fields count only when their stamp matches
+    // the current generation, body fields when bodyStamp matches the
+    // current decision.
+    struct Cell {
+        uint32_t bodyStamp;
+        uint32_t freeAfter;    // moves until the body segment leaves
+        uint32_t searchStamp;
+        uint32_t closedStamp;
+        uint32_t g;
+        uint32_t cameFrom;     // parent cell << 2 | direction of the edge in
+    };
+
+    int width;
+    int height;
+    bool wraps;
+    std::vector<PortalLink> portals;  // active ones on the board
+
+    std::vector<Cell> cells;
+    // Open list as buckets by f. The heuristic changes by at most one per
+    // move, so a neighbour's f is at most two above the node being expanded
+    // and three rolling buckets cover every live f; each is a stack, which
+    // breaks ties toward the deepest node. Both queues hold cells packed as
+    // in SnakeBody, so expanding one needs no division.
+    std::vector<uint32_t> open[3];
+    std::vector<uint32_t> frontier;
+    uint32_t generation;
+    uint32_t bodyGeneration;
+
+    AutopilotStats stats;
+
+    void prepare(const SimState& state);
+    void nextGeneration();
+    size_t index(const Point& p) const {
+        return static_cast<size_t>(p.y) * width + p.x;
+    }
+    bool blocked(const Point& p, uint32_t moves) const {
+        const Cell& cell = cells[index(p)];
+        return cell.bodyStamp == bodyGeneration && moves < cell.freeAfter;
+    }
+    // Where the head ends up when it leaves `from` in `dir` as move number
+    // `moves`, after wrapping and portals; false if that runs off a walled
+    // board or into the body
+    bool advance(const Point& from, Direction dir, uint32_t moves, Point& out) const;
+    uint32_t distance(const Point& from, const Point& to) const;
+    uint32_t heuristic(const Point& from, const Point& goal) const;
+
+    // First move of the shortest safe path to goal, or NONE
+    Direction findPath(const Point& start, const Point& goal);
+    // Cells reachable after taking the first move onto `from`, capped at limit
+    uint32_t floodCount(const Point& from, uint32_t limit);
+};
+
+} // namespace SnakeGame
@@ -0,0 +1,299 @@
+#include "batch_sim.h"
+#include "snake.h"
+#include <algorithm>
+
+namespace SnakeGame {
+
+namespace {
+
+constexpr int32_t INITIAL_LENGTH = 3;
+constexpr int32_t POINTS_PER_FOOD = 10;
+constexpr int32_t MAX_COMBO = 5;
+
+// splitmix64: one word of state per game and good enough for food
+inline uint64_t nextRandom(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, n) from 32 random bits
+inline uint32_t bounded(uint64_t bits, uint32_t n) {
+    return static_cast<uint32_t>(((bits & 0xFFFFFFFFu) * n) >> 32);
+}
+
+// Every game starts with a ring this size; most never outgrow it
+constexpr uint32_t SMALL_RING = 32;
+
+uint32_t log2Of(uint32_t size) {
+    uint32_t bits = 0;
+    while ((uint32_t(1) << bits) < size) bits++;
+    return bits;
+}
+
+// The lockstep half of a tick: turn, move, wrap, wall and food for every
+// game at once, with selects instead of branches so the loop vectorises.
+// The arrays never overlap; restrict saves the compiler from checking.
+template <bool Wrap>
+void advanceHeads(size_t games, int32_t w, int32_t h, const Direction* __restrict in,
+                  const int32_t* __restrict hx, const int32_t* __restrict hy, Direction* __restrict dir,
+                  const int32_t* __restrict fx, const int32_t* __restrict fy,
+                  const int32_t* __restrict live, int32_t* __restrict nx, int32_t* __restrict ny,
+                  int32_t* __restrict wall, int32_t* __restrict eat) {
+    for (size_t i = 0; i < games; ++i) {
+        int32_t want = static_cast<int32_t>(in[i]);
+        int32_t d = static_cast<int32_t>(dir[i]);
+        // Opposite headings differ only in the low bit; NONE is 4
+        int32_t reverse = d ^ 1;
+        d = want < 4 ? (want != reverse ? want : d) : d;
+        int32_t x = hx[i] + (d == 3 ? 1 : 0) - (d == 2 ? 1 : 0);
+        int32_t y = hy[i] + (d == 1 ? 1 : 0) - (d == 0 ? 1 : 0);
+        if (Wrap) {
+            x = x < 0 ? w - 1 : x;
+            x = x >= w ? 0 : x;
+            y = y < 0 ? h - 1 : y;
+            y = y >= h ? 0 : y;
+        }
+        dir[i] = static_cast<Direction>(d);
+        nx[i] = x;
+        ny[i] = y;
+        // Unsigned compares catch both sides at once
+        int32_t outX = static_cast<uint32_t>(x) >= static_cast<uint32_t>(w) ? 1 : 0;
+        int32_t outY = static_cast<uint32_t>(y) >= static_cast<uint32_t>(h) ? 1 : 0;
+        wall[i] = outX | outY;
+        // Loads stay unconditional: a load under a select counts as a branch
+        int32_t playing = live[i];
+        int32_t onFoodX = x == fx[i] ? playing : 0;
+        eat[i] = y == fy[i] ? onFoodX : 0;
+    }
+}
+
+} // namespace
+
+BatchSim::BatchSim(const GameConfig& config, size_t games, uint32_t seed)
+    : config(config)
+    , games(games)
+    , width(config.width)
+    , height(config.height)
+    , wraps(config.wrapAround)
+    , tickMillis(config.initialSpeed.count())
+    , headX(games), headY(games), direction(games), length(games)
+    , foodX(games), foodY(games), alive(games), score(games), combo(games)
+    , ticks(games), lastFoodTick(games), interiorFree(games), rng(games)
+    , outcome(games)
+    , nextX(games), nextY(games), hitWall(games), ate(games)
+    , bodies(games)
+    , interiorArea(0) {
+    size_t area = static_cast<size_t>(width) * height;
+    rings.reserve(games * SMALL_RING);
+    for (size_t game = 0; game < games; ++game) {
+        bodies[game] = {allocateRing(SMALL_RING), SMALL_RING - 1, 0, 0};
+    }
+
+    interior.assign(area, 0);
+    for (int y = 1; y < height - 1; ++y) {
+        for (int x = 1; x < width - 1; ++x) {
+            interior[static_cast<size_t>(y) * width + x] = 1;
+            interiorArea++;
+        }
+    }
+    boardWords = (area + 63) / 64;
+    boards.assign(games * boardWords, 0);
+
+    for (size_t game = 0; game < games; ++game) {
+        reset(game, seed + static_cast<uint32_t>(game));
+    }
+}
+
+void BatchSim::reset(size_t game, uint32_t seed) {
+    std::fill(board(game), board(game) + boardWords, 0);
+    Ring& body = bodies[game];
+    if (body.mask + 1 > SMALL_RING) {
+        releaseRing(body.base, body.mask + 1);
+        body.base = allocateRing(SMALL_RING);
+        body.mask = SMALL_RING - 1;
+    }
+    body.start = 0;
+    body.count = 0;
+    interiorFree[game] = interiorArea;
+
+    // As SimState: head mid-board, body trailing left
+    int x = width / 2;
+    int y = height / 2;
+    for (int i = INITIAL_LENGTH - 1; i >= 0; --i) {
+        pushHead(game, static_cast<uint32_t>(y * width + x - i));
+    }
+    headX[game] = x;
+    headY[game] = y;
+    direction[game] = Direction::RIGHT;
+    length[game] = INITIAL_LENGTH;
+    alive[game] = 1;
+    score[game] = 0;
+    combo[game] = 0;
+    ticks[game] = 0;
+    lastFoodTick[game] = 0;
+    ate[game] = 0;
+    outcome[game] = BatchOutcome::PLAYING;
+    rng[game] = seed;
+    if (!placeFood(game)) finish(game, BatchOutcome::BOARD_FULL);
+}
+
+void BatchSim::step(const Direction* inputs) {
+    auto advance = wraps ? advanceHeads<true> : advanceHeads<false>;
+    advance(games, width, height, inputs, headX.data(), headY.data(), direction.data(),
+            foodX.data(), foodY.data(), alive.data(), nextX.data(), nextY.data(), hitWall.data(),
+            ate.data());
+
+    const int32_t w = width;
+    const int32_t* live = alive.data();
+    const int32_t* nx = nextX.data();
+    const int32_t* ny = nextY.data();
+    const int32_t* wall = hitWall.data();
+    const int32_t* eat = ate.data();
+    int32_t* hx = headX.data();
+    int32_t* hy = headY.data();
+
+    // Per game: body, collisions and food
+    for (size_t i = 0; i < games; ++i) {
+        if (!live[i]) continue;
+        ticks[i]++;
+        if (wall[i]) {
+            finish(i, BatchOutcome::WALL_COLLISION);
+            continue;
+        }
+
+        // The tail leaves first, unless it is stalled by a recent apple
+        if (bodies[i].count >= static_cast<uint32_t>(length[i])) popTail(i);
+        uint32_t cell = static_cast<uint32_t>(ny[i] * w + nx[i]);
+        if (board(i)[cell >> 6] >> (cell & 63) & 1) {
+            finish(i, BatchOutcome::SELF_COLLISION);
+            continue;
+        }
+        pushHead(i, cell);
+        hx[i] = nx[i];
+        hy[i] = ny[i];
+
+        if (eat[i]) {
+            // Same combo window as Snake::updateCombo on the simulated clock
+            int64_t sinceLast = static_cast<int64_t>(ticks[i] - lastFoodTick[i]) * tickMillis;
+            combo[i] = (combo[i] == 0 || sinceLast < ComboState::COMBO_WINDOW_MS) ? combo[i] + 1 : 1;
+            lastFoodTick[i] = ticks[i];
+            score[i] += POINTS_PER_FOOD * std::min(combo[i], MAX_COMBO);
+            length[i]++;
+            if (!placeFood(i)) finish(i, BatchOutcome::BOARD_FULL);
+        }
+    }
+}
+
+size_t BatchSim::allocateRing(uint32_t size) {
+    uint32_t sizeClass = log2Of(size);
+    if (sizeClass < freeRings.size() && !freeRings[sizeClass].empty()) {
+        size_t base = freeRings[sizeClass].back();
+        freeRings[sizeClass].pop_back();
+        return base;
+    }
+    size_t base = rings.size();
+    rings.resize(base + size);
+    return base;
+}
+
+void BatchSim::releaseRing(size_t base, uint32_t size) {
+    uint32_t sizeClass = log2Of(size);
+    if (sizeClass >= freeRings.size()) freeRings.resize(sizeClass + 1);
+    freeRings[sizeClass].push_back(base);
+}
+
+void BatchSim::growRing(size_t game) {
+    Ring& body = bodies[game];
+    uint32_t size = body.mask + 1;
+    size_t base = allocateRing(size * 2);
+    // Unrolled head first into the new ring
+    for (uint32_t i = 0; i < size; ++i) {
+        rings[base + i] = rings[body.base + ((body.start + i) & body.mask)];
+    }
+    releaseRing(body.base, size);
+    body = {base, size * 2 - 1, 0, body.count};
+}
+
+void BatchSim::pushHead(size_t game, uint32_t cell) {
+    if (bodies[game].count > bodies[game].mask) growRing(game);
+    Ring& body = bodies[game];
+    body.start = (body.start - 1) & body.mask;
+    rings[body.base + body.start] = cell;
+    body.count++;
+    board(game)[cell >> 6] |= uint64_t(1) << (cell & 63);
+    interiorFree[game] -= interior[cell];
+}
+
+void BatchSim::popTail(size_t game) {
+    Ring& body = bodies[game];
+    uint32_t cell = rings[body.base + ((body.start + body.count - 1) & body.mask)];
+    body.count--;
+    board(game)[cell >> 6] &= ~(uint64_t(1) << (cell & 63));
+    interiorFree[game] += interior[cell];
+}
+
+bool BatchSim::placeFood(size_t game) {
+    int32_t freeCells = interiorFree[game];
+    if (freeCells <= 0) {
+        foodX[game] = -1;
+        foodY[game] = -1;
+        return false;
+    }
+
+    const uint64_t* bits = board(game);
+    auto isFree = [bits](uint32_t cell) { return (bits[cell >> 6] >> (cell & 63) & 1) == 0; };
+    uint32_t innerWidth = static_cast<uint32_t>(width - 2);
+    uint32_t innerHeight = static_cast<uint32_t>(height - 2);
+    if (freeCells * 8 >= interiorArea) {
+        // At least one interior cell in eight is free: draw until one is
+        for (;;) {
+            uint64_t bits64 = nextRandom(rng[game]);
+            int x = 1 + static_cast<int>(bounded(bits64, innerWidth));
+            int y = 1 + static_cast<int>(bounded(bits64 >> 32, innerHeight));
+            if (isFree(static_cast<uint32_t>(y * width + x))) {
+                foodX[game] = x;
+                foodY[game] = y;
+                return true;
+            }
+        }
+    }
+
+    // Nearly full: pick the k-th free cell directly
+    uint32_t k = bounded(nextRandom(rng[game]), static_cast<uint32_t>(freeCells));
+    for (int y = 1; y < height - 1; ++y) {
+        for (int x = 1; x < width - 1; ++x) {
+            if (isFree(static_cast<uint32_t>(y * width + x)) && k-- == 0) {
+                foodX[game] = x;
+                foodY[game] = y;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void BatchSim::finish(size_t game, BatchOutcome result) {
+    alive[game] = 0;
+    outcome[game] = result;
+}
+
+bool BatchSim::isOccupied(size_t game, const Point& p) const {
+    if (p.x < 0 || p.x >= width || p.y < 0 || p.y >= height) return false;
+    uint32_t cell = static_cast<uint32_t>(p.y * width + p.x);
+    return (board(game)[cell >> 6] >> (cell & 63) & 1) != 0;
+}
+
+std::vector<Point> BatchSim::getBody(size_t game) const {
+    std::vector<Point> body;
+    const Ring& ring = bodies[game];
+    body.reserve(ring.count);
+    for (uint32_t i = 0; i < ring.count; ++i) {
+        uint32_t cell = rings[ring.base + ((ring.start + i) & ring.mask)];
+        body.emplace_back(static_cast<int>(cell % width), static_cast<int>(cell / width));
+    }
+    return body;
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "constants.h"
+#include "direction.h"
+#include "point.h"
+
+namespace SnakeGame {
+
+enum class BatchOutcome : uint8_t {
+    PLAYING,
+    SELF_COLLISION,
+    WALL_COLLISION,
+    BOARD_FULL    // no free cell left for food: a win
+};
+
+// Many games on one board size, stepped together. Built for bot training
+// and balance sweeps, where thousands of short games matter more than any
+// one of them.
+//
+// Per-game state is kept as struct-of-arrays: head, heading, food and
+// flags each live in their own array, so one tick is first a branch-free
+// pass over every game (turn, move, wrap, wall and food tests) that the
+// compiler vectorises, then a pass over the live games for the parts that
+// touch memory per game. Bodies sit in one shared arena of power-of-two
+// rings that start small and double as a snake grows, so thousands of
+// short snakes stay packed in cache. Each game also has a one-bit-per-cell
+// occupancy board.
+//
+// Rules follow step() with portals off: reversals are ignored, the tail
+// moves out before the head moves in, food spawns on the interior and a
+// full interior is a win. Boards that do not wrap have walls. Scores use
+// the combo multiplier on the simulated clock. Food comes from a small
+// per-game generator, so games do not replay a SimState with the same
+// seed.
+class BatchSim {
+public:
+    // Game i starts from seed + i. The board needs at least 4 columns for
+    // the starting body.
+    BatchSim(const GameConfig& config, size_t games, uint32_t seed);
+
+    size_t size() const { return games; }
+    const GameConfig& getConfig() const { return config; }
+
+    // Restarts one game: length 3 mid-board heading right, fresh food
+    void reset(size_t game, uint32_t seed);
+
+    // Advances every game still playing by one tick; inputs[i] steers game
+    // i and Direction::NONE keeps its heading. Finished games stay put
+    // until reset.
+    void step(const Direction* inputs);
+
+    const int32_t* getHeadX() const { return headX.data(); }
+    const int32_t* getHeadY() const { return headY.data(); }
+    const int32_t* getFoodX() const { return foodX.data(); }
+    const int32_t* getFoodY() const { return foodY.data(); }
+    const Direction* getDirections() const { return direction.data(); }
+    const int32_t* getLengths() const { return length.data(); }
+    const int32_t* getScores() const { return score.data(); }
+    const uint32_t* getTicks() const { return ticks.data(); }
+    // Whether each game ate on the last step
+    const int32_t* getAte() const { return ate.data(); }
+    bool isAlive(size_t game) const { return alive[game] != 0; }
+    BatchOutcome getOutcome(size_t game) const { return outcome[game]; }
+
+    bool isOccupied(size_t game, const Point& p) const;
+    // Body segments of one game, head first
+    std::vector<Point> getBody(size_t game) const;
+
+private:
+    GameConfig config;
+    size_t games;
+    int width;
+    int height;
+    bool wraps;
+    int64_t tickMillis;  // simulated clock step, for the combo window
+
+    // Per game, all indexed by game number
+    std::vector<int32_t> headX;
+    std::vector<int32_t> headY;
+    std::vector<Direction> direction;
+    std::vector<int32_t> length;
+    std::vector<int32_t> foodX;
+    std::vector<int32_t> foodY;
+    std::vector<int32_t> alive;
+    std::vector<int32_t> score;
+    std::vector<int32_t> combo;
+    std::vector<uint32_t> ticks;
+    std::vector<uint32_t> lastFoodTick;
+    std::vector<int32_t> interiorFree;
+    std::vector<uint64_t> rng;
+    std::vector<BatchOutcome> outcome;
+
+    // Scratch for the lockstep pass
+    std::vector<int32_t> nextX;
+    std::vector<int32_t> nextY;
+    std::vector<int32_t> hitWall;
+    std::vector<int32_t> ate;
+
+    // Body arena. A game's ring is mask + 1 cells from base, head first
+    // from start; a cell is y * width + x. The four are always used
+    // together, so they share a struct. Freed rings are kept by size for
+    // reuse.
+    struct Ring {
+        size_t base;
+        uint32_t mask;
+        uint32_t start;
+        uint32_t count;
+    };
+    std::vector<uint32_t> rings;
+    std::vector<Ring> bodies;
+    std::vector<std::vector<size_t>> freeRings;  // by log2 of the ring size
+    // Per board cell, shared: 1 where food may spawn
+    std::vector<uint8_t> interior;
+    int32_t interiorArea;
+    // Occupancy arena: boardWords words per game
+    size_t boardWords;
+    std::vector<uint64_t> boards;
+
+    uint64_t* board(size_t game) { return boards.data() + game * boardWords; }
+    const uint64_t* board(size_t game) const { return boards.data() + game * boardWords; }
+    size_t allocateRing(uint32_t size);
+    void releaseRing(size_t base, uint32_t size);
+    void growRing(size_t game);
+    void pushHead(size_t game, uint32_t cell);
+    void popTail(size_t game);
+    bool placeFood(size_t game);
+    void finish(size_t game, BatchOutcome result);
+};
+
+} // namespace SnakeGame
@@ -0,0 +1,90 @@
+// Arena tick cost versus the number of snakes on a 2048x2048 board.
+// Every snake is a bot chasing food, one food per snake, and dead snakes
+// respawn after 10 ticks, so the head count stays near the snake count.
+// "ns/head" divides tick time by the live heads: with the shared grid it
+// should stay flat as snakes are added. The pairwise column times what the
+// same collision checks cost by scanning every body for every head, on
+// the final board.
+// Usage: snake_bench_arena [ticks] [max-snakes]
+
+#include "arena.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr int BOARD_SIZE = 2048;
+constexpr int RESPAWN_TICKS = 10;
+constexpr int PAIRWISE_TICKS = 3;
+
+volatile size_t sink;
+
+// Every live head against every body, the way one Snake per player would
+// check them with checkCollision
+size_t pairwiseCheck(const Arena& arena) {
+    size_t hits = 0;
+    for (int i = 0; i < arena.getSnakeCount(); ++i) {
+        const ArenaSnake& snake = arena.getSnake(i);
+        if (!snake.alive) continue;
+        uint32_t head = SnakeBody::pack(snake.body.front());
+        for (int j = 0; j < arena.getSnakeCount(); ++j) {
+            const SnakeBody& body = arena.getSnake(j).body;
+            for (size_t k = (i == j) ? 1 : 0; k < body.size(); ++k) {
+                hits += body.packedAt(k) == head;
+            }
+        }
+    }
+    return hits;
+}
+
+void run(int snakes, int ticks, bool walls) {
+    GameConfig config = GameConfig::defaultConfig();
+    config.width = BOARD_SIZE;
+    config.height = BOARD_SIZE;
+    config.wrapAround = !walls;
+
+    Arena arena(config, snakes, snakes, 1, RESPAWN_TICKS);
+    ArenaEvents total;
+    uint64_t heads = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; ++t) {
+        heads += arena.getAliveCount();
+        ArenaEvents events = arena.step(nullptr);
+        total.died += events.died;
+        total.headOn += events.headOn;
+        total.ateFood += events.ateFood;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t length = 0;
+    for (int i = 0; i < arena.getSnakeCount(); ++i) {
+        length += arena.getSnake(i).body.size();
+    }
+
+    // Only a few ticks: it grows with heads times segments
+    start = std::chrono::steady_clock::now();
+    for (int t = 0; t < PAIRWISE_TICKS; ++t) sink = pairwiseCheck(arena);
+    double pairwise = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / PAIRWISE_TICKS;
+
+    std::printf("%5d snakes %-5s  %9.1f us/tick  %6.1f ns/head  %7.1f heads  %9llu segments  "
+                "%6d deaths (%5d head-on)  %6d food  pairwise %10.1f us/tick\n",
+                snakes, walls ? "walls" : "wrap", elapsed / ticks * 1e6, elapsed / heads * 1e9,
+                static_cast<double>(heads) / ticks, static_cast<unsigned long long>(length),
+                total.died, total.headOn, total.ateFood, pairwise * 1e6);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int ticks = (argc > 1) ? std::atoi(argv[1]) : 5000;
+    int maxSnakes = (argc > 2) ? std::atoi(argv[2]) : 10000;
+
+    for (int snakes = 10; snakes <= maxSnakes; snakes *= 10) {
+        run(snakes, ticks, false);
+        run(snakes, ticks, true);
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Autopilot decision throughput.
+// Plays whole games with the autopilot on each board (portals on, walls
+// wrapping as in the default config), starting a new game whenever one
+// ends, and reports decisions per second along with how the games went.
+// Board resets are kept out of the timing.
+// Usage: snake_bench_autopilot [decisions-per-board]
+
+#include "autopilot.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SnakeGame;
+
+namespace {
+
+void runBoard(int width, int height, uint64_t decisions) {
+    GameConfig config = GameConfig::defaultConfig();
+    config.width = width;
+    config.height = height;
+
+    Autopilot autopilot;
+    uint32_t seed = 1;
+    SimState state(config, seed);
+
+    uint64_t games = 1;
+    uint64_t foodEaten = 0;
+    uint64_t lengthAtEnd = 0;
+    std::chrono::steady_clock::duration resetTime{};
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < decisions; ++i) {
+        StepEvents events = step(state, autopilot.decide(state));
+        if (events.ateFood) foodEaten++;
+        if (state.gameOver) {
+            auto resetStart = std::chrono::steady_clock::now();
+            lengthAtEnd += state.snake.getLength();
+            state = SimState(config, ++seed);
+            resetTime += std::chrono::steady_clock::now() - resetStart;
+            games++;
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start - resetTime;
+    double seconds = std::chrono::duration<double>(elapsed).count();
+
+    // Count the unfinished game too so a board that never ends reports its length
+    lengthAtEnd += state.snake.getLength();
+    const AutopilotStats& stats = autopilot.getStats();
+    std::printf("%4dx%-4d %10llu decisions %12.0f decisions/s %8.2f us/decision %7llu games %8llu food "
+                "%7.1f avg length %5.1f%% fallback %8.1f nodes/search\n",
+                width, height,
+                static_cast<unsigned long long>(decisions),
+                decisions / seconds, seconds * 1e6 / decisions,
+                static_cast<unsigned long long>(games),
+                static_cast<unsigned long long>(foodEaten),
+                static_cast<double>(lengthAtEnd) / games,
+                100.0 * stats.fallbacks / stats.decisions,
+                static_cast<double>(stats.nodesExpanded) / stats.decisions);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t decisions = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    runBoard(40, 20, decisions);
+    runBoard(512, 512, decisions);
+    return 0;
+}
@@ -0,0 +1,138 @@
+// Batch simulator throughput: game-ticks per second with thousands of
+// games stepped in lockstep, against one SimState at a time. Every thread
+// runs its own BatchSim; games that end are restarted at once, so the
+// batch stays full. The policy is the same cheap food-seeker as
+// snake_bench_sim, computed over the batch's arrays. "step" counts only
+// time inside BatchSim::step; "total" adds the policy and restarts.
+// Usage: snake_bench_batch [games-per-thread] [steps] [threads]
+
+#include "batch_sim.h"
+#include "sim.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace SnakeGame;
+
+namespace {
+
+struct RunStats {
+    uint64_t gameTicks = 0;
+    uint64_t gamesFinished = 0;
+    uint64_t lengthAtEnd = 0;
+    double stepSeconds = 0;
+};
+
+// Head for the food, with a random turn one tick in eight
+inline uint32_t mix(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    return x ^ (x >> 16);
+}
+
+void choose(const BatchSim& batch, uint32_t tick, std::vector<Direction>& inputs) {
+    const int32_t* hx = batch.getHeadX();
+    const int32_t* hy = batch.getHeadY();
+    const int32_t* fx = batch.getFoodX();
+    const int32_t* fy = batch.getFoodY();
+    for (size_t i = 0; i < batch.size(); ++i) {
+        uint32_t r = mix(static_cast<uint32_t>(i) * 0x9E3779B9u + tick);
+        Direction seek = fx[i] != hx[i] ? (fx[i] > hx[i] ? Direction::RIGHT : Direction::LEFT)
+                                        : (fy[i] > hy[i] ? Direction::DOWN : Direction::UP);
+        inputs[i] = (r & 7) == 0 ? static_cast<Direction>((r >> 3) & 3) : seek;
+    }
+}
+
+RunStats runBatch(const GameConfig& config, size_t games, uint32_t steps, uint32_t seed) {
+    BatchSim batch(config, games, seed);
+    std::vector<Direction> inputs(games);
+    uint32_t nextSeed = seed + static_cast<uint32_t>(games);
+    RunStats stats;
+    for (uint32_t tick = 0; tick < steps; ++tick) {
+        choose(batch, tick, inputs);
+        auto start = std::chrono::steady_clock::now();
+        batch.step(inputs.data());
+        stats.stepSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats.gameTicks += games;
+        for (size_t i = 0; i < games; ++i) {
+            if (!batch.isAlive(i)) {
+                stats.gamesFinished++;
+                stats.lengthAtEnd += batch.getLengths()[i];
+                batch.reset(i, nextSeed++);
+            }
+        }
+    }
+    return stats;
+}
+
+void runBoard(int width, int height, size_t games, uint32_t steps, unsigned threads) {
+    GameConfig config = GameConfig::defaultConfig();
+    config.width = width;
+    config.height = height;
+
+    std::vector<RunStats> results(threads);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            results[t] = runBatch(config, games, steps, 1 + t * 1000003u);
+        });
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    RunStats total;
+    double stepSeconds = 0;
+    for (const auto& r : results) {
+        total.gameTicks += r.gameTicks;
+        total.gamesFinished += r.gamesFinished;
+        total.lengthAtEnd += r.lengthAtEnd;
+        stepSeconds = std::max(stepSeconds, r.stepSeconds);
+    }
+
+    // The same policy on one SimState, for scale
+    SimState state(config, 1, false);
+    std::mt19937 policyRng(1234);
+    uint64_t singleTicks = std::min<uint64_t>(total.gameTicks / threads, 20000000);
+    auto singleStart = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < singleTicks; ++i) {
+        Point head = state.snake.getHead();
+        Point food = state.food.getPosition();
+        Direction seek = food.x != head.x ? (food.x > head.x ? Direction::RIGHT : Direction::LEFT)
+                                          : (food.y > head.y ? Direction::DOWN : Direction::UP);
+        uint32_t r = policyRng();
+        step(state, (r & 7) == 0 ? static_cast<Direction>((r >> 3) & 3) : seek);
+        if (state.gameOver) state = SimState(config, static_cast<uint32_t>(i), false);
+    }
+    double singleSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - singleStart).count();
+
+    std::printf("%4dx%-4d %6zu games x %u threads  step %7.1fM ticks/s  total %7.1fM ticks/s  "
+                "single SimState %6.1fM ticks/s  %9llu games  %5.1f avg length\n",
+                width, height, games, threads,
+                total.gameTicks / stepSeconds / 1e6, total.gameTicks / seconds / 1e6,
+                singleTicks / singleSeconds / 1e6,
+                static_cast<unsigned long long>(total.gamesFinished),
+                total.gamesFinished ? static_cast<double>(total.lengthAtEnd) / total.gamesFinished : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t games = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 4096;
+    uint32_t steps = (argc > 2) ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 5000;
+    unsigned threads = (argc > 3) ? static_cast<unsigned>(std::atoi(argv[3]))
+                                  : std::max(1u, std::thread::hardware_concurrency());
+
+    runBoard(20, 20, games, steps, threads);
+    runBoard(40, 20, games, steps, threads);
+    runBoard(128, 128, games, steps, threads);
+    return 0;
+}
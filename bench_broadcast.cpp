@@ -0,0 +1,277 @@
+// Spectator fan-out load test for GameServer. The server runs in a child
+// process, so each side fits in its own descriptor limit. This process
+// connects two players per room, then the spectators, spread over the
+// rooms with WATCH. Each client rebuilds its room with an ArenaView, which
+// rejects any delta that does not follow on. Through the middle third of
+// the run, one spectator in a hundred stops reading. The server should
+// discard their backlogs, and each one should pick up again at a keyframe.
+// Reports the server's per-tick work, both wall time (which includes the
+// clients whenever they share its cores) and the server's own CPU time,
+// bytes per spectator per tick, how many backlogs were skipped and how
+// many views went wrong.
+// Usage: snake_bench_broadcast [spectators] [rooms] [seconds]
+
+#include "game_server.h"
+#include "rng.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr auto TICK = std::chrono::milliseconds(100);
+constexpr uint32_t TURN_ODDS = 8;   // one delta in this many gets a player's turn back
+constexpr size_t SLOW_EVERY = 100;  // one spectator in this many stalls
+// Small, so a stall outgrows the kernel's buffer and this within seconds
+constexpr int SOCKET_BUFFER = 4096;
+constexpr size_t SPECTATOR_BUFFER = 64;
+
+struct BenchClient {
+    int fd = -1;
+    std::vector<uint8_t> in;
+    ArenaView view;
+    bool player = false;
+    bool slow = false;
+    uint64_t bytes = 0;
+    uint64_t keyframes = 0;
+    bool broken = false;
+};
+
+int connectTo(const std::string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void sendFrame(int fd, NetProtocol::MessageType type, uint64_t value) {
+    std::vector<uint8_t> out;
+    NetProtocol::appendFrame(out, type, [&](ByteWriter& w) {
+        if (type == NetProtocol::TURN) {
+            w.varint(0);
+            w.u8(static_cast<uint8_t>(value));
+            return;
+        }
+        w.u8(NetProtocol::PROTOCOL_VERSION);
+        if (type == NetProtocol::WATCH) w.varint(value);
+    });
+    ssize_t ignored = ::send(fd, out.data(), out.size(), MSG_NOSIGNAL);
+    (void)ignored;
+}
+
+// Reads what is waiting and applies every whole frame
+void receive(BenchClient& client, std::mt19937& rng) {
+    uint8_t buffer[16384];
+    ssize_t got;
+    while ((got = recv(client.fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+        client.in.insert(client.in.end(), buffer, buffer + got);
+        client.bytes += static_cast<uint64_t>(got);
+    }
+
+    size_t used = 0;
+    NetProtocol::Frame frame;
+    long taken;
+    while ((taken = NetProtocol::readFrame(client.in.data() + used, client.in.size() - used, frame)) > 0) {
+        used += static_cast<size_t>(taken);
+        if (!client.view.apply(frame)) client.broken = true;
+        if (frame.type == NetProtocol::SNAPSHOT) client.keyframes++;
+        if (client.player && frame.type == NetProtocol::DELTA && boundedRandom(rng, TURN_ODDS) == 0) {
+            sendFrame(client.fd, NetProtocol::TURN, boundedRandom(rng, 4));
+        }
+    }
+    client.in.erase(client.in.begin(), client.in.begin() + used);
+}
+
+void watchEvents(int epollFd, int fd, size_t index, int op) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = index;
+    epoll_ctl(epollFd, op, fd, &event);
+}
+
+// Child: serves until the control pipe closes, then writes its stats back
+[[noreturn]] void serve(const ServerOptions& options, int control, int result) {
+    GameServer server(options);
+    bool started = server.start();
+    ssize_t ignored = write(result, &started, sizeof(started));
+    if (started) {
+        std::thread watcher([&server, control] {
+            char byte;
+            while (read(control, &byte, 1) > 0) {}
+            server.stop();
+        });
+        server.run();
+        watcher.join();
+        ServerStats stats = server.getStats();
+        ignored = write(result, &stats, sizeof(stats));
+    }
+    (void)ignored;
+    _exit(0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t spectators = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    size_t rooms = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 20;
+    int seconds = (argc > 3) ? std::atoi(argv[3]) : 15;
+    if (rooms == 0) rooms = 1;
+
+    ServerOptions options;
+    options.config.wrapAround = true;
+    options.tick = TICK;
+    options.maxTicks = 0;
+    options.maxSpectatorBuffer = SPECTATOR_BUFFER;
+    options.socketBuffer = SOCKET_BUFFER;
+    options.unixPath = "/tmp/snake_bench_broadcast." + std::to_string(getpid()) + ".sock";
+
+    int control[2], result[2];
+    if (pipe(control) != 0 || pipe(result) != 0) return 1;
+    pid_t child = fork();
+    if (child == 0) {
+        close(control[1]);
+        close(result[0]);
+        serve(options, control[0], result[1]);
+    }
+    close(control[0]);
+    close(result[1]);
+    bool started = false;
+    if (read(result[0], &started, sizeof(started)) != sizeof(started) || !started) {
+        std::fprintf(stderr, "snake_bench_broadcast: server did not start\n");
+        return 1;
+    }
+
+    int epollFd = epoll_create1(0);
+    std::mt19937 rng(1);
+    std::vector<BenchClient> clients(rooms * 2 + spectators);
+    auto connectAll = [&](size_t from, size_t to) {
+        for (size_t i = from; i < to; ++i) {
+            clients[i].fd = connectTo(options.unixPath);
+            if (clients[i].fd < 0) {
+                std::fprintf(stderr, "snake_bench_broadcast: connect failed after %zu clients\n", i);
+                std::exit(1);
+            }
+            watchEvents(epollFd, clients[i].fd, i, EPOLL_CTL_ADD);
+        }
+    };
+    std::vector<epoll_event> events(1024);
+    auto pump = [&](int timeoutMs) {
+        int count = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), timeoutMs);
+        for (int i = 0; i < count; ++i) receive(clients[events[i].data.u64], rng);
+    };
+
+    // Players first, so spectators have rooms to watch
+    connectAll(0, rooms * 2);
+    for (size_t i = 0; i < rooms * 2; ++i) {
+        clients[i].player = true;
+        sendFrame(clients[i].fd, NetProtocol::JOIN, 0);
+    }
+    std::vector<uint32_t> roomIds;
+    while (roomIds.size() < rooms) {
+        pump(100);
+        roomIds.clear();
+        for (size_t i = 0; i < rooms * 2; ++i) {
+            if (clients[i].view.isStarted() && clients[i].view.getSeat() == 0) {
+                roomIds.push_back(clients[i].view.getRoom());
+            }
+        }
+    }
+
+    auto began = std::chrono::steady_clock::now();
+    connectAll(rooms * 2, clients.size());
+    for (size_t i = rooms * 2; i < clients.size(); ++i) {
+        clients[i].slow = (i - rooms * 2) % SLOW_EVERY == SLOW_EVERY - 1;
+        sendFrame(clients[i].fd, NetProtocol::WATCH, roomIds[i % rooms]);
+        if (i % 256 == 0) pump(0);
+    }
+    double connectSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+
+    auto start = std::chrono::steady_clock::now();
+    auto stallAt = start + std::chrono::seconds(seconds) / 3;
+    auto resumeAt = start + std::chrono::seconds(seconds) * 2 / 3;
+    auto end = start + std::chrono::seconds(seconds);
+    bool stalled = false, resumed = false;
+    while (std::chrono::steady_clock::now() < end) {
+        auto now = std::chrono::steady_clock::now();
+        if (!stalled && now >= stallAt) {
+            for (size_t i = 0; i < clients.size(); ++i) {
+                if (clients[i].slow) epoll_ctl(epollFd, EPOLL_CTL_DEL, clients[i].fd, nullptr);
+            }
+            stalled = true;
+        }
+        if (!resumed && now >= resumeAt) {
+            for (size_t i = 0; i < clients.size(); ++i) {
+                if (clients[i].slow) watchEvents(epollFd, clients[i].fd, i, EPOLL_CTL_ADD);
+            }
+            resumed = true;
+        }
+        pump(50);
+    }
+
+    close(control[1]);
+    ServerStats stats{};
+    bool gotStats = read(result[0], &stats, sizeof(stats)) == sizeof(stats);
+    rusage usage{};
+    wait4(child, nullptr, 0, &usage);
+    double serverCpu = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+                       (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    if (!gotStats) {
+        std::fprintf(stderr, "snake_bench_broadcast: no stats from the server\n");
+        return 1;
+    }
+
+    uint64_t spectatorBytes = 0;
+    int broken = 0, slowTotal = 0, slowSynced = 0;
+    for (size_t i = 0; i < clients.size(); ++i) {
+        const BenchClient& client = clients[i];
+        broken += client.broken;
+        if (!client.player) spectatorBytes += client.bytes;
+        if (client.slow) {
+            slowTotal++;
+            // Resynced: took a keyframe after its first one
+            slowSynced += client.keyframes > 1 && client.view.isSynced();
+        }
+        close(client.fd);
+    }
+    close(epollFd);
+
+    double spectatorTicks = static_cast<double>(spectators) * stats.ticks;
+    std::printf("%zu spectators on %zu rooms over Unix sockets, connected in %.2f s\n", spectators, rooms,
+                connectSeconds);
+    std::printf("%llu ticks of %lld ms (%llu skipped)\n", static_cast<unsigned long long>(stats.ticks),
+                static_cast<long long>(TICK.count()), static_cast<unsigned long long>(stats.skippedTicks));
+    std::printf("tick work   p50 %lld us  p99 %lld us  max %lld us  (%.2f us per client)\n",
+                static_cast<long long>(stats.tickP50.count()), static_cast<long long>(stats.tickP99.count()),
+                static_cast<long long>(stats.tickMax.count()),
+                static_cast<double>(stats.tickP50.count()) / static_cast<double>(clients.size()));
+    std::printf("server CPU  %.0f us per tick  (%.2f us per client)\n",
+                stats.ticks > 0 ? serverCpu * 1e6 / stats.ticks : 0.0,
+                stats.ticks > 0 ? serverCpu * 1e6 / stats.ticks / static_cast<double>(clients.size()) : 0.0);
+    std::printf("tick start  p50 %lld us  p99 %lld us  max %lld us late\n",
+                static_cast<long long>(stats.schedule.jitterP50.count()),
+                static_cast<long long>(stats.schedule.jitterP99.count()),
+                static_cast<long long>(stats.schedule.jitterMax.count()));
+    std::printf("spectators  %.1f bytes per tick each, %llu backlogs skipped, %d/%d stalled ones resynced\n",
+                spectatorTicks > 0 ? spectatorBytes / spectatorTicks : 0.0,
+                static_cast<unsigned long long>(stats.keyframeSkips), slowSynced, slowTotal);
+    std::printf("clients     %llu games finished, %llu dropped, %d views broken\n",
+                static_cast<unsigned long long>(stats.gamesFinished),
+                static_cast<unsigned long long>(stats.dropped), broken);
+    return broken == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+// Compact replay codec: size and speed on synthetic games.
+// A snake chases food with some random turns for a fixed number of ticks on
+// boards of several sizes, growing as it eats. Each game is recorded as
+// plain v2 blocks, then every block payload is compressed and expanded
+// again; throughput is measured against the plain payload bytes. The v1
+// text size is counted for the same frames.
+// Usage: snake_bench_codec [ticks] [seed]
+
+#include "snake.h"
+#include "replay_v2.h"
+#include "replay_codec.h"
+#include "rng.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr double TURN_CHANCE = 0.15;
+constexpr double MIN_BENCH_SECONDS = 0.2;
+
+struct Block {
+    uint32_t tickCount;
+    const uint8_t* payload;
+    size_t size;
+};
+
+size_t digits(long long v) {
+    size_t n = v < 0 ? 2 : 1;
+    for (v = v < 0 ? -v : v; v >= 10; v /= 10) ++n;
+    return n;
+}
+
+// Bytes one state takes in the old text format
+size_t v1StateSize(const Snake& snake, const Point& food, int score, int combo, int64_t ms) {
+    size_t size = digits(snake.getLength()) + 1;
+    for (Point point : snake.getBody()) {
+        size += digits(point.x) + digits(point.y) + 2;
+    }
+    return size + digits(food.x) + digits(food.y) + 2 + digits(score) + 1 +
+           digits(combo) + 1 + digits(ms) + 1;
+}
+
+Direction chooseDirection(const Snake& snake, const Point& food, Direction current,
+                          std::mt19937& rng) {
+    Point head = snake.getHead();
+    Direction wanted = current;
+    if (unitRandom(rng) < TURN_CHANCE) {
+        wanted = static_cast<Direction>(boundedRandom(rng, 4));
+    } else if (head.x != food.x && (head.y == food.y || boundedRandom(rng, 2) == 0)) {
+        wanted = head.x < food.x ? Direction::RIGHT : Direction::LEFT;
+    } else if (head.y != food.y) {
+        wanted = head.y < food.y ? Direction::DOWN : Direction::UP;
+    }
+    return DirectionManager::isOpposite(wanted, current) ? current : wanted;
+}
+
+std::vector<Block> splitBlocks(const std::vector<uint8_t>& data) {
+    std::vector<Block> blocks;
+    ByteReader in(data.data(), data.size());
+    while (in.remaining() > 0) {
+        in.u32();
+        in.u32();
+        uint32_t tickCount = in.u32();
+        uint32_t size = in.u32();
+        const uint8_t* payload = in.bytes(size);
+        in.u32();
+        if (!in.ok()) break;
+        blocks.push_back({tickCount, payload, size});
+    }
+    return blocks;
+}
+
+// Runs fn over every block until enough time has passed; returns MB/s of
+// plain payload
+template <typename Fn>
+double throughput(const std::vector<Block>& blocks, size_t plainBytes, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    double seconds = 0;
+    size_t rounds = 0;
+    do {
+        for (const Block& block : blocks) fn(block);
+        ++rounds;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (seconds < MIN_BENCH_SECONDS);
+    return plainBytes * rounds / seconds / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int ticks = (argc > 1) ? std::atoi(argv[1]) : 10000;
+    uint32_t seed = (argc > 2) ? static_cast<uint32_t>(std::atoi(argv[2])) : 1;
+
+    std::printf("%10s %10s %10s %10s %8s %8s %10s %10s\n",
+                "board", "v1 KB", "v2 KB", "codec KB", "vs v2", "vs v1", "enc MB/s", "dec MB/s");
+    const int sizes[][2] = {{40, 20}, {256, 256}, {4096, 4096}};
+    for (const auto& boardSize : sizes) {
+        GameConfig config = GameConfig::defaultConfig();
+        config.width = boardSize[0];
+        config.height = boardSize[1];
+        config.wrapAround = true;
+
+        std::mt19937 rng(seed);
+        Snake snake(config.width / 2, config.height / 2, 3, config.width, config.height);
+        Direction direction = Direction::RIGHT;
+        Point food(static_cast<int>(boundedRandom(rng, config.width)),
+                   static_cast<int>(boundedRandom(rng, config.height)));
+        int score = 0;
+        int combo = 0;
+        int64_t ms = 0;
+        uint32_t period = 100;
+        size_t v1Bytes = 0;
+
+        ReplayEncoder plain(256, false);
+        ReplayEncoder compact;
+        for (int i = 0; i < ticks; ++i) {
+            direction = chooseDirection(snake, food, direction, rng);
+            snake.move(direction, config);
+            if (snake.getHead() == food) {
+                snake.grow();
+                score += 10 + combo;
+                combo = combo < 5 ? combo + 1 : combo;
+                food = Point(static_cast<int>(boundedRandom(rng, config.width)),
+                             static_cast<int>(boundedRandom(rng, config.height)));
+                // Speed up a little on every tenth apple, as hardcore does
+                if (score % 100 == 0 && period > 40) period -= 5;
+            } else if (i % 64 == 63) {
+                combo = 0;
+            }
+            ms += period;
+
+            plain.record(snake.getBody(), snake.getMoveCount(), snake.getGrowCount(),
+                         food, score, combo, ms);
+            compact.record(snake.getBody(), snake.getMoveCount(), snake.getGrowCount(),
+                           food, score, combo, ms);
+            v1Bytes += v1StateSize(snake, food, score, combo, ms);
+        }
+        plain.finish();
+        compact.finish();
+
+        // Every block has to come back byte for byte
+        std::vector<Block> blocks = splitBlocks(plain.data());
+        std::vector<std::vector<uint8_t>> compressed(blocks.size());
+        size_t plainBytes = 0;
+        std::vector<uint8_t> expanded;
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            const Block& block = blocks[b];
+            plainBytes += block.size;
+            bool ok = ReplayCodec::compressBlock(block.payload, block.size, block.tickCount, compressed[b]) &&
+                      ReplayCodec::expandBlock(compressed[b].data(), compressed[b].size(),
+                                               block.tickCount, expanded) &&
+                      expanded == std::vector<uint8_t>(block.payload, block.payload + block.size);
+            if (!ok) {
+                std::fprintf(stderr, "round trip failed on %dx%d, block %zu\n",
+                             config.width, config.height, b);
+                return 1;
+            }
+        }
+        std::vector<ReplayFrame> frames;
+        ByteReader reader(compact.data().data(), compact.data().size());
+        uint32_t blockCount = 0;
+        if (!decodeReplayBlocks(reader, frames, blockCount) || frames.size() != static_cast<size_t>(ticks) ||
+            frames.back().score != score) {
+            std::fprintf(stderr, "compact replay failed to decode on %dx%d\n", config.width, config.height);
+            return 1;
+        }
+
+        std::vector<uint8_t> scratch;
+        double encodeRate = throughput(blocks, plainBytes, [&](const Block& block) {
+            ReplayCodec::compressBlock(block.payload, block.size, block.tickCount, scratch);
+        });
+        size_t b = 0;
+        double decodeRate = throughput(blocks, plainBytes, [&](const Block& block) {
+            const std::vector<uint8_t>& packed = compressed[b++ % compressed.size()];
+            ReplayCodec::expandBlock(packed.data(), packed.size(), block.tickCount, scratch);
+        });
+
+        char board[32];
+        std::snprintf(board, sizeof(board), "%dx%d", config.width, config.height);
+        double v2Size = static_cast<double>(plain.data().size());
+        double compactSize = static_cast<double>(compact.data().size());
+        std::printf("%10s %10.1f %10.1f %10.1f %7.1fx %7.0fx %10.0f %10.0f\n",
+                    board, v1Bytes / 1024.0, v2Size / 1024.0, compactSize / 1024.0,
+                    v2Size / compactSize, v1Bytes / compactSize, encodeRate, decodeRate);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Collision query cost versus snake length.
+// The snake follows a boustrophedon cycle on a wrap-around board so it can
+// grow to any length below the board area without dying.
+// Usage: snake_bench_collision [ticks-per-length]
+
+#include "snake.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr int BOARD_SIZE = 512;
+
+Direction cycleDirection(const Point& head) {
+    if (head.y % 2 == 0) {
+        return head.x < BOARD_SIZE - 1 ? Direction::RIGHT : Direction::DOWN;
+    }
+    return head.x > 0 ? Direction::LEFT : Direction::DOWN;
+}
+
+volatile int sink;
+
+// Returns ns per tick of move + self collision + one point query
+double measureTicks(Snake& snake, const GameConfig& config, int ticks, bool linearScan) {
+    int hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ticks; ++i) {
+        snake.move(cycleDirection(snake.getHead()), config);
+        Point probe((i * 7919) % BOARD_SIZE, (i * 104729) % BOARD_SIZE);
+        if (linearScan) {
+            const auto& body = snake.getBody();
+            hits += std::find(body.begin() + 1, body.end(), body.front()) != body.end();
+            hits += std::find(body.begin(), body.end(), probe) != body.end();
+        } else {
+            hits += snake.checkSelfCollision();
+            hits += snake.checkCollision(probe);
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    sink = hits;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / ticks;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int ticks = (argc > 1) ? std::atoi(argv[1]) : 200000;
+
+    GameConfig config = GameConfig::defaultConfig();
+    config.width = BOARD_SIZE;
+    config.height = BOARD_SIZE;
+    config.wrapAround = true;
+
+    std::printf("%10s %16s %16s %12s\n", "length", "occupancy ns", "linear scan ns", "body B/seg");
+    for (int length : {10, 100, 1000, 10000, 100000}) {
+        Snake snake(1, 0, 2, config.width, config.height);
+        while (snake.getLength() < length) {
+            snake.move(cycleDirection(snake.getHead()), config);
+            snake.grow();
+        }
+
+        double fast = measureTicks(snake, config, ticks, false);
+        // The linear baseline is O(length) per tick, so scale its run down
+        int scanTicks = std::max(100, static_cast<int>(static_cast<long long>(ticks) * 10 / length));
+        double slow = measureTicks(snake, config, scanTicks, true);
+        double bytesPerSegment = static_cast<double>(snake.getBody().capacity() * sizeof(uint32_t)) / length;
+        std::printf("%10d %16.1f %16.1f %12.2f\n", length, fast, slow, bytesPerSegment);
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+// Reachable-area flood fill: bitboard sweeps (scalar and AVX2 kernels)
+// against a breadth-first search over a std::deque<Point> with a per-cell
+// collision check. Each board is filled from its middle; the counts must
+// agree. "coil rows" is a body folded back and forth across the board, the
+// shape a long snake leaves; "coil columns" is the same folded the other
+// way, the sweeps' worst case, needing one pass per fold.
+// Usage: snake_bench_flood [milliseconds-per-run]
+
+#include "bitboard.h"
+#include "rng.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr Direction MOVES[] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+
+struct Board {
+    int width;
+    int height;
+    bool wraps;
+    std::vector<uint8_t> blocked;
+    std::vector<Portal> portals;
+
+    bool isBlocked(const Point& p) const {
+        return blocked[static_cast<size_t>(p.y) * width + p.x] != 0;
+    }
+};
+
+Board makeBoard(int side, const char* layout) {
+    Board board{side, side, true, std::vector<uint8_t>(static_cast<size_t>(side) * side, 0), {}};
+    GameConfig config = GameConfig::defaultConfig();
+    config.width = side;
+    config.height = side;
+    board.portals = makeCornerPortals(config);
+
+    auto block = [&](int x, int y) { board.blocked[static_cast<size_t>(y) * side + x] = 1; };
+    std::string name(layout);
+    if (name == "scatter") {
+        // Obstacles on 30% of the cells, walls at the edges
+        board.wraps = false;
+        std::mt19937 rng(7);
+        for (int y = 0; y < side; ++y) {
+            for (int x = 0; x < side; ++x) {
+                if (boundedRandom(rng, 100) < 30) block(x, y);
+            }
+        }
+    } else if (name == "coil rows" || name == "coil columns") {
+        // Every fourth line is body, open at alternate ends
+        board.wraps = false;
+        bool rows = name == "coil rows";
+        for (int line = 3; line < side; line += 4) {
+            bool gapAtStart = (line / 4) % 2 != 0;
+            for (int i = 0; i < side; ++i) {
+                bool gap = gapAtStart ? i == 0 : i == side - 1;
+                if (gap) continue;
+                if (rows) block(i, line); else block(line, i);
+            }
+        }
+    }
+    board.blocked[static_cast<size_t>(side / 2) * side + side / 2] = 0;
+    for (const auto& portal : board.portals) {
+        board.blocked[static_cast<size_t>(portal.position.y) * side + portal.position.x] = 0;
+    }
+    return board;
+}
+
+// The straightforward way: visit cell by cell, checking each neighbour.
+// Portal entrances are counted when stepped on but only stood on when a
+// teleport lands there, so they carry two marks.
+uint32_t countByBfs(const Board& board, const Point& from, std::vector<uint8_t>& seen) {
+    constexpr uint8_t COUNTED = 1;
+    constexpr uint8_t QUEUED = 2;
+    std::fill(seen.begin(), seen.end(), 0);
+    std::deque<Point> queue;
+    uint32_t count = 0;
+    auto mark = [&](const Point& p, uint8_t flag) {
+        uint8_t& cell = seen[static_cast<size_t>(p.y) * board.width + p.x];
+        if (cell & flag) return false;
+        cell |= flag;
+        if (flag == COUNTED) count++;
+        if (flag == QUEUED) queue.push_back(p);
+        return true;
+    };
+    if (!board.isBlocked(from)) mark(from, COUNTED);
+    mark(from, QUEUED);
+
+    while (!queue.empty()) {
+        Point current = queue.front();
+        queue.pop_front();
+        for (Direction dir : MOVES) {
+            Point next = current + DirectionManager::getDirectionVector(dir);
+            if (board.wraps) {
+                next = next.wrap(board.width, board.height);
+            } else if (next.x < 0 || next.x >= board.width || next.y < 0 || next.y >= board.height) {
+                continue;
+            }
+            if (board.isBlocked(next)) continue;
+            mark(next, COUNTED);
+
+            const Portal* portal = nullptr;
+            for (const auto& candidate : board.portals) {
+                if (candidate.position == next) portal = &candidate;
+            }
+            if (!portal) {
+                mark(next, QUEUED);
+            } else if (!board.isBlocked(portal->destination)) {
+                mark(portal->destination, COUNTED);
+                mark(portal->destination, QUEUED);
+            }
+        }
+    }
+    return count;
+}
+
+// Runs fill repeatedly for about `millis` and returns microseconds per call
+double timeFill(const std::function<uint32_t()>& fill, int millis, uint32_t& result) {
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::milliseconds(millis);
+    uint64_t runs = 0;
+    do {
+        result = fill();
+        runs++;
+    } while (std::chrono::steady_clock::now() < deadline);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / runs;
+}
+
+void runBoard(int side, const char* layout, int millis) {
+    Board board = makeBoard(side, layout);
+    Point from(side / 2, side / 2);
+
+    FloodFill flood;
+    flood.reset(side, side, board.wraps, board.portals);
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            if (board.isBlocked(Point(x, y))) flood.block(Point(x, y));
+        }
+    }
+
+    std::vector<uint8_t> seen(board.blocked.size());
+    uint32_t bfsCount = 0;
+    double bfsUs = timeFill([&] { return countByBfs(board, from, seen); }, millis, bfsCount);
+
+    std::printf("%4dx%-4d %-12s %8u cells  bfs %10.1f us", side, side, layout, bfsCount, bfsUs);
+    for (FloodKernel kernel : {FloodKernel::SCALAR, FloodKernel::AVX2}) {
+        const char* name = kernel == FloodKernel::SCALAR ? "scalar" : "avx2";
+        if (!FloodFill::isSupported(kernel)) {
+            std::printf("  %s n/a", name);
+            continue;
+        }
+        flood.setKernel(kernel);
+        uint32_t count = 0;
+        double us = timeFill([&] { return flood.countReachable(from); }, millis, count);
+        std::printf("  %s %9.1f us %6.1fx", name, us, bfsUs / us);
+        if (count != bfsCount) std::printf(" MISMATCH %u", count);
+    }
+    std::printf("  %4u passes\n", flood.getPasses());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int millis = (argc > 1) ? std::atoi(argv[1]) : 300;
+    for (int side : {64, 1024}) {
+        for (const char* layout : {"open", "scatter", "coil rows", "coil columns"}) {
+            runBoard(side, layout, millis);
+        }
+    }
+    return 0;
+}
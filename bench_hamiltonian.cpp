@@ -0,0 +1,88 @@
+// Hamiltonian-cycle solver: cycle build time, time to fill the board and
+// cost per move. Portals are off, as the solver requires. Each board is
+// played from the start until the snake fills it or the move budget runs
+// out; a budget of 0 means no limit. Once the snake is half the board it
+// can only follow the cycle, so filling an n-cell board takes about
+// n*n/7 moves: 1.4e11 on 1000x1000, hours at the measured cost per move,
+// which is why that board gets a budget by default. A board cut short by
+// the budget also gets an extrapolated fill: moves per cell squared from
+// the largest board that did fill, times this board's cost per move.
+// Usage: snake_bench_hamiltonian [side] [move-budget]
+
+#include "hamiltonian.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr uint64_t DEFAULT_BUDGET = 200000000;
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct BoardRun {
+    bool filled = false;
+    uint64_t moves = 0;
+    uint32_t cells = 0;  // on the cycle
+    double seconds = 0;
+};
+
+BoardRun runBoard(int width, int height, uint64_t budget) {
+    GameConfig config = GameConfig::defaultConfig();
+    config.width = width;
+    config.height = height;
+
+    auto start = std::chrono::steady_clock::now();
+    HamiltonianSolver solver(config);
+    double buildMs = secondsSince(start) * 1000;
+    if (!solver.isValid()) {
+        std::printf("%5dx%-5d no cycle fits this board\n", width, height);
+        return {};
+    }
+
+    SimState state(config, 1, false);
+    start = std::chrono::steady_clock::now();
+    while (!state.gameOver && (budget == 0 || state.tick < budget)) {
+        step(state, solver.decide(state));
+    }
+    double seconds = secondsSince(start);
+
+    const char* outcome = state.won ? "filled" : state.gameOver ? "DIED" : "budget";
+    const HamiltonianStats& stats = solver.getStats();
+    std::printf("%5dx%-5d build %8.2f ms  %-6s %14llu moves %9d long (%5.1f%%) %10.2f s %6.1f ns/move "
+                "%5.1f%% shortcuts\n",
+                width, height, buildMs, outcome,
+                static_cast<unsigned long long>(state.tick), state.snake.getLength(),
+                std::min(100.0, 100.0 * state.snake.getLength() / solver.getCycleLength()), seconds,
+                seconds * 1e9 / state.tick, 100.0 * stats.shortcuts / stats.moves);
+    return {state.won, state.tick, solver.getCycleLength(), seconds};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int side = (argc > 1) ? std::atoi(argv[1]) : 1000;
+    uint64_t budget = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : DEFAULT_BUDGET;
+
+    // Filled in full; the last to fill is the reference for extrapolating
+    BoardRun reference;
+    for (const BoardRun& small : {runBoard(40, 20, 0), runBoard(100, 100, 0), runBoard(200, 200, 0)}) {
+        if (small.filled) reference = small;
+    }
+    BoardRun run = runBoard(side, side, budget);
+    if (run.filled || !reference.filled || run.moves == 0) return 0;
+
+    double cells = static_cast<double>(run.cells);
+    double perCellSquared = static_cast<double>(reference.moves) / reference.cells / reference.cells;
+    double moves = perCellSquared * cells * cells;
+    double seconds = moves * run.seconds / static_cast<double>(run.moves);
+    std::printf("%5dx%-5d extrapolated fill: %.2g moves (n*n/%.1f, from the %u-cell fill), %.1f h at %.1f ns/move\n",
+                side, side, moves, 1 / perCellSquared, reference.cells, seconds / 3600,
+                run.seconds * 1e9 / run.moves);
+    return 0;
+}
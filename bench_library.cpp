@@ -0,0 +1,110 @@
+// Replay library index: save, open, rebuild and query costs.
+// Short headless games are recorded and saved as input replays into a
+// scratch directory with the library attached, so every save also appends
+// to the index. The index is then reopened, rebuilt from the replay
+// headers, and queried.
+// Usage: snake_bench_library [replays]
+
+#include "replay.h"
+#include "replay_library.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr int MAX_GAME_TICKS = 400;
+constexpr int PLAYERS = 20;
+constexpr int QUERY_REPEATS = 20;
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Cheap food-seeking policy so games end with a spread of scores
+Direction chooseDirection(const SimState& state, std::mt19937& rng) {
+    Point head = state.snake.getHead();
+    Point target = state.food.getPosition();
+    if (rng() % 6 == 0) {
+        return static_cast<Direction>(rng() % 4);
+    }
+    if (target.x != head.x) {
+        return target.x > head.x ? Direction::RIGHT : Direction::LEFT;
+    }
+    return target.y > head.y ? Direction::DOWN : Direction::UP;
+}
+
+void timeQuery(const ReplayLibrary& library, const char* label, const ReplayQuery& query) {
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < QUERY_REPEATS; ++i) {
+        found = library.query(query).size();
+    }
+    std::printf("%-36s %8.3f ms  %zu results\n", label, millisecondsSince(start) / QUERY_REPEATS, found);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int count = (argc > 1) ? std::atoi(argv[1]) : 20000;
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "snake_bench_library";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    ReplayLibrary library(directory.string());
+    library.open();
+    ReplaySystem replays;
+    replays.setLibrary(&library);
+
+    GameConfig config = GameConfig::defaultConfig();
+    std::mt19937 rng(1234);
+    double saveMs = 0;
+    for (int i = 0; i < count; ++i) {
+        SimState state(config, static_cast<uint32_t>(i + 1));
+        replays.startRecording("player" + std::to_string(i % PLAYERS), state);
+        for (int t = 0; t < MAX_GAME_TICKS && !state.gameOver; ++t) {
+            Direction input = chooseDirection(state, rng);
+            replays.recordInput(state, input);
+            step(state, input);
+            replays.recordState(state.snake, state.food.getPosition(), state.score,
+                                state.snake.getCurrentCombo());
+        }
+        replays.stopRecording();
+
+        std::string path = (directory / ("replay_" + std::to_string(i) + ".replay")).string();
+        auto start = std::chrono::steady_clock::now();
+        replays.saveReplay(path);
+        saveMs += millisecondsSince(start);
+    }
+    std::printf("%d replays, %.1f us per save including the index append\n",
+                count, saveMs * 1000 / count);
+
+    ReplayLibrary reopened(directory.string());
+    auto start = std::chrono::steady_clock::now();
+    reopened.open();
+    std::printf("%-36s %8.1f ms  %zu entries\n", "open index", millisecondsSince(start), reopened.size());
+
+    start = std::chrono::steady_clock::now();
+    reopened.rebuild();
+    std::printf("%-36s %8.1f ms  %zu entries\n", "rebuild from headers", millisecondsSince(start),
+                reopened.size());
+
+    ReplayQuery query;
+    query.minCombo = 5;
+    timeQuery(reopened, "top 50 by score, combo >= 5", query);
+    query = ReplayQuery();
+    query.order = ReplayOrder::DATE;
+    timeQuery(reopened, "newest 50", query);
+    query = ReplayQuery();
+    query.playerName = "player7";
+    query.minScore = 100;
+    timeQuery(reopened, "one player, score >= 100", query);
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Frame composition and diff cost of the ANSI backend.
+// Draws a moving snake, food and score every frame, the way Game::render
+// does, and compares diffed output against repainting every drawn cell.
+// Output goes to /dev/null so only the CPU side is measured.
+// Usage: snake_bench_render [frames]
+
+#include "ansi_terminal.h"
+#include "framebuffer.h"
+#include "snake_body.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+
+using namespace SnakeGame;
+
+namespace {
+
+struct FrameStats {
+    double usPerFrame;
+    double bytesPerFrame;
+    double cellsPerFrame;
+};
+
+FrameStats runFrames(AnsiTerminal& terminal, int width, int height, int frames, bool fullRepaint) {
+    FrameBuffer frame(width, height + 2);
+    std::string bytes;
+    SnakeBody body;
+    for (int i = 0; i < 30; ++i) body.pushBack(Point(30 - i, height / 2));
+
+    // The first frame paints the whole screen; measure steady state only
+    frame.diff(bytes);
+
+    size_t totalBytes = 0;
+    size_t totalCells = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        Point head = body.front();
+        body.advance(Point((head.x + 1) % width, head.y));
+
+        if (fullRepaint) frame.invalidate();
+        frame.clear();
+        for (int x = 0; x < width; ++x) {
+            frame.put(x, 0, '#');
+            frame.put(x, height - 1, '#');
+        }
+        for (int y = 0; y < height; ++y) {
+            frame.put(0, y, '#');
+            frame.put(width - 1, y, '#');
+        }
+        for (size_t i = 0; i < body.size(); ++i) {
+            Point p = body[i];
+            frame.put(p.x, p.y, i == 0 ? '@' : 'o', 0x0A);
+        }
+        frame.put(width / 3, height / 3, '*', 0x0C);
+        frame.putString(0, height + 1, "Score: " + std::to_string(f / 10));
+
+        bytes.clear();
+        totalCells += frame.diff(bytes);
+        totalBytes += bytes.size();
+        terminal.write(bytes);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double us = std::chrono::duration<double, std::micro>(elapsed).count();
+    return {us / frames, static_cast<double>(totalBytes) / frames,
+            static_cast<double>(totalCells) / frames};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int frames = (argc > 1) ? std::atoi(argv[1]) : 2000;
+
+    int devNull = open("/dev/null", O_WRONLY);
+    if (devNull < 0) {
+        std::perror("open /dev/null");
+        return 1;
+    }
+
+    {
+        AnsiTerminal terminal(devNull);
+        std::printf("%11s %10s %12s %12s %12s\n", "board", "mode",
+                    "us/frame", "bytes/frame", "cells/frame");
+        const int boards[][2] = {{40, 20}, {200, 100}, {1000, 1000}};
+        for (const auto& board : boards) {
+            for (bool full : {false, true}) {
+                int runFramesCount = full && board[0] >= 1000 ? frames / 20 + 1 : frames;
+                FrameStats stats = runFrames(terminal, board[0], board[1], runFramesCount, full);
+                std::printf("%5dx%-5d %10s %12.2f %12.0f %12.0f\n", board[0], board[1],
+                            full ? "repaint" : "diff", stats.usPerFrame,
+                            stats.bytesPerFrame, stats.cellsPerFrame);
+            }
+        }
+    }
+
+    close(devNull);
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Replay size and encode cost versus snake length.
+// A snake circles a boustrophedon cycle on a wrap-around board while the
+// v2 delta encoder records every tick; the v1 text size is sampled over
+// the first ticks for comparison. Each run is decoded back and checked.
+// Usage: snake_bench_replay [ticks-per-length]
+
+#include "snake.h"
+#include "replay_v2.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr int BOARD_SIZE = 256;
+constexpr int V1_SAMPLE_TICKS = 100;
+
+Direction cycleDirection(const Point& head) {
+    if (head.y % 2 == 0) {
+        return head.x < BOARD_SIZE - 1 ? Direction::RIGHT : Direction::DOWN;
+    }
+    return head.x > 0 ? Direction::LEFT : Direction::DOWN;
+}
+
+// Bytes one state takes in the old text format
+size_t v1StateSize(const Snake& snake, const Point& food, int score, int combo, int64_t ms) {
+    std::ostringstream out;
+    out << snake.getLength() << "\n";
+    for (Point point : snake.getBody()) {
+        out << point.x << " " << point.y << "\n";
+    }
+    out << food.x << " " << food.y << "\n" << score << "\n" << combo << "\n" << ms << "\n";
+    return out.str().size();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int ticks = (argc > 1) ? std::atoi(argv[1]) : 20000;
+
+    GameConfig config = GameConfig::defaultConfig();
+    config.width = BOARD_SIZE;
+    config.height = BOARD_SIZE;
+    config.wrapAround = true;
+
+    std::printf("%8s %10s %12s %12s %10s %12s\n",
+                "length", "v2 B/tick", "v1 B/tick", "ratio", "blocks", "encode ns");
+    for (int length : {10, 100, 1000, 10000}) {
+        Snake snake(1, 0, 2, config.width, config.height);
+        while (snake.getLength() < length) {
+            snake.move(cycleDirection(snake.getHead()), config);
+            snake.grow();
+        }
+
+        ReplayEncoder encoder;
+        size_t v1Bytes = 0;
+        Point food(BOARD_SIZE / 2, BOARD_SIZE / 2);
+        int score = 0;
+        double encodeNs = 0;
+
+        for (int i = 0; i < ticks; ++i) {
+            snake.move(cycleDirection(snake.getHead()), config);
+            // Eat every 50 ticks so growth, food and score deltas show up
+            if (i % 50 == 49) {
+                snake.grow();
+                score += 10;
+                food = Point((i * 7919) % BOARD_SIZE, (i * 104729) % BOARD_SIZE);
+            }
+            int64_t ms = static_cast<int64_t>(i) * 100;
+
+            auto start = std::chrono::steady_clock::now();
+            encoder.record(snake.getBody(), snake.getMoveCount(), snake.getGrowCount(),
+                           food, score, 1, ms);
+            encodeNs += std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count();
+
+            if (i < V1_SAMPLE_TICKS) v1Bytes += v1StateSize(snake, food, score, 1, ms);
+        }
+        encoder.finish();
+
+        std::vector<ReplayFrame> frames;
+        ByteReader reader(encoder.data().data(), encoder.data().size());
+        uint32_t blocks = 0;
+        bool ok = decodeReplayBlocks(reader, frames, blocks) &&
+                  frames.size() == static_cast<size_t>(ticks) &&
+                  frames.back().snakeBody.size() == snake.getBody().size() &&
+                  frames.back().snakeBody.front() == snake.getHead() &&
+                  frames.back().snakeBody.back() == snake.getBody().back() &&
+                  frames.back().score == score;
+        if (!ok) {
+            std::fprintf(stderr, "round trip failed at length %d\n", length);
+            return 1;
+        }
+
+        double v2PerTick = static_cast<double>(encoder.data().size()) / ticks;
+        double v1PerTick = static_cast<double>(v1Bytes) / V1_SAMPLE_TICKS;
+        std::printf("%8d %10.2f %12.1f %11.0fx %10u %12.1f\n",
+                    length, v2PerTick, v1PerTick, v1PerTick / v2PerTick,
+                    encoder.blockCount(), encodeNs / ticks);
+    }
+    return 0;
+}
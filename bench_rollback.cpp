@@ -0,0 +1,230 @@
+// Rollback harness: two RollbackSession peers play a versus game over a
+// simulated link with the given one-way latency and random jitter. The
+// link keeps order, as TCP would. Time is virtual, so a run takes as long
+// as the simulation and not the game. Each peer steers greedily for the
+// food from what it currently believes. That mostly means no input, with a
+// turn now and then, and every turn becomes a misprediction on the other
+// side. Reports rollback depth, re-simulation cost against the tick
+// budget and save/restore cost. It then checks both peers against a
+// reference Arena stepped with the inputs that were really sent.
+// Usage: snake_bench_rollback [ticks] [latency-ms] [jitter-ms] [tick-ms]
+
+#include "rollback.h"
+#include "rng.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr int BOARD_WIDTH = 40;
+constexpr int BOARD_HEIGHT = 20;
+constexpr int RESPAWN_TICKS = 10;
+constexpr int MAX_PREDICTION = 12;
+constexpr uint32_t WANDER_ODDS = 25;  // one tick in this many turns at random
+constexpr int COST_REPEATS = 20000;
+
+constexpr Direction DIRECTIONS[] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+
+volatile uint64_t sink;
+
+struct Message {
+    double arrives;  // ms
+    uint64_t tick;
+    Direction input;
+};
+
+struct Peer {
+    Peer(const Arena& start, int seat, uint32_t seed) : session(start, seat, MAX_PREDICTION), rng(seed) {}
+
+    RollbackSession session;
+    std::mt19937 rng;
+    std::deque<Message> outbox;      // in flight to the other peer
+    double lastArrival = 0;
+    std::vector<Direction> sent{Direction::NONE};  // by tick
+    uint64_t stalls = 0;
+};
+
+int wrapDistance(int a, int b, int size) {
+    int d = std::abs(a - b);
+    return std::min(d, size - d);
+}
+
+// Greedy for the nearest food in the peer's current view; NONE to carry on
+Direction choose(Peer& peer) {
+    const Arena& arena = peer.session.getArena();
+    const ArenaSnake& snake = arena.getSnake(peer.session.getLocalSeat());
+    if (!snake.alive) return Direction::NONE;
+    if (boundedRandom(peer.rng, WANDER_ODDS) == 0) return DIRECTIONS[boundedRandom(peer.rng, 4)];
+
+    const GameConfig& config = arena.getConfig();
+    Point head = snake.body.front();
+    Direction best = snake.heading;
+    int bestDistance = INT_MAX;
+    for (Direction dir : DIRECTIONS) {
+        if (DirectionManager::isOpposite(dir, snake.heading)) continue;
+        Point next = (head + DirectionManager::getDirectionVector(dir)).wrap(config.width, config.height);
+        if (arena.getOccupancy().isOccupied(next)) continue;
+        int distance = INT_MAX - 1;
+        for (const Point& food : arena.getFood()) {
+            if (food.x < 0) continue;
+            distance = std::min(distance, wrapDistance(next.x, food.x, config.width) +
+                                              wrapDistance(next.y, food.y, config.height));
+        }
+        if (distance < bestDistance || (distance == bestDistance && dir == snake.heading)) {
+            best = dir;
+            bestDistance = distance;
+        }
+    }
+    return best == snake.heading ? Direction::NONE : best;
+}
+
+bool sameState(const Arena& a, const Arena& b) {
+    if (a.getTick() != b.getTick() || a.getFood().size() != b.getFood().size()) return false;
+    for (size_t i = 0; i < a.getFood().size(); ++i) {
+        if (a.getFood()[i] != b.getFood()[i]) return false;
+    }
+    for (int i = 0; i < a.getSnakeCount(); ++i) {
+        const ArenaSnake& x = a.getSnake(i);
+        const ArenaSnake& y = b.getSnake(i);
+        if (x.alive != y.alive || x.score != y.score || x.deaths != y.deaths || x.heading != y.heading ||
+            x.body.size() != y.body.size()) {
+            return false;
+        }
+        for (size_t j = 0; j < x.body.size(); ++j) {
+            if (x.body.packedAt(j) != y.body.packedAt(j)) return false;
+        }
+    }
+    return true;
+}
+
+template <typename Fn>
+double nanosEach(Fn fn) {
+    auto began = std::chrono::steady_clock::now();
+    for (int i = 0; i < COST_REPEATS; ++i) fn();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - began).count() /
+           COST_REPEATS;
+}
+
+double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(fraction * (values.size() - 1))];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t ticks = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 5000;
+    double latency = (argc > 2) ? std::atof(argv[2]) : 60;
+    double jitter = (argc > 3) ? std::atof(argv[3]) : 20;
+    double tickMs = (argc > 4) ? std::atof(argv[4]) : 16;
+
+    GameConfig config = GameConfig::defaultConfig();
+    config.width = BOARD_WIDTH;
+    config.height = BOARD_HEIGHT;
+    config.wrapAround = true;
+    Arena start(config, 2, 2, 12345, RESPAWN_TICKS);
+    start.setHuman(0, true);
+    start.setHuman(1, true);
+
+    Peer peers[2] = {Peer(start, 0, 1), Peer(start, 1, 2)};
+    std::mt19937 linkRng(3);
+    std::vector<double> resimMicros;
+    std::vector<uint64_t> depths(MAX_PREDICTION + 2, 0);
+
+    // One round per tick of virtual time: take what has arrived, then advance
+    for (uint64_t round = 0; peers[0].session.getTick() < ticks || peers[1].session.getTick() < ticks; ++round) {
+        double now = static_cast<double>(round) * tickMs;
+        for (int p = 0; p < 2; ++p) {
+            Peer& self = peers[p];
+            Peer& other = peers[1 - p];
+            while (!other.outbox.empty() && other.outbox.front().arrives <= now) {
+                self.session.addRemoteInput(other.outbox.front().tick, other.outbox.front().input);
+                other.outbox.pop_front();
+            }
+            if (self.session.getTick() >= ticks) continue;
+            if (!self.session.canAdvance()) {
+                self.stalls++;
+                continue;
+            }
+            Direction input = choose(self);
+            RollbackFrame frame = self.session.advance(input);
+            if (frame.depth > 0) {
+                depths[std::min<size_t>(frame.depth, depths.size() - 1)]++;
+                resimMicros.push_back(std::chrono::duration<double, std::micro>(frame.resim).count());
+            }
+            self.sent.push_back(input);
+            double arrives = now + latency + unitRandom(linkRng) * jitter;
+            self.lastArrival = std::max(self.lastArrival, arrives);
+            self.outbox.push_back({self.lastArrival, self.session.getTick(), input});
+        }
+    }
+
+    // Deliver the rest and settle both sides
+    for (int p = 0; p < 2; ++p) {
+        for (const Message& message : peers[1 - p].outbox) {
+            peers[p].session.addRemoteInput(message.tick, message.input);
+        }
+        RollbackFrame frame = peers[p].session.resolve();
+        if (frame.depth > 0) {
+            depths[std::min<size_t>(frame.depth, depths.size() - 1)]++;
+            resimMicros.push_back(std::chrono::duration<double, std::micro>(frame.resim).count());
+        }
+    }
+
+    Arena truth = start;
+    for (uint64_t t = 1; t <= ticks; ++t) {
+        Direction inputs[2] = {peers[0].sent[t], peers[1].sent[t]};
+        truth.step(inputs);
+    }
+    bool agree = sameState(truth, peers[0].session.getArena()) && sameState(truth, peers[1].session.getArena());
+
+    // Save, restore and a whole-Arena copy, on the final board
+    ArenaSnapshot snapshot;
+    Arena scratch = truth;
+    double saveNs = nanosEach([&] { truth.save(snapshot); sink += snapshot.tick; });
+    double restoreNs = nanosEach([&] { scratch.restore(snapshot); sink += scratch.getTick(); });
+    Arena copy = truth;
+    double copyNs = nanosEach([&] { copy = truth; sink += copy.getTick(); });
+    size_t snapshotBytes = sizeof(ArenaSnapshot) + snapshot.food.size() * sizeof(Point);
+    for (const ArenaSnake& snake : snapshot.snakes) snapshotBytes += sizeof(ArenaSnake) + snake.body.capacity() * 4;
+
+    uint64_t rollbacks = 0, resimulated = 0, mispredictions = 0, stalls = 0;
+    int maxDepth = 0;
+    for (const Peer& peer : peers) {
+        const RollbackStats& stats = peer.session.getStats();
+        rollbacks += stats.rollbacks;
+        resimulated += stats.resimulatedTicks;
+        mispredictions += stats.mispredictions;
+        maxDepth = std::max(maxDepth, stats.maxDepth);
+        stalls += peer.stalls;
+    }
+
+    std::printf("%llu ticks of %.0f ms, latency %.0f ms + up to %.0f ms jitter, %dx%d board\n",
+                static_cast<unsigned long long>(ticks), tickMs, latency, jitter, BOARD_WIDTH, BOARD_HEIGHT);
+    std::printf("rollbacks   %llu from %llu mispredicted inputs (both peers), %llu ticks re-simulated, "
+                "%llu stalls\n",
+                static_cast<unsigned long long>(rollbacks), static_cast<unsigned long long>(mispredictions),
+                static_cast<unsigned long long>(resimulated), static_cast<unsigned long long>(stalls));
+    std::printf("depth       mean %.1f  max %d   ", rollbacks ? static_cast<double>(resimulated) / rollbacks : 0.0,
+                maxDepth);
+    for (size_t d = 1; d < depths.size(); ++d) {
+        if (depths[d]) std::printf(" %zu%s:%llu", d, d + 1 == depths.size() ? "+" : "",
+                                   static_cast<unsigned long long>(depths[d]));
+    }
+    std::printf("\n");
+    std::printf("re-sim      p50 %.2f us  p99 %.2f us  max %.2f us  (%.4f%% of a tick at p99)\n",
+                percentile(resimMicros, 0.5), percentile(resimMicros, 0.99), percentile(resimMicros, 1.0),
+                percentile(resimMicros, 0.99) / (tickMs * 10.0));
+    std::printf("state       save %.0f ns  restore %.0f ns  snapshot %zu bytes  (whole Arena copy %.0f ns)\n",
+                saveNs, restoreNs, snapshotBytes, copyNs);
+    std::printf("peers %s the reference game\n", agree ? "match" : "DO NOT match");
+    return agree ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+// Loopback load test for GameServer. Runs the server on a second thread
+// and connects two clients per room from this one, over a Unix socket (or
+// TCP with --tcp). Each client rebuilds its room from the frames it gets
+// with an ArenaView, which rejects any delta that does not follow and any
+// GAME_OVER whose scores disagree, and sends a random turn now and then.
+// Reports the server's per-tick work and lateness, bytes per client per
+// tick and how many views went wrong.
+// Usage: snake_bench_server [rooms] [seconds] [--tcp]
+
+#include "game_server.h"
+#include "rng.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr auto TICK = std::chrono::milliseconds(100);
+constexpr uint64_t GAME_TICKS = 300;
+constexpr uint32_t TURN_ODDS = 8;  // one delta in this many gets a turn back
+
+struct BenchClient {
+    int fd = -1;
+    std::vector<uint8_t> in;
+    ArenaView view;
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint64_t games = 0;
+    bool broken = false;
+};
+
+int connectTo(const ServerOptions& options, int port, bool tcp) {
+    int fd;
+    if (tcp) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        inet_pton(AF_INET, options.address.c_str(), &address.sin_addr);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) return -1;
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    } else {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, options.unixPath.c_str(), sizeof(address.sun_path) - 1);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) return -1;
+    }
+    return fd;
+}
+
+void sendFrame(int fd, NetProtocol::MessageType type, uint64_t tick, uint8_t value) {
+    std::vector<uint8_t> out;
+    NetProtocol::appendFrame(out, type, [&](ByteWriter& w) {
+        if (type == NetProtocol::TURN) w.varint(tick);
+        w.u8(value);
+    });
+    ssize_t ignored = ::send(fd, out.data(), out.size(), MSG_NOSIGNAL);
+    (void)ignored;
+}
+
+// Reads what is waiting and applies every whole frame
+void receive(BenchClient& client, std::mt19937& rng) {
+    uint8_t buffer[16384];
+    ssize_t got;
+    while ((got = recv(client.fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+        client.in.insert(client.in.end(), buffer, buffer + got);
+        client.bytes += static_cast<uint64_t>(got);
+    }
+
+    size_t used = 0;
+    NetProtocol::Frame frame;
+    long taken;
+    while ((taken = NetProtocol::readFrame(client.in.data() + used, client.in.size() - used, frame)) > 0) {
+        used += static_cast<size_t>(taken);
+        client.frames++;
+        if (!client.view.apply(frame)) client.broken = true;
+        if (frame.type == NetProtocol::GAME_OVER) client.games++;
+        if (frame.type == NetProtocol::DELTA && boundedRandom(rng, TURN_ODDS) == 0) {
+            sendFrame(client.fd, NetProtocol::TURN, 0, static_cast<uint8_t>(boundedRandom(rng, 4)));
+        }
+    }
+    client.in.erase(client.in.begin(), client.in.begin() + used);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int rooms = (argc > 1) ? std::atoi(argv[1]) : 2000;
+    int seconds = (argc > 2) ? std::atoi(argv[2]) : 10;
+    bool tcp = argc > 3 && std::strcmp(argv[3], "--tcp") == 0;
+
+    ServerOptions options;
+    options.config.wrapAround = true;
+    options.tick = TICK;
+    options.maxTicks = GAME_TICKS;
+    if (tcp) {
+        options.port = 0;
+    } else {
+        options.unixPath = "/tmp/snake_bench_server." + std::to_string(getpid()) + ".sock";
+    }
+    GameServer server(options);
+    if (!server.start()) {
+        std::fprintf(stderr, "snake_bench_server: %s\n", server.getError().c_str());
+        return 1;
+    }
+    std::thread serverThread([&server] { server.run(); });
+
+    int epollFd = epoll_create1(0);
+    std::vector<BenchClient> clients(static_cast<size_t>(rooms) * 2);
+    for (size_t i = 0; i < clients.size(); ++i) {
+        clients[i].fd = connectTo(options, server.getPort(), tcp);
+        if (clients[i].fd < 0) {
+            std::fprintf(stderr, "snake_bench_server: connect failed after %zu clients\n", i);
+            server.stop();
+            serverThread.join();
+            return 1;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, clients[i].fd, &event);
+        sendFrame(clients[i].fd, NetProtocol::JOIN, 0, NetProtocol::PROTOCOL_VERSION);
+    }
+
+    std::mt19937 rng(1);
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    std::vector<epoll_event> events(1024);
+    while (std::chrono::steady_clock::now() < end) {
+        int count = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 50);
+        for (int i = 0; i < count; ++i) receive(clients[events[i].data.u64], rng);
+    }
+
+    server.stop();
+    serverThread.join();
+    ServerStats stats = server.getStats();
+
+    uint64_t frames = 0, bytes = 0, games = 0;
+    int broken = 0;
+    for (BenchClient& client : clients) {
+        frames += client.frames;
+        bytes += client.bytes;
+        games += client.games;
+        broken += client.broken;
+        close(client.fd);
+    }
+    close(epollFd);
+
+    double clientTicks = static_cast<double>(clients.size()) * stats.ticks;
+    std::printf("%d rooms over %s, %llu ticks of %lld ms (%llu skipped)\n", rooms, tcp ? "TCP" : "Unix sockets",
+                static_cast<unsigned long long>(stats.ticks), static_cast<long long>(TICK.count()),
+                static_cast<unsigned long long>(stats.skippedTicks));
+    std::printf("tick work   p50 %lld us  p99 %lld us  max %lld us  (%.2f us per room)\n",
+                static_cast<long long>(stats.tickP50.count()), static_cast<long long>(stats.tickP99.count()),
+                static_cast<long long>(stats.tickMax.count()),
+                static_cast<double>(stats.tickP50.count()) / rooms);
+    std::printf("tick start  p50 %lld us  p99 %lld us  max %lld us late\n",
+                static_cast<long long>(stats.schedule.jitterP50.count()),
+                static_cast<long long>(stats.schedule.jitterP99.count()),
+                static_cast<long long>(stats.schedule.jitterMax.count()));
+    std::printf("clients     %llu frames, %.1f bytes per client per tick, %llu games finished, "
+                "%llu dropped, %d views broken\n",
+                static_cast<unsigned long long>(frames), clientTicks > 0 ? bytes / clientTicks : 0.0,
+                static_cast<unsigned long long>(games), static_cast<unsigned long long>(stats.dropped), broken);
+    return broken == 0 ? 0 : 1;
+}
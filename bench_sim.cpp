@@ -0,0 +1,73 @@
+// Headless throughput benchmark for the simulation core.
+// Usage: snake_bench_sim [ticks-per-board]
+
+#include "sim.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace SnakeGame;
+
+namespace {
+
+// Cheap food-seeking policy so games last long enough to exercise growth
+Direction chooseDirection(const SimState& state, std::mt19937& rng) {
+    Point head = state.snake.getHead();
+    Point target = state.food.getPosition();
+
+    if (rng() % 8 == 0) {
+        return static_cast<Direction>(rng() % 4);
+    }
+    if (target.x != head.x) {
+        return target.x > head.x ? Direction::RIGHT : Direction::LEFT;
+    }
+    return target.y > head.y ? Direction::DOWN : Direction::UP;
+}
+
+void runBoard(int width, int height, uint64_t ticks) {
+    GameConfig config = GameConfig::defaultConfig();
+    config.width = width;
+    config.height = height;
+
+    std::mt19937 policyRng(1234);
+    uint32_t seed = 1;
+    SimState state(config, seed);
+
+    uint64_t games = 1;
+    uint64_t foodEaten = 0;
+    std::chrono::steady_clock::duration resetTime{};
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < ticks; ++i) {
+        StepEvents events = step(state, chooseDirection(state, policyRng));
+        if (events.ateFood) foodEaten++;
+        if (state.gameOver) {
+            // Board setup is O(area); keep it out of the per-tick figure
+            auto resetStart = std::chrono::steady_clock::now();
+            state = SimState(config, ++seed);
+            resetTime += std::chrono::steady_clock::now() - resetStart;
+            games++;
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start - resetTime;
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double resetUs = std::chrono::duration<double, std::micro>(resetTime).count() / games;
+
+    std::printf("%5dx%-5d %12llu ticks %8llu games %10llu food %14.0f ticks/s %10.1f ns/tick %10.1f us/reset\n",
+                width, height,
+                static_cast<unsigned long long>(ticks),
+                static_cast<unsigned long long>(games),
+                static_cast<unsigned long long>(foodEaten),
+                ticks / seconds, seconds * 1e9 / ticks, resetUs);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t ticks = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+
+    runBoard(20, 20, ticks);
+    runBoard(40, 20, ticks);
+    runBoard(1000, 1000, ticks);
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Huge-world costs: memory and tick rate of a SimState on boards up to
+// 65536x65536, and what it costs to find the cells of an 80x24 camera
+// window. The snake wanders at random on a wrap-around board. Grid memory
+// is the chunked occupancy grid; "dense" is what one count and one
+// free-cell slot per cell would take. The window test then grows a long
+// snake and compares walking its whole body with asking the grid about
+// each cell in view, which is how Renderer::drawSnake keeps a frame's cost
+// tied to the terminal rather than to the snake or the world.
+// Usage: snake_bench_world [ticks] [length]
+
+#include "rng.h"
+#include "sim.h"
+#include "viewport.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr int VIEW_COLUMNS = 80;
+constexpr int VIEW_ROWS = 21;  // 24 less the status lines
+
+volatile size_t sink;
+
+double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void runWorld(int side, uint64_t ticks) {
+    GameConfig config = GameConfig::defaultConfig();
+    config.width = side;
+    config.height = side;
+
+    auto start = std::chrono::steady_clock::now();
+    SimState state(config, 1, true);
+    double setup = seconds(start);
+
+    // Straight runs with a random turn now and then; restart on death
+    std::mt19937 rng(7);
+    uint64_t games = 1;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < ticks; ++i) {
+        Direction input = boundedRandom(rng, 16) == 0 ? static_cast<Direction>(boundedRandom(rng, 4))
+                                                      : Direction::NONE;
+        step(state, input);
+        if (state.gameOver) {
+            state = SimState(config, static_cast<uint32_t>(i), true);
+            games++;
+        }
+    }
+    double elapsed = seconds(start);
+
+    const OccupancyGrid& grid = state.snake.getOccupancy();
+    double dense = static_cast<double>(side) * side * (sizeof(uint16_t) + 2 * sizeof(uint32_t));
+    std::printf("%5dx%-5d  setup %8.3f ms  %7.1fM ticks/s  %6llu games  %4zu chunks  "
+                "grid %8.2f MB  dense %10.1f MB\n",
+                side, side, setup * 1e3, ticks / elapsed / 1e6, static_cast<unsigned long long>(games),
+                grid.getChunksInUse(), grid.memoryBytes() / 1048576.0, dense / 1048576.0);
+}
+
+// Cells of the window the snake covers, found by walking the body
+size_t windowByBody(const Snake& snake, const Viewport& view) {
+    size_t drawn = 0;
+    Point screen;
+    for (Point p : snake.getBody()) {
+        drawn += view.toScreen(p, screen);
+    }
+    return drawn;
+}
+
+// The same, found by looking each window cell up in the grid
+size_t windowByGrid(const Snake& snake, const Viewport& view) {
+    const OccupancyGrid& grid = snake.getOccupancy();
+    size_t drawn = 0;
+    for (int y = 0; y < view.getRows(); ++y) {
+        for (int x = 0; x < view.getColumns(); ++x) {
+            drawn += grid.isOccupied(view.toWorld(Point(x, y)));
+        }
+    }
+    return drawn;
+}
+
+void runWindow(int length) {
+    GameConfig config = GameConfig::defaultConfig();
+    config.width = MAX_WORLD_SIZE;
+    config.height = MAX_WORLD_SIZE;
+
+    // Rows of 200 cells, stacked downward, so the body fills the window
+    Snake snake(config.width / 2, config.height / 2, 3, config.width, config.height);
+    auto now = std::chrono::steady_clock::time_point();
+    for (int i = 0; snake.getLength() < length; ++i) {
+        int run = i % 202;
+        Direction dir = run < 200 ? ((i / 202) % 2 == 0 ? Direction::RIGHT : Direction::LEFT) : Direction::DOWN;
+        snake.move(dir, config);
+        snake.grow(now);
+    }
+    Viewport view(config.width, config.height, config.wrapAround);
+    view.resize(VIEW_COLUMNS, VIEW_ROWS);
+    view.centerOn(snake.getBody()[snake.getLength() / 2]);
+
+    constexpr int FRAMES = 200;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FRAMES; ++i) sink = windowByBody(snake, view);
+    double body = seconds(start) / FRAMES;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FRAMES; ++i) sink = windowByGrid(snake, view);
+    double grid = seconds(start) / FRAMES;
+
+    std::printf("length %8d  %dx%d window: %4zu cells of snake  body walk %9.1f us/frame  "
+                "grid lookups %6.1f us/frame  %5zu chunks, %.2f MB\n",
+                snake.getLength(), VIEW_COLUMNS, VIEW_ROWS, windowByGrid(snake, view), body * 1e6,
+                grid * 1e6, snake.getOccupancy().getChunksInUse(),
+                snake.getOccupancy().memoryBytes() / 1048576.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t ticks = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    int length = (argc > 2) ? std::atoi(argv[2]) : 1000000;
+
+    runWorld(40, ticks);
+    runWorld(1024, ticks);
+    runWorld(16384, ticks);
+    runWorld(MAX_WORLD_SIZE, ticks);
+    std::printf("\n");
+    runWindow(1000);
+    runWindow(length);
+    return 0;
+}
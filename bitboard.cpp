@@ -0,0 +1,312 @@
+#include "bitboard.h"
+#include <algorithm>
+#include <bitset>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SNAKE_FLOOD_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace SnakeGame {
+
+namespace {
+
+constexpr Direction MOVES[] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+
+inline size_t popCount(uint64_t word) {
+    return std::bitset<64>(word).count();
+}
+
+// Spreads gen along the runs of set bits in open, both ways, in six
+// doubling steps each. gen may hold bits outside open (the head); they
+// spread but are not themselves checked.
+inline uint64_t fillWord(uint64_t gen, uint64_t open) {
+    uint64_t pro = open;
+    gen |= pro & (gen << 1);  pro &= pro << 1;
+    gen |= pro & (gen << 2);  pro &= pro << 2;
+    gen |= pro & (gen << 4);  pro &= pro << 4;
+    gen |= pro & (gen << 8);  pro &= pro << 8;
+    gen |= pro & (gen << 16); pro &= pro << 16;
+    gen |= pro & (gen << 32);
+    pro = open;
+    gen |= pro & (gen >> 1);  pro &= pro >> 1;
+    gen |= pro & (gen >> 2);  pro &= pro >> 2;
+    gen |= pro & (gen >> 4);  pro &= pro >> 4;
+    gen |= pro & (gen >> 8);  pro &= pro >> 8;
+    gen |= pro & (gen >> 16); pro &= pro >> 16;
+    gen |= pro & (gen >> 32);
+    return gen;
+}
+
+// Takes the open cells of `incoming` into `reach` and floods each word that
+// gained any. Returns whether one did.
+bool mergeRowScalar(uint64_t* reach, const uint64_t* incoming, const uint64_t* open, size_t words) {
+    bool changed = false;
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t added = incoming[i] & open[i] & ~reach[i];
+        if (added != 0) {
+            reach[i] = fillWord(reach[i] | added, open[i]);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+#ifdef SNAKE_FLOOD_AVX2
+
+__attribute__((target("avx2"))) inline __m256i fillLanes(__m256i gen, __m256i open) {
+    __m256i pro = open;
+#define SNAKE_FILL_STEP(shift, n)                                              \
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shift(gen, n)));          \
+    pro = _mm256_and_si256(pro, shift(pro, n));
+    SNAKE_FILL_STEP(_mm256_slli_epi64, 1)
+    SNAKE_FILL_STEP(_mm256_slli_epi64, 2)
+    SNAKE_FILL_STEP(_mm256_slli_epi64, 4)
+    SNAKE_FILL_STEP(_mm256_slli_epi64, 8)
+    SNAKE_FILL_STEP(_mm256_slli_epi64, 16)
+    SNAKE_FILL_STEP(_mm256_slli_epi64, 32)
+    pro = open;
+    SNAKE_FILL_STEP(_mm256_srli_epi64, 1)
+    SNAKE_FILL_STEP(_mm256_srli_epi64, 2)
+    SNAKE_FILL_STEP(_mm256_srli_epi64, 4)
+    SNAKE_FILL_STEP(_mm256_srli_epi64, 8)
+    SNAKE_FILL_STEP(_mm256_srli_epi64, 16)
+    SNAKE_FILL_STEP(_mm256_srli_epi64, 32)
+#undef SNAKE_FILL_STEP
+    return gen;
+}
+
+// mergeRowScalar a 256-bit lane at a time; rows are padded to whole lanes
+__attribute__((target("avx2")))
+bool mergeRowAvx2(uint64_t* reach, const uint64_t* incoming, const uint64_t* open, size_t words) {
+    bool changed = false;
+    for (size_t i = 0; i < words; i += BitBoard::ROW_LANE_WORDS) {
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(reach + i));
+        __m256i o = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(open + i));
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(incoming + i));
+        __m256i added = _mm256_andnot_si256(r, _mm256_and_si256(in, o));
+        if (_mm256_testz_si256(added, added)) continue;
+        r = fillLanes(_mm256_or_si256(r, added), o);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(reach + i), r);
+        changed = true;
+    }
+    return changed;
+}
+
+#endif
+
+} // namespace
+
+BitBoard::BitBoard(int width, int height) : width(0), height(0), rowWords(0) {
+    resize(width, height);
+}
+
+void BitBoard::resize(int newWidth, int newHeight) {
+    width = std::max(newWidth, 0);
+    height = std::max(newHeight, 0);
+    size_t lanes = (static_cast<size_t>(width) + 255) / 256;
+    rowWords = lanes * ROW_LANE_WORDS;
+    words.assign(rowWords * height, 0);
+}
+
+void BitBoard::clear() {
+    std::fill(words.begin(), words.end(), 0);
+}
+
+void BitBoard::fill() {
+    for (int y = 0; y < height; ++y) {
+        uint64_t* bits = row(y);
+        for (size_t i = 0; i < rowWords; ++i) {
+            int first = static_cast<int>(i) * 64;
+            if (first + 64 <= width) {
+                bits[i] = ~uint64_t(0);
+            } else if (first < width) {
+                bits[i] = (uint64_t(1) << (width - first)) - 1;
+            } else {
+                bits[i] = 0;
+            }
+        }
+    }
+}
+
+size_t BitBoard::count() const {
+    size_t total = 0;
+    for (uint64_t word : words) {
+        total += popCount(word);
+    }
+    return total;
+}
+
+FloodFill::FloodFill()
+    : wraps(false)
+    , kernel(isSupported(FloodKernel::AVX2) ? FloodKernel::AVX2 : FloodKernel::SCALAR)
+    , passes(0) {
+}
+
+bool FloodFill::isSupported(FloodKernel value) {
+    if (value == FloodKernel::SCALAR) return true;
+#ifdef SNAKE_FLOOD_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void FloodFill::setKernel(FloodKernel value) {
+    kernel = isSupported(value) ? value : FloodKernel::SCALAR;
+}
+
+void FloodFill::reset(int width, int height, bool wrapAround, const std::vector<Portal>& boardPortals) {
+    if (width != open.getWidth() || height != open.getHeight()) {
+        open.resize(width, height);
+        reached.resize(width, height);
+    }
+    open.fill();
+    wraps = wrapAround;
+    portals.clear();
+    for (const auto& portal : boardPortals) {
+        if (portal.active && open.contains(portal.position) && open.contains(portal.destination)) {
+            portals.push_back(portal);
+            open.reset(portal.position);
+        }
+    }
+}
+
+void FloodFill::load(const SimState& state) {
+    reset(state.config.width, state.config.height, state.config.wrapAround, state.portals);
+    for (const Point& segment : state.snake.getBody()) {
+        open.reset(segment);
+    }
+    // A portal into the body is a dead end
+    portals.erase(std::remove_if(portals.begin(), portals.end(),
+                                 [&](const Portal& portal) {
+                                     return state.snake.checkCollision(portal.destination);
+                                 }),
+                  portals.end());
+}
+
+uint32_t FloodFill::countReachable(const Point& from) {
+    reached.clear();
+    passes = 0;
+    if (!reached.contains(from)) return 0;
+    seed(from);
+
+    int height = open.getHeight();
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int y = 0; y < height; ++y) {
+            if (y > 0) {
+                changed |= mergeRow(y, y - 1);
+            } else if (wraps) {
+                changed |= mergeRow(y, height - 1);
+            }
+        }
+        for (int y = height - 1; y >= 0; --y) {
+            if (y < height - 1) {
+                changed |= mergeRow(y, y + 1);
+            } else if (wraps) {
+                changed |= mergeRow(y, 0);
+            }
+        }
+        for (const auto& portal : portals) {
+            if (!reached.test(portal.destination) && touchesReached(portal.position)) {
+                seed(portal.destination);
+                changed = true;
+            }
+        }
+        passes++;
+    }
+
+    // Open cells plus the portal cells the head can get onto
+    size_t total = 0;
+    for (int y = 0; y < height; ++y) {
+        const uint64_t* reach = reached.row(y);
+        const uint64_t* free = open.row(y);
+        for (size_t i = 0; i < open.getRowWords(); ++i) {
+            total += popCount(reach[i] & free[i]);
+        }
+    }
+    for (size_t i = 0; i < portals.size(); ++i) {
+        const Point& entrance = portals[i].position;
+        bool counted = false;
+        for (size_t j = 0; j < i && !counted; ++j) {
+            counted = portals[j].position == entrance;
+        }
+        if (!counted && (touchesReached(entrance) || (entrance != from && reached.test(entrance)))) {
+            total++;
+        }
+    }
+    return static_cast<uint32_t>(total);
+}
+
+bool FloodFill::mergeRow(int y, int from) {
+    bool changed;
+#ifdef SNAKE_FLOOD_AVX2
+    if (kernel == FloodKernel::AVX2) {
+        changed = mergeRowAvx2(reached.row(y), reached.row(from), open.row(y), open.getRowWords());
+    } else
+#endif
+    {
+        changed = mergeRowScalar(reached.row(y), reached.row(from), open.row(y), open.getRowWords());
+    }
+    if (changed) closeRow(y);
+    return changed;
+}
+
+void FloodFill::closeRow(int y) {
+    uint64_t* reach = reached.row(y);
+    const uint64_t* free = open.row(y);
+    size_t words = open.getRowWords();
+    int width = open.getWidth();
+    constexpr uint64_t LOW = 1;
+    constexpr uint64_t HIGH = uint64_t(1) << 63;
+
+    for (;;) {
+        // Runs crossing a word boundary, rightward then leftward
+        for (size_t i = 1; i < words; ++i) {
+            if ((reach[i - 1] & HIGH) && (free[i] & ~reach[i] & LOW)) {
+                reach[i] = fillWord(reach[i] | LOW, free[i]);
+            }
+        }
+        for (size_t i = words - 1; i > 0; --i) {
+            if ((reach[i] & LOW) && (free[i - 1] & ~reach[i - 1] & HIGH)) {
+                reach[i - 1] = fillWord(reach[i - 1] | HIGH, free[i - 1]);
+            }
+        }
+        if (!wraps) return;
+
+        // Rotate across the seam between the last column and the first
+        size_t lastWord = static_cast<size_t>(width - 1) >> 6;
+        uint64_t lastBit = uint64_t(1) << ((width - 1) & 63);
+        if ((reach[lastWord] & lastBit) && (free[0] & ~reach[0] & LOW)) {
+            reach[0] = fillWord(reach[0] | LOW, free[0]);
+        } else if ((reach[0] & LOW) && (free[lastWord] & ~reach[lastWord] & lastBit)) {
+            reach[lastWord] = fillWord(reach[lastWord] | lastBit, free[lastWord]);
+        } else {
+            return;
+        }
+    }
+}
+
+void FloodFill::seed(const Point& p) {
+    reached.set(p);
+    uint64_t* word = reached.row(p.y) + (p.x >> 6);
+    *word = fillWord(*word, open.row(p.y)[p.x >> 6]);
+    closeRow(p.y);
+}
+
+bool FloodFill::touchesReached(const Point& p) const {
+    int width = open.getWidth();
+    int height = open.getHeight();
+    for (Direction dir : MOVES) {
+        Point next = p + DirectionManager::getDirectionVector(dir);
+        if (wraps) {
+            next = next.wrap(width, height);
+        }
+        if (reached.test(next)) return true;
+    }
+    return false;
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "point.h"
+#include "portal.h"
+#include "sim.h"
+
+namespace SnakeGame {
+
+// One bit per cell, row-major. Every row is padded to a whole number of
+// 256-bit lanes (ROW_LANE_WORDS 64-bit words) so a kernel can walk it with
+// full-width vector loads; padding bits are always clear.
+class BitBoard {
+public:
+    static constexpr size_t ROW_LANE_WORDS = 4;
+
+    BitBoard(int width = 0, int height = 0);
+
+    // Resizes and clears every cell
+    void resize(int width, int height);
+    void clear();
+    // Sets every cell on the board
+    void fill();
+
+    bool contains(const Point& p) const {
+        return p.x >= 0 && p.x < width && p.y >= 0 && p.y < height;
+    }
+    bool test(const Point& p) const {
+        return contains(p) && (words[wordIndex(p)] >> (p.x & 63) & 1) != 0;
+    }
+    void set(const Point& p) {
+        if (contains(p)) words[wordIndex(p)] |= uint64_t(1) << (p.x & 63);
+    }
+    void reset(const Point& p) {
+        if (contains(p)) words[wordIndex(p)] &= ~(uint64_t(1) << (p.x & 63));
+    }
+    // Number of set cells
+    size_t count() const;
+
+    uint64_t* row(int y) { return words.data() + static_cast<size_t>(y) * rowWords; }
+    const uint64_t* row(int y) const { return words.data() + static_cast<size_t>(y) * rowWords; }
+    size_t getRowWords() const { return rowWords; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+private:
+    int width;
+    int height;
+    size_t rowWords;
+    std::vector<uint64_t> words;
+
+    size_t wordIndex(const Point& p) const {
+        return static_cast<size_t>(p.y) * rowWords + (p.x >> 6);
+    }
+};
+
+enum class FloodKernel {
+    SCALAR,
+    AVX2
+};
+
+// Reachable-area queries on a bitboard: "how many cells can the head still
+// get to?" without visiting cells one at a time.
+//
+// The fill sweeps the board top to bottom and back, alternately, until a
+// sweep changes nothing. Each row takes in its neighbour's reached cells,
+// then floods along its own free runs with shift-and-mask (Kogge-Stone)
+// steps, 64 cells per word at once; runs that cross a word boundary are
+// carried into the next word. On a wrap-around board the row's two ends
+// are joined and the last row feeds the first. An open board settles in
+// two sweeps; a winding corridor needs about one per turn back.
+//
+// Portal entrances are kept out of the open cells, since the head never
+// moves on from one: reaching an entrance floods on from its destination.
+class FloodFill {
+public:
+    FloodFill();
+
+    // Open cells are the whole board minus the snake's body and active
+    // portal entrances
+    void load(const SimState& state);
+    // An all-open board to block cells on by hand
+    void reset(int width, int height, bool wraps, const std::vector<Portal>& portals = {});
+    void block(const Point& p) { open.reset(p); }
+    void unblock(const Point& p) { open.set(p); }
+
+    // Number of cells a snake at `from` can move into, including portal
+    // cells; `from` itself counts only if it is open
+    uint32_t countReachable(const Point& from);
+    // Result of the last countReachable
+    const BitBoard& getReached() const { return reached; }
+    const BitBoard& getOpen() const { return open; }
+    // Top-to-bottom and bottom-to-top sweep pairs the last fill took
+    uint32_t getPasses() const { return passes; }
+
+    // The AVX2 kernel is used by default wherever the CPU has it
+    void setKernel(FloodKernel value);
+    FloodKernel getKernel() const { return kernel; }
+    static bool isSupported(FloodKernel kernel);
+
+private:
+    BitBoard open;
+    BitBoard reached;
+    bool wraps;
+    std::vector<Portal> portals;
+    FloodKernel kernel;
+    uint32_t passes;
+
+    bool mergeRow(int y, int from);
+    void closeRow(int y);
+    void seed(const Point& p);
+    bool touchesReached(const Point& p) const;
+};
+
+} // namespace SnakeGame
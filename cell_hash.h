@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SnakeGame {
+
+// Open-addressing map from a packed cell (SnakeBody::pack) to an int, for
+// sets of cells too sparse to give a grid: food on a huge board, or the
+// cells heads move into this tick. Linear probing over a power-of-two
+// table kept at most half full.
+//
+// Slots carry the generation they were written in, so clear() is one
+// increment however big the table is, and erase() shifts later entries of
+// the probe run back instead of leaving tombstones.
+class CellHash {
+public:
+    static constexpr int NOT_FOUND = -1;
+
+    explicit CellHash(size_t expected = 8) : count(0), generation(1) {
+        size_t capacity = 16;
+        while (capacity < expected * 2) capacity <<= 1;
+        rehash(capacity);
+    }
+
+    size_t size() const { return count; }
+
+    void clear() {
+        count = 0;
+        if (++generation == 0) {
+            // Wrapped: old stamps could read as current again
+            for (Slot& slot : slots) slot.stamp = 0;
+            generation = 1;
+        }
+    }
+
+    int find(uint32_t key) const {
+        for (size_t i = home(key);; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (slot.stamp != generation) return NOT_FOUND;
+            if (slot.key == key) return slot.value;
+        }
+    }
+
+    // Adds key -> value and returns NOT_FOUND, or returns the value already
+    // stored for key and leaves it in place
+    int insert(uint32_t key, int value) {
+        if ((count + 1) * 2 > slots.size()) rehash(slots.size() * 2);
+        for (size_t i = home(key);; i = (i + 1) & mask) {
+            Slot& slot = slots[i];
+            if (slot.stamp != generation) {
+                slot = Slot{key, value, generation};
+                count++;
+                return NOT_FOUND;
+            }
+            if (slot.key == key) return slot.value;
+        }
+    }
+
+    bool erase(uint32_t key) {
+        size_t i = home(key);
+        for (;; i = (i + 1) & mask) {
+            if (slots[i].stamp != generation) return false;
+            if (slots[i].key == key) break;
+        }
+        // Pull back any later entry whose home the hole now cuts it off from
+        for (size_t j = (i + 1) & mask; slots[j].stamp == generation; j = (j + 1) & mask) {
+            size_t wanted = home(slots[j].key);
+            if (((j - wanted) & mask) >= ((j - i) & mask)) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i].stamp = 0;
+        count--;
+        return true;
+    }
+
+private:
+    struct Slot {
+        uint32_t key;
+        int32_t value;
+        uint32_t stamp;
+    };
+
+    std::vector<Slot> slots;
+    size_t mask;
+    int shift;
+    size_t count;
+    uint32_t generation;
+
+    size_t home(uint32_t key) const {
+        // Fibonacci hashing: packed cells of a row differ only in low bits
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old;
+        old.swap(slots);
+        uint32_t oldGeneration = generation;
+        slots.assign(capacity, Slot{0, 0, 0});
+        mask = capacity - 1;
+        shift = 64;
+        for (size_t c = capacity; c > 1; c >>= 1) shift--;
+        generation = 1;
+        count = 0;
+        for (const Slot& slot : old) {
+            if (slot.stamp == oldGeneration) insert(slot.key, slot.value);
+        }
+    }
+};
+
+} // namespace SnakeGame
@@ -18,10 +18,17 @@ constexpr int BACKGROUND_INTENSITY = 0x0080;
 // Game dimensions
 constexpr int DEFAULT_WIDTH = 20;
 constexpr int DEFAULT_HEIGHT = 20;
+// Body cells pack each coordinate into 16 bits, which bounds the world.
+// The snake starts three long mid-board, heading right.
+constexpr int MIN_WORLD_SIZE = 4;
+constexpr int MAX_WORLD_SIZE = 65536;
+// Snakes an arena game (--arena) may hold, the player included
+constexpr int MAX_ARENA_SNAKES = 100000;
 
 // Game characters
 constexpr char SNAKE_HEAD = '@';
 constexpr char SNAKE_BODY = 'o';
+constexpr char RIVAL_HEAD = '&';
 constexpr char FOOD = '*';
 constexpr char PORTAL = 'O';
 constexpr char EMPTY = ' ';
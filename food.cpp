@@ -1,55 +1,58 @@
 #include "food.h"
+#include "rng.h"
 #include <random>
 #include <algorithm>
 
 namespace SnakeGame {
 
 Food::Food(const GameConfig& config) 
-    : type(FoodType::NORMAL)
+    : position(-1, -1)
+    , placed(false)
+    , type(FoodType::NORMAL)
     , displayChar(FOOD)
     , config(config) {
     std::random_device rd;
     rng.seed(rd());
 }
 
-void Food::place(const std::deque<Point>& snakeBody, const GameConfig& config) {
+Food::Food(const GameConfig& config, uint32_t seed)
+    : position(-1, -1)
+    , placed(false)
+    , type(FoodType::NORMAL)
+    , displayChar(FOOD)
+    , config(config)
+    , rng(seed) {
+}
+
+bool Food::place(const Snake& snake, const GameConfig& config) {
     this->config = config;
-    type = generateFoodType(config);
-    position = generatePosition(config.width, config.height, snakeBody);
-    updateDisplayChar();
+    return respawn(snake);
 }
 
-void Food::respawn(const std::deque<Point>& snakeBody) {
+bool Food::respawn(const Snake& snake) {
     type = generateFoodType(config);
-    position = generatePosition(config.width, config.height, snakeBody);
+    placed = generatePosition(snake);
     updateDisplayChar();
+    return placed;
 }
 
 FoodType Food::generateFoodType(const GameConfig& config) {
     if (!config.enableSpecialFood) return FoodType::NORMAL;
     
-    std::uniform_real_distribution<double> dist(0.0, 1.0);
-    double chance = dist(rng);
+    double chance = unitRandom(rng);
     
     if (chance < 0.1) return FoodType::SPEED_BOOST;
     if (chance < 0.2) return FoodType::REVERSE_CONTROLS;
     return FoodType::NORMAL;
 }
 
-Point Food::generatePosition(int width, int height, const std::deque<Point>& snakeBody) {
-    std::uniform_int_distribution<int> xDist(1, width - 2);
-    std::uniform_int_distribution<int> yDist(1, height - 2);
-    
-    Point newPos;
-    do {
-        newPos = Point(xDist(rng), yDist(rng));
-    } while (!isValidPosition(newPos, snakeBody));
-    
-    return newPos;
-}
-
-bool Food::isValidPosition(const Point& pos, const std::deque<Point>& snakeBody) const {
-    return std::find(snakeBody.begin(), snakeBody.end(), pos) == snakeBody.end();
+bool Food::generatePosition(const Snake& snake) {
+    // Uniform over the free interior cells, drawn from the snake's index
+    if (snake.getOccupancy().randomFreeCell(rng, position)) {
+        return true;
+    }
+    position = Point(-1, -1);
+    return false;
 }
 
 void Food::updateDisplayChar() {
@@ -66,10 +69,6 @@ void Food::updateDisplayChar() {
     }
 }
 
-char Food::getDisplayChar() const {
-    return displayChar;
-}
-
 std::chrono::milliseconds Food::getEffectDuration() const {
     switch (type) {
         case FoodType::SPEED_BOOST:
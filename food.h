@@ -1,8 +1,9 @@
 #pragma once
 
-#include <deque>
+#include <cstdint>
 #include "point.h"
 #include "constants.h"
+#include "snake.h"
 #include <random>
 #include <chrono>
 
@@ -11,10 +12,14 @@ namespace SnakeGame {
 class Food {
 public:
     Food(const GameConfig& config);
+    Food(const GameConfig& config, uint32_t seed);
     
-    void place(const std::deque<Point>& snakeBody, const GameConfig& config);
-    void respawn(const std::deque<Point>& snakeBody);
+    // Both return false when every spawnable cell is taken; the food is
+    // then left off the board
+    bool place(const Snake& snake, const GameConfig& config);
+    bool respawn(const Snake& snake);
     const Point& getPosition() const { return position; }
+    bool isPlaced() const { return placed; }
     FoodType getType() const { return type; }
     char getDisplayChar() const { return displayChar; }
     
@@ -23,14 +28,14 @@ public:
 
 private:
     Point position;
+    bool placed;
     FoodType type;
     char displayChar;
     GameConfig config;
     std::mt19937 rng;
     
     FoodType generateFoodType(const GameConfig& config);
-    Point generatePosition(int width, int height, const std::deque<Point>& snakeBody);
-    bool isValidPosition(const Point& pos, const std::deque<Point>& snakeBody) const;
+    bool generatePosition(const Snake& snake);
     void updateDisplayChar();
 };
 
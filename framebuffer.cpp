@@ -0,0 +1,126 @@
+#include "framebuffer.h"
+#include <algorithm>
+
+namespace SnakeGame {
+
+namespace {
+
+constexpr Cell BLANK{' ', FrameBuffer::DEFAULT_COLOR};
+
+// Runs separated by fewer unchanged cells than this are sent as one run;
+// rewriting a couple of cells is cheaper than another cursor move
+constexpr uint32_t MERGE_GAP = 4;
+
+} // namespace
+
+FrameBuffer::FrameBuffer(int width, int height)
+    : width(0), height(0), lastColor(DEFAULT_COLOR) {
+    resize(width, height);
+}
+
+void FrameBuffer::resize(int width, int height) {
+    this->width = std::max(width, 0);
+    this->height = std::max(height, 0);
+    size_t cells = static_cast<size_t>(this->width) * this->height;
+    back.assign(cells, BLANK);
+    front.assign(cells, BLANK);
+    flags.assign(cells, 0);
+    drawnCells.clear();
+    dirtyCells.clear();
+    invalidate();
+}
+
+void FrameBuffer::clear() {
+    for (uint32_t cell : drawnCells) {
+        back[cell] = BLANK;
+        flags[cell] &= ~DRAWN;
+        markDirty(cell);
+    }
+    drawnCells.clear();
+}
+
+void FrameBuffer::put(int x, int y, char glyph, uint8_t color) {
+    if (x < 0 || x >= width || y < 0 || y >= height) return;
+
+    uint32_t cell = static_cast<uint32_t>(y) * width + x;
+    Cell next{glyph, color};
+    if (back[cell] == next) return;
+    back[cell] = next;
+
+    if (!(flags[cell] & DRAWN)) {
+        flags[cell] |= DRAWN;
+        drawnCells.push_back(cell);
+    }
+    markDirty(cell);
+}
+
+void FrameBuffer::putString(int x, int y, const std::string& text, uint8_t color) {
+    for (size_t i = 0; i < text.size(); ++i) {
+        put(x + static_cast<int>(i), y, text[i], color);
+    }
+}
+
+size_t FrameBuffer::diff(std::string& out) {
+    changedCells.clear();
+    for (uint32_t cell : dirtyCells) {
+        flags[cell] &= ~DIRTY;
+        if (back[cell] != front[cell]) changedCells.push_back(cell);
+    }
+    dirtyCells.clear();
+    std::sort(changedCells.begin(), changedCells.end());
+
+    size_t i = 0;
+    while (i < changedCells.size()) {
+        // Extend the run across short stretches of unchanged cells in the row
+        uint32_t runStart = changedCells[i];
+        uint32_t runEnd = runStart + 1;
+        uint32_t rowEnd = (runStart / width + 1) * width;
+        ++i;
+        while (i < changedCells.size() && changedCells[i] < rowEnd &&
+               changedCells[i] - runEnd < MERGE_GAP) {
+            runEnd = changedCells[i] + 1;
+            ++i;
+        }
+
+        appendCursor(out, static_cast<int>(runStart % width), static_cast<int>(runStart / width));
+        for (uint32_t cell = runStart; cell < runEnd; ++cell) {
+            if (back[cell].color != lastColor) {
+                appendColor(out, back[cell].color);
+                lastColor = back[cell].color;
+            }
+            out.push_back(back[cell].glyph);
+            front[cell] = back[cell];
+        }
+    }
+
+    return changedCells.size();
+}
+
+void FrameBuffer::invalidate() {
+    // Mark the front buffer as unknown by making it differ from any glyph
+    std::fill(front.begin(), front.end(), Cell{'\0', 0});
+    for (uint32_t cell = 0; cell < back.size(); ++cell) {
+        markDirty(cell);
+    }
+    lastColor = 0xFF;
+}
+
+void FrameBuffer::appendColor(std::string& out, uint8_t color) {
+    // Console attribute bits are blue=1, green=2, red=4, intensity=8 while
+    // ANSI numbers colors red=1, green=2, blue=4
+    int ansi = ((color & 0x4) ? 1 : 0) | ((color & 0x2) ? 2 : 0) | ((color & 0x1) ? 4 : 0);
+    int base = (color & 0x8) ? 90 : 30;
+    out += "\x1b[";
+    out += std::to_string(base + ansi);
+    out += 'm';
+}
+
+void FrameBuffer::appendCursor(std::string& out, int x, int y) {
+    out += "\x1b[";
+    out += std::to_string(y + 1);
+    out += ';';
+    out += std::to_string(x + 1);
+    out += 'H';
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SnakeGame {
+
+// One terminal cell: a glyph and a console color attribute (the same
+// FOREGROUND_* bits the Windows console uses)
+struct Cell {
+    char glyph;
+    uint8_t color;
+
+    bool operator==(const Cell& other) const {
+        return glyph == other.glyph && color == other.color;
+    }
+    bool operator!=(const Cell& other) const { return !(*this == other); }
+};
+
+// Double-buffered screen. Drawing goes into the back buffer; diff() turns
+// the changes since the last frame into ANSI escape sequences and promotes
+// the back buffer to the front. The buffer keeps lists of the cells drawn
+// and the cells touched since the last diff, so clear() and diff() cost is
+// proportional to what was drawn, not to the screen area.
+class FrameBuffer {
+public:
+    static constexpr uint8_t DEFAULT_COLOR = 0x07;  // red | green | blue
+
+    FrameBuffer(int width = 0, int height = 0);
+
+    void resize(int width, int height);
+    void clear();
+    void put(int x, int y, char glyph, uint8_t color = DEFAULT_COLOR);
+    void putString(int x, int y, const std::string& text, uint8_t color = DEFAULT_COLOR);
+
+    // Append the escape sequences for this frame to out. Returns the number
+    // of cells that changed.
+    size_t diff(std::string& out);
+    // Forget what is on screen so the next diff repaints every drawn cell
+    void invalidate();
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+private:
+    static constexpr uint8_t DRAWN = 0x1;  // holds content in back
+    static constexpr uint8_t DIRTY = 0x2;  // may differ from front
+
+    int width;
+    int height;
+    std::vector<Cell> back;
+    std::vector<Cell> front;
+    std::vector<uint8_t> flags;
+    std::vector<uint32_t> drawnCells;
+    std::vector<uint32_t> dirtyCells;
+    std::vector<uint32_t> changedCells;  // scratch for diff()
+    uint8_t lastColor;
+
+    void markDirty(uint32_t cell) {
+        if (!(flags[cell] & DIRTY)) {
+            flags[cell] |= DIRTY;
+            dirtyCells.push_back(cell);
+        }
+    }
+    static void appendColor(std::string& out, uint8_t color);
+    static void appendCursor(std::string& out, int x, int y);
+};
+
+} // namespace SnakeGame
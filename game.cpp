@@ -1,16 +1,57 @@
 #include "game.h"
-#include <conio.h>
+#include <cstdio>
 #include <fstream>
 #include <thread>
 #include <iostream>
 #include <random>
 #include <algorithm>
 #include <filesystem>
+#include <iterator>
 
 namespace SnakeGame {
 
+namespace {
+
+// Turns buffered ahead of the snake; more than this and the oldest wins
+constexpr size_t MAX_PENDING_DIRECTIONS = 3;
+
+// Longest the loop sleeps before looking at input again (pause, ESC)
+constexpr auto INPUT_POLL_INTERVAL = std::chrono::milliseconds(10);
+
+// Replay playback pacing and how far a seek jumps while playing
+constexpr auto REPLAY_FRAME_INTERVAL = std::chrono::milliseconds(100);
+constexpr auto REPLAY_MIN_INTERVAL = std::chrono::milliseconds(10);
+constexpr auto REPLAY_MAX_INTERVAL = std::chrono::milliseconds(800);
+constexpr uint32_t REPLAY_SEEK_TICKS = 50;
+
+// Replay menu: rows on screen and the combo filters 'c' cycles through
+constexpr int REPLAY_MENU_ROWS = 15;
+constexpr int REPLAY_COMBO_FILTERS[] = {0, 5, 10};
+
+// World sizes the config screen cycles through
+constexpr int WORLD_SIZES[][2] = {{20, 20}, {30, 30}, {40, 20}, {256, 256}, {4096, 4096}, {65536, 65536}};
+
+// The autopilot and the cycle solver keep buffers per cell; past this they
+// sit out and the keys steer
+constexpr size_t MAX_SEARCH_CELLS = size_t(1) << 24;
+
+// Arena games: one food per snake, and bots come back this long after dying
+constexpr int ARENA_RESPAWN_TICKS = 20;
+
+Direction directionForAction(InputAction action) {
+    switch (action) {
+        case InputAction::MOVE_UP:    return Direction::UP;
+        case InputAction::MOVE_DOWN:  return Direction::DOWN;
+        case InputAction::MOVE_LEFT:  return Direction::LEFT;
+        case InputAction::MOVE_RIGHT: return Direction::RIGHT;
+        default:                      return Direction::NONE;
+    }
+}
+
+} // namespace
+
 Game::Game()
-    : score(0), highScore(0), gameOver(false), paused(false),
+    : solverMode(false), searchFits(true), arenaSnakes(0), highScore(0), gameOver(false), paused(false),
       gameSpeed(std::chrono::milliseconds(200)), hardcoreMode(false),
       minimalMode(false), portalUseCount(0), currentState(GameState::START_SCREEN) {
     initialize();
@@ -40,125 +81,203 @@ void Game::run() {
 
 void Game::initialize() {
     config = GameConfig::defaultConfig();
-    snake = std::make_unique<Snake>(config.width / 2, config.height / 2);
-    food = std::make_unique<Food>(config);
+    sim = std::make_unique<SimState>(config, std::random_device{}());
     renderer = std::make_unique<Renderer>(config);
     replaySystem = std::make_unique<ReplaySystem>();
+    replayLibrary = std::make_unique<ReplayLibrary>("replays");
     achievementSystem = std::make_unique<AchievementSystem>();
+    input = std::make_unique<InputThread>();
+    scheduler = std::make_unique<TickScheduler>(gameSpeed);
     
     loadHighScore();
-    initializePortals();
+    
+    // Salvage frame recordings cut short by a crash
+    replayLibrary->open();
+    std::vector<std::string> recovered;
+    recoverReplayStreams("replays", &recovered);
+    for (const auto& path : recovered) {
+        replayLibrary->addFile(path);
+    }
+    replaySystem->setLibrary(replayLibrary.get());
     
     // Set renderer mode
     renderer->setMinimalMode(minimalMode);
 }
 
-void Game::initializePortals() {
-    // Create two portals at opposite corners
-    portals.clear();
-    portals.push_back({Point(1, 1), Point(config.width - 2, config.height - 2), true});
-    portals.push_back({Point(config.width - 2, config.height - 2), Point(1, 1), true});
-}
-
 void Game::runGameLoop() {
     gameStartTime = std::chrono::steady_clock::now();
-    startReplayRecording();
+    // Replays and achievements follow a single snake, so arenas skip them
+    if (!arena) startReplayRecording();
+    
+    scheduler->setPeriod(gameSpeed);
+    scheduler->start();
+    render();
     
     while (!gameOver && currentState == GameState::PLAYING) {
         handleInput();
         
         auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastUpdate);
-        
-        if (elapsed >= gameSpeed && !paused) {
-            update();
-            lastUpdate = now;
+        if (paused) {
+            // Re-anchor so the first tick after resuming gets a full period
+            scheduler->start(now);
+            render();
+        } else {
+            int due = scheduler->ticksDue(now);
+            for (int i = 0; i < due && !gameOver; ++i) {
+                update();
+            }
+            if (due > 0) {
+                render();
+            }
         }
         
-        render();
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        TickScheduler::sleepUntil(std::min(scheduler->nextDeadline(), now + INPUT_POLL_INTERVAL));
     }
     
     if (gameOver) {
         stopReplayRecording();
-        updateAchievements();
-        renderer->drawGameOver(score);
-        _getch(); // Wait for key press
+        if (!arena) updateAchievements();
+        renderer->drawGameOver(arena ? arena->getSnake(0).score : sim->score);
+        renderer->refresh();
+        input->wait(); // Wait for key press
+        currentState = GameState::START_SCREEN;
     }
 }
 
 void Game::handleInput() {
-    if (_kbhit()) {
-        char key = _getch();
-        switch (key) {
-            case 'w':
-            case 'W':
-            case 's':
-            case 'S':
-            case 'a':
-            case 'A':
-            case 'd':
-            case 'D':
-                if (!paused) {
-                    Direction dir = DirectionManager::fromChar(key);
-                    snake->move(dir, config);
+    // Drain everything the input thread queued since the last frame
+    InputEvent event;
+    while (input->poll(event)) {
+        switch (event.action) {
+            case InputAction::MOVE_UP:
+            case InputAction::MOVE_DOWN:
+            case InputAction::MOVE_LEFT:
+            case InputAction::MOVE_RIGHT:
+                if (!paused && !steeredByBot() && pendingDirections.size() < MAX_PENDING_DIRECTIONS) {
+                    Direction dir = directionForAction(event.action);
+                    pendingDirections.push_back(dir);
                     if (replaySystem->isRecording()) {
                         replaySystem->recordMove(dir);
                     }
                 }
                 break;
-            case 'p':
-            case 'P':
+            case InputAction::PAUSE:
                 paused = !paused;
                 break;
-            case 27: // ESC
+            case InputAction::BACK:
                 if (paused) {
                     currentState = GameState::START_SCREEN;
                 } else {
                     paused = true;
                 }
                 break;
+            default:
+                break;
         }
     }
 }
 
 void Game::update() {
     if (gameOver || paused) return;
+    if (arena) {
+        updateArena();
+        return;
+    }
     
-    snake->move(snake->getCurrentDirection(), config);
-    checkCollisions();
-    checkPortalCollisions();
+    // The rules live in the simulation core; the game only reacts to events
+    sim->tickDuration = gameSpeed;
+    Direction dir = Direction::NONE;
+    if (steeredByBot()) {
+        if (solver) {
+            dir = solver->decide(*sim);
+        } else if (neuralPilot) {
+            dir = neuralPilot->decide(*sim);
+        } else {
+            dir = autopilot->decide(*sim);
+        }
+        if (dir != Direction::NONE && dir != sim->snake.getCurrentDirection() &&
+            replaySystem->isRecording()) {
+            replaySystem->recordMove(dir);
+        }
+    } else if (!pendingDirections.empty()) {
+        dir = pendingDirections.front();
+        pendingDirections.pop_front();
+    }
+    if (replaySystem->isRecording()) {
+        replaySystem->recordInput(*sim, dir);
+    }
+    StepEvents events = step(*sim, dir);
     
-    if (snake->getHead() == food->getPosition()) {
+    if (events.teleported) {
+        portalUseCount++;
+    }
+    if (events.ateFood) {
         handleFoodEaten();
     }
+    if (events.died) {
+        handleDeath();
+    }
+    if (events.boardFull) {
+        // Every cell is filled: the game ends as a win
+        gameOver = true;
+        saveHighScore();
+    }
     
     // Record game state for replay
     if (replaySystem->isRecording()) {
-        replaySystem->recordState(snake->getBody(), food->getPosition(), 
-                                score, snake->getCurrentCombo());
+        replaySystem->recordState(sim->snake, sim->food.getPosition(), 
+                                sim->score, sim->snake.getCurrentCombo());
+    }
+}
+
+void Game::updateArena() {
+    // The player's turns go in slot 0; bots steer themselves
+    Direction dir = Direction::NONE;
+    if (!pendingDirections.empty()) {
+        dir = pendingDirections.front();
+        pendingDirections.pop_front();
+    }
+    arenaInputs[0] = dir;
+    arena->step(arenaInputs.data());
+    
+    // Rivals respawn; the player's first death ends the game
+    if (arena->getSnake(0).deaths > 0) {
+        gameOver = true;
     }
 }
 
 void Game::render() {
     renderer->clear();
     
+    if (arena) {
+        const ArenaSnake& player = arena->getSnake(0);
+        if (player.alive) renderer->followCamera(player.body.front());
+        renderer->drawArena(*arena, 0);
+        renderer->drawScore(player.score, highScore);
+        renderer->drawArenaStatus(arena->getAliveCount(), arena->getSnakeCount());
+        renderer->refresh();
+        return;
+    }
+    
     if (!minimalMode) {
         // Draw portals
-        for (const auto& portal : portals) {
+        for (const auto& portal : sim->portals) {
             if (portal.active) {
                 renderer->drawPortal(portal.position);
             }
         }
     }
     
-    // Draw snake and food
-    renderer->drawSnake(snake->getBody());
-    renderer->drawFood(food->getPosition());
+    // Draw snake and food, scrolled to keep the head in view
+    renderer->followCamera(sim->snake.getHead());
+    renderer->drawSnake(sim->snake);
+    if (sim->food.isPlaced()) {
+        renderer->drawFood(sim->food.getPosition());
+    }
     
     // Draw score and combo
-    renderer->drawScore(score, highScore);
-    renderer->drawCombo(snake->getCurrentCombo());
+    renderer->drawScore(sim->score, highScore);
+    renderer->drawCombo(sim->snake.getCurrentCombo());
     
     if (hardcoreMode) {
         renderer->drawHardcoreMode();
@@ -176,8 +295,8 @@ void Game::loadHighScore() {
 }
 
 void Game::saveHighScore() {
-    if (score > highScore) {
-        highScore = score;
+    if (sim->score > highScore) {
+        highScore = sim->score;
         std::ofstream file("highscore.txt");
         if (file.is_open()) {
             file << highScore;
@@ -187,36 +306,56 @@ void Game::saveHighScore() {
 }
 
 void Game::showStartScreen() {
-    renderer->showStartScreen();
+    renderer->drawStartScreen();
+    renderer->refresh();
     while (true) {
-        char key = _getch();
-        if (key == 13) break; // Enter
-        if (key == 'c' || key == 'C') {
-            showConfigScreen();
+        InputEvent event = input->wait();
+        if (event.action == InputAction::CONFIRM || event.key == '1') {
+            resetGame();
+            currentState = GameState::PLAYING;
+            break;
+        }
+        if (event.key == 'c' || event.key == 'C' || event.key == '2') {
+            currentState = GameState::CONFIG_SCREEN;
             break;
         }
-        if (key == 27) { // ESC
-            gameOver = true;
+        if (event.action == InputAction::BACK || event.key == '3') {
+            currentState = GameState::EXIT;
+            break;
+        }
+        if (event.key == 'r' || event.key == 'R' || event.key == '4') {
+            currentState = GameState::REPLAY_MENU;
             break;
         }
     }
 }
 
 void Game::showConfigScreen() {
-    renderer->showConfigScreen(config);
+    renderer->drawConfigScreen(config);
+    renderer->refresh();
     handleConfigInput();
+    currentState = GameState::START_SCREEN;
 }
 
 void Game::handleConfigInput() {
     while (true) {
-        char key = _getch();
-        if (key == 13) break; // Enter
+        InputEvent event = input->wait();
+        char key = event.key;
+        if (event.action == InputAction::CONFIRM) break; // Enter
         
         switch (key) {
-            case '1':
-                config.width = (config.width == 20) ? 30 : 20;
-                config.height = (config.height == 20) ? 30 : 20;
+            case '1': {
+                // Next size in the list; anything else starts it over
+                size_t next = 0;
+                for (size_t i = 0; i < std::size(WORLD_SIZES); ++i) {
+                    if (config.width == WORLD_SIZES[i][0] && config.height == WORLD_SIZES[i][1]) {
+                        next = (i + 1) % std::size(WORLD_SIZES);
+                    }
+                }
+                config.width = WORLD_SIZES[next][0];
+                config.height = WORLD_SIZES[next][1];
                 break;
+            }
             case '2':
                 config.mode = (config.mode == GameMode::CLASSIC) ? 
                              GameMode::WRAP_AROUND : GameMode::CLASSIC;
@@ -232,59 +371,51 @@ void Game::handleConfigInput() {
                 config.enableAnimations = !config.enableAnimations;
                 break;
         }
-        renderer->showConfigScreen(config);
+        renderer->drawConfigScreen(config);
+        renderer->refresh();
     }
 }
 
 void Game::resetGame() {
-    snake = std::make_unique<Snake>(config.width / 2, config.height / 2);
-    food = std::make_unique<Food>(config);
+    sim = std::make_unique<SimState>(config, std::random_device{}(), !solverMode);
     renderer = std::make_unique<Renderer>(config);
+    searchFits = static_cast<size_t>(config.width) * config.height <= MAX_SEARCH_CELLS;
+    solver.reset();
+    if (solverMode && searchFits) {
+        // The board size may have changed on the config screen
+        solver = std::make_unique<HamiltonianSolver>(config);
+        if (!solver->isValid()) solver.reset();
+    }
+    
+    arena.reset();
+    if (arenaSnakes > 0) {
+        arena = std::make_unique<Arena>(config, arenaSnakes, arenaSnakes, std::random_device{}(),
+                                        ARENA_RESPAWN_TICKS);
+        // Whatever would steer a lone snake hands over to the arena's bot
+        arena->setHuman(0, !steeredByBot());
+        arenaInputs.assign(arenaSnakes, Direction::NONE);
+    }
     
-    score = 0;
     gameOver = false;
     paused = false;
     gameSpeed = std::chrono::milliseconds(200);
-    lastUpdate = std::chrono::steady_clock::now();
-    
-    food->place(snake->getBody(), config);
+    pendingDirections.clear();
+    portalUseCount = 0;
 }
 
-void Game::checkCollisions() {
-    if (snake->checkSelfCollision() || 
-        (config.mode == GameMode::CLASSIC && snake->checkWallCollision(config))) {
-        gameOver = true;
-        if (config.enableAnimations) {
-            renderer->animateSnakeDeath(snake->getBody());
-        }
-        saveHighScore();
-    }
-}
-
-void Game::checkPortalCollisions() {
-    if (snake->isTeleporting()) return;
-    
-    Point head = snake->getHead();
-    for (const auto& portal : portals) {
-        if (portal.active && head == portal.position) {
-            snake->teleportTo(portal.destination);
-            break;
-        }
+void Game::handleDeath() {
+    gameOver = true;
+    if (config.enableAnimations) {
+        renderer->animateSnakeDeath(sim->snake.getBody());
     }
+    saveHighScore();
 }
 
 void Game::handleFoodEaten() {
-    int basePoints = 10;
-    int comboMultiplier = snake->getComboMultiplier();
-    score += basePoints * comboMultiplier;
-    
-    if (score > highScore) {
-        highScore = score;
+    if (sim->score > highScore) {
         saveHighScore();
     }
     
-    snake->grow();
-    food->respawn(snake->getBody());
     updateHardcoreSpeed();
 }
 
@@ -292,6 +423,7 @@ void Game::toggleHardcoreMode() {
     hardcoreMode = !hardcoreMode;
     if (hardcoreMode) {
         gameSpeed = std::chrono::milliseconds(200);
+        scheduler->setPeriod(gameSpeed);
     }
 }
 
@@ -299,16 +431,71 @@ void Game::updateHardcoreSpeed() {
     if (!hardcoreMode) return;
     
     // Increase speed every 3 food items
-    if (snake->getLength() % 3 == 0) {
+    if (sim->snake.getLength() % 3 == 0) {
         gameSpeed = std::max(
             std::chrono::milliseconds(50),
             gameSpeed - std::chrono::milliseconds(10)
         );
+        // Takes effect from the current tick's deadline, no phase jump
+        scheduler->setPeriod(gameSpeed);
+    }
+}
+
+void Game::setFrameReplays(bool enabled) {
+    replaySystem->setMode(enabled ? ReplayMode::FRAMES : ReplayMode::INPUTS);
+}
+
+void Game::setDemoMode(bool enabled) {
+    if (enabled) {
+        autopilot = std::make_unique<Autopilot>();
+    } else {
+        autopilot.reset();
+    }
+}
+
+void Game::setSolverMode(bool enabled) {
+    solverMode = enabled;
+    if (!enabled) solver.reset();
+}
+
+bool Game::setWorldSize(int width, int height) {
+    if (width < MIN_WORLD_SIZE || height < MIN_WORLD_SIZE ||
+        width > MAX_WORLD_SIZE || height > MAX_WORLD_SIZE) {
+        return false;
     }
+    config.width = width;
+    config.height = height;
+    return true;
+}
+
+bool Game::setArenaMode(int snakes) {
+    if (snakes < 0 || snakes > MAX_ARENA_SNAKES) return false;
+    arenaSnakes = snakes;
+    return true;
+}
+
+bool Game::steeredByBot() const {
+    return solver || neuralPilot || (autopilot && searchFits);
+}
+
+bool Game::loadNeuralPilot(const std::string& filename) {
+    NeuralCheckpoint checkpoint;
+    if (!checkpoint.load(filename)) return false;
+    // Saved best first
+    neuralPilot = std::make_unique<NeuralPilot>(checkpoint.networks.front());
+    return true;
 }
 
 void Game::startReplayRecording() {
-    replaySystem->startRecording(playerName);
+    recordingName = "replays/replay_" + std::to_string(std::chrono::system_clock::to_time_t(
+        std::chrono::system_clock::now()));
+    
+    // Frame recordings stream to disk as they go; input logs stay tiny
+    std::string streamPath;
+    if (replaySystem->getMode() == ReplayMode::FRAMES) {
+        streamPath = recordingName + ".partial";
+    }
+    replaySystem->startRecording(playerName, *sim, streamPath);
 }
 
 void Game::stopReplayRecording() {
@@ -316,86 +503,166 @@ void Game::stopReplayRecording() {
         replaySystem->stopRecording();
         
         // Save replay if score is high enough
-        if (score > 100) {
-            std::string filename = "replays/replay_" + 
-                std::to_string(std::chrono::system_clock::to_time_t(
-                    std::chrono::system_clock::now())) + ".replay";
-            replaySystem->saveReplay(filename);
+        if (sim->score > 100) {
+            replaySystem->saveReplay(recordingName + ".replay");
+        } else {
+            replaySystem->discardRecording();
         }
     }
 }
 
 void Game::showReplayMenu() {
-    renderer->clear();
-    renderer->drawString(2, 2, "Replay Menu");
-    
-    // List available replays
-    std::vector<std::string> replays;
-    for (const auto& entry : std::filesystem::directory_iterator("replays")) {
-        if (entry.path().extension() == ".replay") {
-            replays.push_back(entry.path().string());
-        }
-    }
-    
+    // Listed from the library index; no replay file is opened until played
+    ReplayQuery query;
+    query.limit = 200;
+    size_t comboFilter = 0;
     int selected = 0;
+    int top = 0;
+    
     while (true) {
-        renderer->clear();
-        renderer->drawString(2, 2, "Select a replay to watch:");
+        query.minCombo = REPLAY_COMBO_FILTERS[comboFilter];
+        std::vector<const ReplayInfo*> replays = replayLibrary->query(query);
+        int count = static_cast<int>(replays.size());
+        selected = std::min(selected, std::max(count - 1, 0));
+        top = std::max(0, std::min(top, selected));
+        if (selected >= top + REPLAY_MENU_ROWS) top = selected - REPLAY_MENU_ROWS + 1;
         
-        for (size_t i = 0; i < replays.size(); ++i) {
-            std::string prefix = (i == selected) ? "> " : "  ";
-            renderer->drawString(2, 4 + i, prefix + replays[i]);
+        renderer->clear();
+        renderer->drawString(2, 2, "Select a replay to watch (" + std::to_string(replayLibrary->size()) +
+                                   " saved, combo >= " + std::to_string(query.minCombo) + ", by " +
+                                   (query.order == ReplayOrder::SCORE ? "score" : "date") + "):");
+        for (int i = top; i < count && i < top + REPLAY_MENU_ROWS; ++i) {
+            const ReplayInfo& info = *replays[i];
+            char line[96];
+            std::snprintf(line, sizeof(line), "%s %-16.16s %7d  x%-3d %5llds",
+                          i == selected ? ">" : " ", info.playerName.c_str(), info.finalScore,
+                          info.maxCombo, static_cast<long long>(info.durationMs / 1000));
+            renderer->drawString(2, 4 + (i - top), line);
         }
+        renderer->drawString(2, 5 + REPLAY_MENU_ROWS, "C: combo filter  O: order  R: rescan  ESC: back");
+        renderer->refresh();
         
-        char key = _getch();
-        switch (key) {
-            case 'w':
-            case 'W':
-                selected = (selected > 0) ? selected - 1 : replays.size() - 1;
+        InputEvent event = input->wait();
+        switch (event.action) {
+            case InputAction::MOVE_UP:
+                if (count > 0) {
+                    selected = (selected > 0) ? selected - 1 : count - 1;
+                }
                 break;
-            case 's':
-            case 'S':
-                selected = (selected + 1) % replays.size();
+            case InputAction::MOVE_DOWN:
+                if (count > 0) {
+                    selected = (selected + 1) % count;
+                }
                 break;
-            case 13: // Enter
-                if (!replays.empty()) {
-                    playReplay(replays[selected]);
+            case InputAction::CONFIRM:
+                if (count > 0 && !playReplay(replayLibrary->pathOf(*replays[selected]))) {
+                    // Deleted or damaged since it was indexed
+                    replayLibrary->remove(replays[selected]->file);
                 }
                 break;
-            case 27: // ESC
+            case InputAction::BACK:
                 currentState = GameState::START_SCREEN;
                 return;
+            default:
+                switch (event.key) {
+                    case 'c': case 'C':
+                        comboFilter = (comboFilter + 1) % (sizeof(REPLAY_COMBO_FILTERS) / sizeof(int));
+                        break;
+                    case 'o': case 'O':
+                        query.order = (query.order == ReplayOrder::SCORE) ? ReplayOrder::DATE
+                                                                         : ReplayOrder::SCORE;
+                        break;
+                    case 'r': case 'R':
+                        replayLibrary->rebuild();
+                        break;
+                    default:
+                        break;
+                }
+                break;
         }
     }
 }
 
-void Game::playReplay(const std::string& filename) {
-    if (!replaySystem->loadReplay(filename)) {
+bool Game::playReplay(const std::string& filename) {
+    // Frames are decoded on demand, so even a long replay starts at once
+    ReplayReader reader;
+    if (!reader.open(filename)) {
         renderer->drawString(2, 2, "Failed to load replay!");
-        _getch();
-        return;
+        renderer->refresh();
+        input->wait();
+        return false;
     }
+
+    // Drawn on the board it was recorded on, not the current one
+    GameConfig world = renderer->getWorld();
+    if (reader.getConfig()) renderer->setWorld(*reader.getConfig());
+    runReplay(reader);
+    renderer->setWorld(world);
+    return true;
+}
+
+void Game::runReplay(ReplayReader& reader) {
+    bool replayPaused = false;
+    auto frameInterval = REPLAY_FRAME_INTERVAL;
+    auto nextFrame = std::chrono::steady_clock::now() + frameInterval;
+    bool dirty = true;
     
-    const auto& replay = replaySystem->getCurrentReplay();
-    size_t currentState = 0;
-    
-    while (currentState < replay.states.size()) {
-        const auto& state = replay.states[currentState];
+    while (true) {
+        if (dirty) {
+            const ReplayFrame& state = reader.frame();
+            renderer->clear();
+            if (!state.snakeBody.empty()) renderer->followCamera(state.snakeBody.front());
+            renderer->drawSnake(state.snakeBody);
+            renderer->drawFood(state.foodPosition);
+            renderer->drawScore(state.score, highScore);
+            renderer->drawCombo(state.combo);
+            renderer->drawReplayStatus(reader.position(), reader.tickCount(), replayPaused);
+            renderer->refresh();
+            dirty = false;
+        }
         
-        renderer->clear();
-        renderer->drawSnake(state.snakeBody);
-        renderer->drawFood(state.foodPosition);
-        renderer->drawScore(state.score, highScore);
-        renderer->drawCombo(state.combo);
-        renderer->refresh();
+        // While paused A/D step one tick; while playing they jump
+        InputEvent event;
+        while (input->poll(event)) {
+            uint32_t stride = replayPaused ? 1 : REPLAY_SEEK_TICKS;
+            uint32_t position = reader.position();
+            switch (event.action) {
+                case InputAction::BACK:
+                    return;
+                case InputAction::PAUSE:
+                    replayPaused = !replayPaused;
+                    nextFrame = std::chrono::steady_clock::now() + frameInterval;
+                    break;
+                case InputAction::MOVE_LEFT:
+                    reader.seek(position > stride ? position - stride : 0);
+                    break;
+                case InputAction::MOVE_RIGHT:
+                    reader.seek(std::min(position + stride, reader.tickCount() - 1));
+                    break;
+                case InputAction::MOVE_UP:
+                    frameInterval = std::max(REPLAY_MIN_INTERVAL, frameInterval / 2);
+                    break;
+                case InputAction::MOVE_DOWN:
+                    frameInterval = std::min(REPLAY_MAX_INTERVAL, frameInterval * 2);
+                    break;
+                default:
+                    break;
+            }
+            dirty = true;
+        }
         
-        if (_kbhit()) {
-            char key = _getch();
-            if (key == 27) break; // ESC
+        auto now = std::chrono::steady_clock::now();
+        if (!replayPaused && now >= nextFrame) {
+            // Hold the last frame so it can still be scrubbed
+            if (!reader.next()) {
+                replayPaused = true;
+            }
+            nextFrame += frameInterval;
+            if (nextFrame < now) nextFrame = now + frameInterval;
+            dirty = true;
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        currentState++;
+        TickScheduler::sleepUntil(std::min(nextFrame, now + INPUT_POLL_INTERVAL));
     }
 }
 
@@ -403,8 +670,8 @@ void Game::updateAchievements() {
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::steady_clock::now() - gameStartTime);
     
-    achievementSystem->update(score, snake->getCurrentCombo(), 
-                            snake->getLength(), duration);
+    achievementSystem->update(sim->score, sim->snake.getCurrentCombo(), 
+                            sim->snake.getLength(), duration);
 }
 
 void Game::showAchievements() {
@@ -421,7 +688,8 @@ void Game::showAchievements() {
     
     renderer->drawString(2, 4 + achievements.size() + 1, 
                         "Press any key to return to menu");
-    _getch();
+    renderer->refresh();
+    input->wait();
     currentState = GameState::START_SCREEN;
 }
 
@@ -2,53 +2,86 @@
 
 #include <memory>
 #include <chrono>
+#include <deque>
 #include <vector>
 #include <string>
 #include "constants.h"
-#include "snake.h"
-#include "food.h"
+#include "sim.h"
+#include "arena.h"
 #include "renderer.h"
 #include "replay.h"
+#include "replay_reader.h"
+#include "replay_library.h"
+#include "autopilot.h"
+#include "hamiltonian.h"
+#include "neural.h"
 #include "achievements.h"
+#include "input.h"
+#include "tick_scheduler.h"
 
 namespace SnakeGame {
 
-struct Portal {
-    Point position;
-    Point destination;
-    bool active;
-};
-
 class Game {
 public:
     Game();
     void run();
     
+    // Record full frame replays (streamed to disk) instead of input logs
+    void setFrameReplays(bool enabled);
+    // Let the autopilot steer; movement keys are ignored while it does
+    void setDemoMode(bool enabled);
+    // Play perfect games on a Hamiltonian cycle; portals are turned off
+    void setSolverMode(bool enabled);
+    // Let the best network of a snake_train checkpoint steer; false if the
+    // file cannot be loaded
+    bool loadNeuralPilot(const std::string& filename);
+    // World size for the next game, MIN_WORLD_SIZE to MAX_WORLD_SIZE cells
+    // a side; false if out of range
+    bool setWorldSize(int width, int height);
+    // Play an arena of this many snakes: the player plus bots on one board.
+    // 0 goes back to single-snake games; false if out of range.
+    bool setArenaMode(int snakes);
+    
+    // Only meaningful after run() returns
+    InputStats getInputStats() const { return input->getStats(); }
+    TickStats getTickStats() const { return scheduler->getStats(); }
+    
 private:
     GameConfig config;
-    std::unique_ptr<Snake> snake;
-    std::unique_ptr<Food> food;
+    std::unique_ptr<SimState> sim;
     std::unique_ptr<Renderer> renderer;
     std::unique_ptr<ReplaySystem> replaySystem;
+    std::unique_ptr<ReplayLibrary> replayLibrary;
     std::unique_ptr<AchievementSystem> achievementSystem;
+    std::unique_ptr<InputThread> input;
+    std::unique_ptr<TickScheduler> scheduler;
+    std::unique_ptr<Autopilot> autopilot;  // set in demo mode
+    std::unique_ptr<HamiltonianSolver> solver;  // set in solver mode, rebuilt per game
+    bool solverMode;
+    std::unique_ptr<NeuralPilot> neuralPilot;  // set by loadNeuralPilot
+    bool searchFits;  // board small enough for the autopilot and solver
+    int arenaSnakes;  // 0 outside arena mode
+    std::unique_ptr<Arena> arena;  // this game's arena; the player is snake 0
+    std::vector<Direction> arenaInputs;
     
-    int score;
     int highScore;
     bool gameOver;
     bool paused;
     std::chrono::milliseconds gameSpeed;
-    std::chrono::steady_clock::time_point lastUpdate;
     std::chrono::steady_clock::time_point gameStartTime;
+    std::deque<Direction> pendingDirections;  // one turn applied per tick
     
     // New features
-    std::vector<Portal> portals;
     bool hardcoreMode;
     bool minimalMode;
     int portalUseCount;
     
     void initialize();
+    void runGameLoop();
     void handleInput();
+    bool steeredByBot() const;
     void update();
+    void updateArena();
     void render();
     void loadHighScore();
     void saveHighScore();
@@ -56,13 +89,11 @@ private:
     void showConfigScreen();
     void handleConfigInput();
     void resetGame();
-    void checkCollisions();
+    void handleDeath();
     void handleFoodEaten();
     void updateSpeed();
     
     // New methods
-    void initializePortals();
-    void checkPortalCollisions();
     void toggleHardcoreMode();
     void updateHardcoreSpeed();
     void toggleMinimalMode();
@@ -71,7 +102,8 @@ private:
     void startReplayRecording();
     void stopReplayRecording();
     void showReplayMenu();
-    void playReplay(const std::string& filename);
+    bool playReplay(const std::string& filename);
+    void runReplay(ReplayReader& reader);
     
     // Achievement methods
     void updateAchievements();
@@ -80,6 +112,7 @@ private:
     // Game state
     GameState currentState;
     std::string playerName;
+    std::string recordingName;  // path of the current recording, sans extension
 };
 
 } // namespace SnakeGame 
\ No newline at end of file
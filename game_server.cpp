@@ -0,0 +1,761 @@
+#include "game_server.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace SnakeGame {
+
+namespace {
+
+// epoll tags for the fixed descriptors; client events carry slot and
+// generation, which never reach these values
+constexpr uint64_t TCP_TAG = ~uint64_t(0);
+constexpr uint64_t UNIX_TAG = ~uint64_t(0) - 1;
+constexpr uint64_t TIMER_TAG = ~uint64_t(0) - 2;
+constexpr uint64_t WAKE_TAG = ~uint64_t(0) - 3;
+
+constexpr int MAX_EVENTS = 256;
+constexpr size_t READ_CHUNK = 4096;
+// Clients only send tiny frames; more unparsed input than this is abuse
+constexpr size_t MAX_INPUT_BUFFER = 4096;
+// A turn for a tick further ahead than this is refused
+constexpr uint64_t MAX_TURN_LEAD = 64;
+// Queued frames handed to one sendmsg
+constexpr int MAX_IOVECS = 64;
+
+uint64_t clientTag(int slot, uint32_t generation) {
+    return static_cast<uint64_t>(generation) << 32 | static_cast<uint32_t>(slot);
+}
+
+std::string describe(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+// Encodes one frame into a buffer of its own, to be queued for any number
+// of clients
+template <typename Write>
+std::shared_ptr<const std::vector<uint8_t>> makeFrame(NetProtocol::MessageType type, Write write) {
+    auto frame = std::make_shared<std::vector<uint8_t>>();
+    NetProtocol::appendFrame(*frame, type, write);
+    return frame;
+}
+
+// The type byte follows the frame's varint size
+NetProtocol::MessageType frameType(const std::vector<uint8_t>& frame) {
+    size_t at = 0;
+    while (frame[at] & 0x80) at++;
+    return static_cast<NetProtocol::MessageType>(frame[at + 1]);
+}
+
+// Board state a lagging spectator can do without until its next keyframe
+bool isStateFrame(const std::vector<uint8_t>& frame) {
+    NetProtocol::MessageType type = frameType(frame);
+    return type == NetProtocol::SNAPSHOT || type == NetProtocol::DELTA;
+}
+
+} // namespace
+
+GameServer::GameServer(const ServerOptions& options)
+    : options(options)
+    , epollFd(-1)
+    , tcpFd(-1)
+    , unixFd(-1)
+    , timerFd(-1)
+    , wakeFd(-1)
+    , boundPort(-1)
+    , rng(std::random_device{}())
+    , nextRoomId(1)
+    , reportTicks(0)
+    , ticksRun(0)
+    , scheduler(options.tick)
+    , tickMax(0)
+    , gamesStarted(0)
+    , gamesFinished(0)
+    , connections(0)
+    , dropped(0)
+    , keyframeSkips(0)
+    , bytesSent(0)
+    , activeRooms(0)
+    , activeClients(0)
+    , activeSpectators(0) {
+    tickHistogram.fill(0);
+}
+
+GameServer::~GameServer() {
+    for (const Client& client : clients) {
+        if (client.fd >= 0) close(client.fd);
+    }
+    for (int fd : {epollFd, tcpFd, unixFd, timerFd, wakeFd}) {
+        if (fd >= 0) close(fd);
+    }
+    if (unixFd >= 0) unlink(options.unixPath.c_str());
+}
+
+bool GameServer::start() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || timerFd < 0 || wakeFd < 0) {
+        error = describe("epoll setup");
+        return false;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = TIMER_TAG;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+    event.data.u64 = WAKE_TAG;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    if (options.port < 0 && options.unixPath.empty()) {
+        error = "no TCP port or Unix socket to listen on";
+        return false;
+    }
+    if (options.port >= 0 && !openTcp()) return false;
+    if (!options.unixPath.empty() && !openUnix()) return false;
+    return true;
+}
+
+bool GameServer::openTcp() {
+    tcpFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (tcpFd < 0) {
+        error = describe("socket");
+        return false;
+    }
+    int on = 1;
+    setsockopt(tcpFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(options.port));
+    if (inet_pton(AF_INET, options.address.c_str(), &address.sin_addr) != 1) {
+        error = "bad address " + options.address;
+        return false;
+    }
+    if (bind(tcpFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(tcpFd, SOMAXCONN) != 0) {
+        error = describe(("TCP " + options.address + ":" + std::to_string(options.port)).c_str());
+        return false;
+    }
+    socklen_t length = sizeof(address);
+    getsockname(tcpFd, reinterpret_cast<sockaddr*>(&address), &length);
+    boundPort = ntohs(address.sin_port);
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = TCP_TAG;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, tcpFd, &event);
+    return true;
+}
+
+bool GameServer::openUnix() {
+    sockaddr_un address{};
+    if (options.unixPath.size() >= sizeof(address.sun_path)) {
+        error = "Unix socket path too long";
+        return false;
+    }
+    unixFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (unixFd < 0) {
+        error = describe("socket");
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, options.unixPath.c_str(), options.unixPath.size() + 1);
+    // A socket file left by an earlier run would make bind fail
+    unlink(options.unixPath.c_str());
+    if (bind(unixFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(unixFd, SOMAXCONN) != 0) {
+        error = describe(options.unixPath.c_str());
+        return false;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = UNIX_TAG;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, unixFd, &event);
+    return true;
+}
+
+void GameServer::stop() {
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void GameServer::run() {
+    scheduler.start();
+    armTimer();
+
+    epoll_event events[MAX_EVENTS];
+    while (true) {
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        for (int i = 0; i < count; ++i) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == WAKE_TAG) {
+                uint64_t value;
+                ssize_t ignored = read(wakeFd, &value, sizeof(value));
+                (void)ignored;
+                return;
+            }
+            if (tag == TIMER_TAG) {
+                uint64_t expirations;
+                ssize_t ignored = read(timerFd, &expirations, sizeof(expirations));
+                (void)ignored;
+                onTick();
+                continue;
+            }
+            if (tag == TCP_TAG || tag == UNIX_TAG) {
+                accept(tag == TCP_TAG ? tcpFd : unixFd);
+                continue;
+            }
+
+            // Skip events for a slot closed and reused earlier in this batch
+            int slot = static_cast<int>(tag & 0xFFFFFFFFu);
+            if (slot >= static_cast<int>(clients.size()) || clients[slot].fd < 0 ||
+                clients[slot].generation != static_cast<uint32_t>(tag >> 32)) {
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                drop(slot);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) flush(slot);
+            if (clients[slot].fd >= 0 && (events[i].events & EPOLLIN)) onReadable(slot);
+        }
+    }
+}
+
+void GameServer::armTimer() {
+    auto since = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        scheduler.nextDeadline().time_since_epoch());
+    itimerspec spec{};
+    spec.it_value.tv_sec = static_cast<time_t>(since.count() / 1000000000);
+    spec.it_value.tv_nsec = static_cast<long>(since.count() % 1000000000);
+    timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void GameServer::accept(int listenFd) {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;  // EAGAIN, or out of descriptors until someone leaves
+        if (listenFd == tcpFd) {
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+        if (options.socketBuffer > 0) {
+            // Thousands of spectators at the default size add up to a lot of kernel memory
+            setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &options.socketBuffer, sizeof(options.socketBuffer));
+        }
+
+        int slot;
+        if (!freeClients.empty()) {
+            slot = freeClients.back();
+            freeClients.pop_back();
+        } else {
+            slot = static_cast<int>(clients.size());
+            clients.emplace_back();
+        }
+        Client& client = clients[slot];
+        uint32_t generation = client.generation + 1;
+        client = Client();
+        client.fd = fd;
+        client.generation = generation;
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = clientTag(slot, generation);
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            client.fd = -1;
+            freeClients.push_back(slot);
+            continue;
+        }
+        connections++;
+        activeClients++;
+    }
+}
+
+void GameServer::onReadable(int slot) {
+    Client& client = clients[slot];
+    uint8_t buffer[READ_CHUNK];
+    while (true) {
+        ssize_t got = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (got > 0) {
+            client.in.insert(client.in.end(), buffer, buffer + got);
+            if (client.in.size() > MAX_INPUT_BUFFER) {
+                dropped++;
+                drop(slot);
+                return;
+            }
+            continue;
+        }
+        if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            drop(slot);
+            return;
+        }
+        if (errno == EINTR) continue;
+        break;
+    }
+
+    size_t used = 0;
+    NetProtocol::Frame frame;
+    while (true) {
+        long taken = NetProtocol::readFrame(client.in.data() + used, client.in.size() - used, frame);
+        if (taken == 0) break;
+        if (taken < 0 || !handleFrame(slot, frame)) {
+            dropped++;
+            drop(slot);
+            return;
+        }
+        used += static_cast<size_t>(taken);
+    }
+    client.in.erase(client.in.begin(), client.in.begin() + used);
+    matchWaiting();
+}
+
+bool GameServer::handleFrame(int slot, const NetProtocol::Frame& frame) {
+    Client& client = clients[slot];
+    ByteReader in(frame.payload, frame.size);
+    switch (frame.type) {
+        case NetProtocol::JOIN:
+            if (in.u8() != NetProtocol::PROTOCOL_VERSION) return false;
+            if (client.room < 0 && !client.queued && !client.spectator) {
+                client.queued = true;
+                waiting.push_back(clientTag(slot, client.generation));
+            }
+            return in.ok();
+        case NetProtocol::TURN: {
+            uint64_t tick = in.varint();
+            uint8_t direction = in.u8();
+            if (!in.ok() || direction > static_cast<uint8_t>(Direction::RIGHT)) return false;
+            // Turns outside a game, beyond the queue or too far ahead are ignored
+            if (client.room < 0 || client.spectator || client.turnCount == MAX_PENDING_TURNS) return true;
+            if (tick > rooms[client.room]->arena.getTick() + MAX_TURN_LEAD) return true;
+            client.turns[client.turnCount++] = {tick, static_cast<Direction>(direction)};
+            return true;
+        }
+        case NetProtocol::WATCH: {
+            if (in.u8() != NetProtocol::PROTOCOL_VERSION) return false;
+            uint32_t id = static_cast<uint32_t>(in.varint());
+            if (!in.ok()) return false;
+            // Players stay players; a spectator asking again is ignored
+            if (client.room >= 0 || client.queued || client.spectator) return true;
+            client.spectator = true;
+            activeSpectators++;
+            for (int i = 0; i < static_cast<int>(rooms.size()); ++i) {
+                if (rooms[i] && (id == 0 || rooms[i]->id == id)) {
+                    watch(slot, i);
+                    return true;
+                }
+            }
+            // Not running (any more): watch whatever opens next
+            idleSpectators.push_back(clientTag(slot, client.generation));
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void GameServer::onTick() {
+    auto began = TickScheduler::Clock::now();
+    int due = scheduler.ticksDue(began);
+    for (int t = 0; t < due; ++t) {
+        for (int i = 0; i < static_cast<int>(rooms.size()); ++i) {
+            if (rooms[i]) stepRoom(i);
+        }
+    }
+    matchWaiting();
+    for (int slot : flushList) {
+        clients[slot].dirty = false;
+        if (clients[slot].fd >= 0 && !clients[slot].waitingForWrite) flush(slot);
+    }
+    flushList.clear();
+    armTimer();
+
+    if (due > 0) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(TickScheduler::Clock::now() - began);
+        tickMax = std::max(tickMax, us);
+        tickHistogram[std::min(static_cast<size_t>(us.count() / HISTOGRAM_BUCKET_US), HISTOGRAM_BUCKETS)]++;
+    }
+    ticksRun += static_cast<uint64_t>(due);
+    if (reporter && reportTicks > 0 && due > 0 && ticksRun / reportTicks != (ticksRun - due) / reportTicks) {
+        reporter(getStats());
+    }
+}
+
+void GameServer::stepRoom(int index) {
+    Room& room = *rooms[index];
+    uint64_t tick = room.arena.getTick() + 1;
+
+    // A player who left forfeits
+    if (room.players[0] < 0 || room.players[1] < 0) {
+        closeRoom(index, room.players[0] >= 0 ? 0 : room.players[1] >= 0 ? 1 : NetProtocol::NO_WINNER);
+        return;
+    }
+
+    for (int seat = 0; seat < 2; ++seat) {
+        Client& client = clients[room.players[seat]];
+        room.inputs[seat] = Direction::NONE;
+        if (client.turnCount > 0 && client.turns[0].tick <= tick) {
+            room.inputs[seat] = client.turns[0].direction;
+            std::copy(client.turns + 1, client.turns + client.turnCount, client.turns);
+            client.turnCount--;
+        }
+    }
+    room.arena.step(room.inputs);
+
+    auto delta = std::make_shared<std::vector<uint8_t>>();
+    room.encoder.writeDelta(room.arena, *delta);
+    SharedFrame frame = std::move(delta);
+    for (int player : room.players) send(player, frame);
+
+    // Same frame to every spectator in step; the rest wait for a keyframe
+    size_t lagging = 0;
+    for (size_t i = 0; i < room.spectators.size(); ++i) {
+        int spectator = room.spectators[i];
+        if (clients[spectator].needsKeyframe) {
+            lagging++;
+        } else {
+            send(spectator, frame);
+        }
+    }
+    if (lagging > 0 && (room.keyframeNow ||
+                        (options.keyframeTicks > 0 && room.arena.getTick() % options.keyframeTicks == 0))) {
+        auto snapshot = std::make_shared<std::vector<uint8_t>>();
+        room.encoder.writeSnapshot(room.arena, *snapshot);
+        frame = std::move(snapshot);
+        for (size_t i = 0; i < room.spectators.size(); ++i) {
+            Client& client = clients[room.spectators[i]];
+            if (!client.needsKeyframe) continue;
+            client.needsKeyframe = false;
+            send(room.spectators[i], frame);
+        }
+        room.keyframeNow = false;
+    }
+
+    const ArenaSnake& first = room.arena.getSnake(0);
+    const ArenaSnake& second = room.arena.getSnake(1);
+    bool timeUp = options.maxTicks > 0 && room.arena.getTick() >= options.maxTicks;
+    if (first.alive && second.alive && !timeUp) return;
+
+    uint8_t winner = NetProtocol::NO_WINNER;
+    if (first.alive != second.alive) {
+        winner = first.alive ? 0 : 1;
+    } else if (first.score != second.score) {
+        winner = first.score > second.score ? 0 : 1;
+    }
+    closeRoom(index, winner);
+}
+
+void GameServer::matchWaiting() {
+    int pending = -1;
+    for (uint64_t tag : waiting) {
+        int slot = static_cast<int>(tag & 0xFFFFFFFFu);
+        const Client& client = clients[slot];
+        if (client.fd < 0 || !client.queued || client.generation != static_cast<uint32_t>(tag >> 32)) continue;
+        if (pending < 0) {
+            pending = slot;
+            continue;
+        }
+        openRoom(pending, slot);
+        pending = -1;
+    }
+    waiting.clear();
+    if (pending >= 0) waiting.push_back(clientTag(pending, clients[pending].generation));
+}
+
+void GameServer::openRoom(int first, int second) {
+    int index;
+    if (!freeRooms.empty()) {
+        index = freeRooms.back();
+        freeRooms.pop_back();
+    } else {
+        index = static_cast<int>(rooms.size());
+        rooms.emplace_back();
+    }
+    rooms[index] = std::make_unique<Room>(options.config, rng());
+    Room& room = *rooms[index];
+    room.id = nextRoomId++;
+    room.players[0] = first;
+    room.players[1] = second;
+    room.arena.setHuman(0, true);
+    room.arena.setHuman(1, true);
+    gamesStarted++;
+    activeRooms++;
+
+    auto snapshot = std::make_shared<std::vector<uint8_t>>();
+    room.encoder.writeSnapshot(room.arena, *snapshot);
+    SharedFrame frame = std::move(snapshot);
+    for (int seat = 0; seat < 2; ++seat) {
+        Client& client = clients[room.players[seat]];
+        client.queued = false;
+        client.room = index;
+        client.seat = seat;
+        client.turnCount = 0;
+
+        send(room.players[seat], makeFrame(NetProtocol::WELCOME, [&](ByteWriter& w) {
+            w.varint(room.id);
+            w.u8(static_cast<uint8_t>(seat));
+            w.u8(2);
+            writeGameConfig(w, options.config);
+        }));
+        send(room.players[seat], frame);
+    }
+
+    for (uint64_t tag : idleSpectators) {
+        int slot = static_cast<int>(tag & 0xFFFFFFFFu);
+        const Client& client = clients[slot];
+        if (client.fd < 0 || client.generation != static_cast<uint32_t>(tag >> 32)) continue;
+        watch(slot, index);
+    }
+    idleSpectators.clear();
+}
+
+void GameServer::closeRoom(int index, uint8_t winner) {
+    Room& room = *rooms[index];
+    SharedFrame frame = makeFrame(NetProtocol::GAME_OVER, [&](ByteWriter& w) {
+        w.varint(room.arena.getTick());
+        w.u8(winner);
+        for (int i = 0; i < room.arena.getSnakeCount(); ++i) w.varint(room.arena.getSnake(i).score);
+    });
+    for (int player : room.players) {
+        if (player < 0) continue;
+        send(player, frame);
+        // Straight back in line for the next game
+        Client& client = clients[player];
+        client.room = -1;
+        client.turnCount = 0;
+        if (client.fd >= 0) {
+            client.queued = true;
+            waiting.push_back(clientTag(player, client.generation));
+        }
+    }
+    // A spectator waiting for a keyframe gets the final board first, or its
+    // view would hold stale scores up against GAME_OVER's
+    SharedFrame finalBoard;
+    for (int spectator : room.spectators) {
+        Client& client = clients[spectator];
+        if (client.needsKeyframe) {
+            if (!finalBoard) {
+                auto snapshot = std::make_shared<std::vector<uint8_t>>();
+                room.encoder.writeSnapshot(room.arena, *snapshot);
+                finalBoard = std::move(snapshot);
+            }
+            client.needsKeyframe = false;
+            send(spectator, finalBoard);
+        }
+        send(spectator, frame);
+        client.room = -1;
+        if (client.fd >= 0) idleSpectators.push_back(clientTag(spectator, client.generation));
+    }
+    rooms[index].reset();
+    freeRooms.push_back(index);
+    gamesFinished++;
+    activeRooms--;
+}
+
+void GameServer::watch(int slot, int index) {
+    Room& room = *rooms[index];
+    Client& client = clients[slot];
+    client.room = index;
+    client.seat = static_cast<int>(room.spectators.size());
+    client.needsKeyframe = true;
+    room.spectators.push_back(slot);
+    room.keyframeNow = true;
+    send(slot, makeFrame(NetProtocol::WELCOME, [&](ByteWriter& w) {
+        w.varint(room.id);
+        w.u8(NetProtocol::SPECTATOR);
+        w.u8(2);
+        writeGameConfig(w, options.config);
+    }));
+}
+
+void GameServer::leaveRoom(int slot) {
+    Client& client = clients[slot];
+    if (client.room < 0) return;
+    Room& room = *rooms[client.room];
+    if (!client.spectator) {
+        // The room forfeits it on its next tick
+        room.players[client.seat] = -1;
+    } else {
+        int last = room.spectators.back();
+        room.spectators[client.seat] = last;
+        clients[last].seat = client.seat;
+        room.spectators.pop_back();
+    }
+    client.room = -1;
+}
+
+void GameServer::send(int slot, const SharedFrame& frame) {
+    if (slot < 0) return;
+    Client& client = clients[slot];
+    if (client.fd < 0) return;
+    if (client.pending + frame->size() > options.maxSendBuffer && !client.spectator) {
+        dropped++;
+        drop(slot);
+        return;
+    }
+    // Only past the limit already, so a keyframe bigger than it still goes
+    // out. GAME_OVER is queued regardless: a skip has left the spectator
+    // waiting for a keyframe, so closeRoom sends the final board ahead of it.
+    NetProtocol::MessageType type = frameType(*frame);
+    if (client.pending > options.maxSpectatorBuffer && client.spectator && type != NetProtocol::GAME_OVER) {
+        skipToKeyframe(slot);
+        if (type == NetProtocol::DELTA) return;
+        // A snapshot is the keyframe the spectator now waits for
+        if (type == NetProtocol::SNAPSHOT) client.needsKeyframe = false;
+    }
+    client.out.push_back(frame);
+    client.pending += frame->size();
+    if (!client.dirty) {
+        client.dirty = true;
+        flushList.push_back(slot);
+    }
+}
+
+void GameServer::skipToKeyframe(int slot) {
+    Client& client = clients[slot];
+    // Games that finished while it was not reading go whole, GAME_OVER and
+    // all; a WELCOME after them resets the view anyway. Of the game still on,
+    // only its WELCOME is kept. So whatever the spectator missed, at most one
+    // frame is left besides one partly sent, which has to be finished or the
+    // stream loses its framing.
+    size_t first = client.sent > 0 ? 1 : 0;
+    size_t from = first;
+    for (size_t i = first; i < client.out.size(); ++i) {
+        if (frameType(*client.out[i]) == NetProtocol::GAME_OVER) from = i + 1;
+    }
+    size_t kept = first;
+    client.pending = first ? client.out.front()->size() - client.sent : 0;
+    for (size_t i = from; i < client.out.size(); ++i) {
+        if (isStateFrame(*client.out[i])) continue;
+        client.pending += client.out[i]->size();
+        if (kept != i) client.out[kept] = std::move(client.out[i]);
+        kept++;
+    }
+    client.out.erase(client.out.begin() + static_cast<long>(kept), client.out.end());
+    client.needsKeyframe = true;
+    keyframeSkips++;
+}
+
+void GameServer::flush(int slot) {
+    Client& client = clients[slot];
+    iovec parts[MAX_IOVECS];
+    while (!client.out.empty()) {
+        int count = 0;
+        size_t skip = client.sent;
+        for (auto it = client.out.begin(); it != client.out.end() && count < MAX_IOVECS; ++it) {
+            parts[count].iov_base = const_cast<uint8_t*>((*it)->data()) + skip;
+            parts[count].iov_len = (*it)->size() - skip;
+            skip = 0;
+            count++;
+        }
+        msghdr message{};
+        message.msg_iov = parts;
+        message.msg_iovlen = static_cast<size_t>(count);
+        ssize_t put = sendmsg(client.fd, &message, MSG_NOSIGNAL);
+        if (put < 0 && errno == EINTR) continue;
+        if (put < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (put <= 0) {
+            drop(slot);
+            return;
+        }
+
+        bytesSent += static_cast<uint64_t>(put);
+        client.pending -= static_cast<size_t>(put);
+        size_t left = static_cast<size_t>(put);
+        while (left > 0) {
+            size_t rest = client.out.front()->size() - client.sent;
+            if (left < rest) {
+                client.sent += left;
+                break;
+            }
+            left -= rest;
+            client.out.pop_front();
+            client.sent = 0;
+        }
+    }
+
+    bool pending = !client.out.empty();
+    if (pending != client.waitingForWrite) {
+        // Only ask for EPOLLOUT while the kernel is full
+        epoll_event event{};
+        event.events = static_cast<uint32_t>(EPOLLIN) | (pending ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        event.data.u64 = clientTag(slot, client.generation);
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
+        client.waitingForWrite = pending;
+    }
+}
+
+void GameServer::drop(int slot) {
+    Client& client = clients[slot];
+    if (client.fd < 0) return;
+    close(client.fd);  // also leaves the epoll set
+    client.fd = -1;
+    client.in.clear();
+    client.in.shrink_to_fit();
+    client.out.clear();
+    client.out.shrink_to_fit();
+    client.sent = 0;
+    client.pending = 0;
+    client.queued = false;
+    leaveRoom(slot);
+    if (client.spectator) activeSpectators--;
+    freeClients.push_back(slot);
+    activeClients--;
+}
+
+void GameServer::setReporter(uint64_t ticks, std::function<void(const ServerStats&)> report) {
+    reportTicks = ticks;
+    reporter = std::move(report);
+}
+
+ServerStats GameServer::getStats() const {
+    ServerStats stats;
+    TickStats schedule = scheduler.getStats();
+    stats.ticks = schedule.ticks;
+    stats.skippedTicks = schedule.skippedTicks;
+    stats.gamesStarted = gamesStarted;
+    stats.gamesFinished = gamesFinished;
+    stats.connections = connections;
+    stats.dropped = dropped;
+    stats.keyframeSkips = keyframeSkips;
+    stats.bytesSent = bytesSent;
+    stats.clients = activeClients;
+    stats.spectators = activeSpectators;
+    stats.rooms = activeRooms;
+    stats.tickP50 = percentile(0.50);
+    stats.tickP99 = percentile(0.99);
+    stats.tickMax = tickMax;
+    stats.schedule = schedule;
+    return stats;
+}
+
+std::chrono::microseconds GameServer::percentile(double fraction) const {
+    uint64_t total = 0;
+    for (uint32_t count : tickHistogram) total += count;
+    if (total == 0) return std::chrono::microseconds(0);
+    uint64_t rank = static_cast<uint64_t>(fraction * (total - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i <= HISTOGRAM_BUCKETS; ++i) {
+        seen += tickHistogram[i];
+        if (seen > rank) return std::chrono::microseconds(i * HISTOGRAM_BUCKET_US);
+    }
+    return tickMax;
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "arena.h"
+#include "constants.h"
+#include "net_protocol.h"
+#include "tick_scheduler.h"
+
+namespace SnakeGame {
+
+struct ServerOptions {
+    GameConfig config = GameConfig::defaultConfig();
+    std::string address = "127.0.0.1";
+    int port = -1;                  // TCP port; -1 for none, 0 for any free one
+    std::string unixPath;           // Unix socket path; empty for none
+    std::chrono::milliseconds tick = std::chrono::milliseconds(100);
+    uint64_t maxTicks = 3000;       // a game still running after this is scored; 0 for no limit
+    size_t maxSendBuffer = 256 * 1024;  // a player this far behind is dropped
+    size_t maxSpectatorBuffer = 64 * 1024;  // a spectator this far behind skips to a keyframe
+    uint64_t keyframeTicks = 50;    // how often a room with lagging spectators sends a SNAPSHOT
+    int socketBuffer = 0;           // SO_SNDBUF for clients; 0 for the kernel's default
+};
+
+struct ServerStats {
+    uint64_t ticks;
+    uint64_t skippedTicks;
+    uint64_t gamesStarted;
+    uint64_t gamesFinished;
+    uint64_t connections;
+    uint64_t dropped;       // cut off for falling behind or sending garbage
+    uint64_t keyframeSkips; // spectator backlogs discarded
+    uint64_t bytesSent;
+    size_t clients;
+    size_t spectators;
+    size_t rooms;
+    // Time from the tick timer firing to every room stepped and its frames
+    // handed to the kernel
+    std::chrono::microseconds tickP50;
+    std::chrono::microseconds tickP99;
+    std::chrono::microseconds tickMax;
+    TickStats schedule;     // how late ticks started
+};
+
+// Authoritative server for 1v1 games, one thread, Linux only.
+//
+// Everything runs on one epoll loop: the listening sockets (TCP and/or
+// Unix), a timerfd armed at the scheduler's next deadline, an eventfd for
+// stop(), and every client socket, all non-blocking. Clients that send
+// JOIN are paired off in arrival order; each pair gets a room holding an
+// Arena with two human snakes and one food, on the configured board. The
+// first death ends a game: the survivor wins, and dying together or
+// reaching maxTicks is scored on points. Both players then go back in the
+// queue.
+//
+// On each tick every room applies its players' queued turns, steps, and
+// encodes one DELTA frame. The frame is encoded once into a shared buffer,
+// and every player and spectator of the room queues a reference to it.
+// Queues are flushed once all rooms have stepped, with one sendmsg over
+// the queued frames per client; whatever the kernel does not take waits
+// for EPOLLOUT. A player whose backlog passes maxSendBuffer is
+// disconnected. A spectator already past maxSpectatorBuffer loses its
+// backlog but for the current room's WELCOME: board frames, and whole
+// games that ended meanwhile. It then waits for the room's next SNAPSHOT,
+// sent every keyframeTicks while anyone waits (on the next tick for a new
+// spectator, and ahead of GAME_OVER so the final scores check out). Either
+// way one stalled reader costs memory up to a bound and never delays the
+// tick.
+class GameServer {
+public:
+    explicit GameServer(const ServerOptions& options);
+    ~GameServer();
+
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    // Opens the sockets; false with getError() set if any cannot be opened
+    bool start();
+    // Serves until stop(); call after start()
+    void run();
+    // Safe from any thread and from signal handlers
+    void stop();
+
+    const std::string& getError() const { return error; }
+    // The bound TCP port, once started
+    int getPort() const { return boundPort; }
+    // Only consistent while run() is not running
+    ServerStats getStats() const;
+    // Called from the loop with fresh stats every `ticks` ticks
+    void setReporter(uint64_t ticks, std::function<void(const ServerStats&)> report);
+
+private:
+    static constexpr int MAX_PENDING_TURNS = 3;
+    static constexpr size_t HISTOGRAM_BUCKETS = 10000;  // 10 us each, plus overflow
+    static constexpr int HISTOGRAM_BUCKET_US = 10;
+
+    struct Turn {
+        uint64_t tick;
+        Direction direction;
+    };
+
+    // An encoded frame, shared by every client it is queued for
+    using SharedFrame = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Client {
+        int fd = -1;
+        uint32_t generation = 0;
+        std::vector<uint8_t> in;
+        std::deque<SharedFrame> out;
+        size_t sent = 0;               // bytes of out.front() already sent
+        size_t pending = 0;            // bytes queued in out, less sent
+        bool waitingForWrite = false;  // EPOLLOUT registered
+        bool dirty = false;            // in the flush list
+        bool queued = false;           // waiting for an opponent
+        bool spectator = false;
+        bool needsKeyframe = false;    // spectator skipping deltas until a SNAPSHOT
+        int room = -1;
+        int seat = 0;                  // a spectator's index in the room's list
+        Turn turns[MAX_PENDING_TURNS];
+        int turnCount = 0;
+    };
+
+    struct Room {
+        Room(const GameConfig& config, uint32_t seed) : arena(config, 2, 1, seed) {}
+
+        Arena arena;
+        ArenaDeltaEncoder encoder;
+        uint32_t id = 0;
+        int players[2] = {-1, -1};
+        Direction inputs[2] = {Direction::NONE, Direction::NONE};
+        std::vector<int> spectators;
+        bool keyframeNow = false;  // a spectator joined since the last SNAPSHOT
+    };
+
+    ServerOptions options;
+    std::string error;
+    int epollFd;
+    int tcpFd;
+    int unixFd;
+    int timerFd;
+    int wakeFd;
+    int boundPort;
+
+    std::vector<Client> clients;
+    std::vector<int> freeClients;
+    std::vector<std::unique_ptr<Room>> rooms;
+    std::vector<int> freeRooms;
+    std::vector<uint64_t> waiting;  // slot and generation, oldest first; stale entries skipped
+    std::vector<uint64_t> idleSpectators;  // the same, for the next room that opens
+    std::vector<int> flushList;
+    std::mt19937 rng;
+    uint32_t nextRoomId;
+
+    uint64_t reportTicks;
+    uint64_t ticksRun;
+    std::function<void(const ServerStats&)> reporter;
+
+    TickScheduler scheduler;
+    std::array<uint32_t, HISTOGRAM_BUCKETS + 1> tickHistogram;
+    std::chrono::microseconds tickMax;
+    uint64_t gamesStarted;
+    uint64_t gamesFinished;
+    uint64_t connections;
+    uint64_t dropped;
+    uint64_t keyframeSkips;
+    uint64_t bytesSent;
+    size_t activeRooms;
+    size_t activeClients;
+    size_t activeSpectators;
+
+    bool openTcp();
+    bool openUnix();
+    void armTimer();
+    void accept(int listenFd);
+    void onReadable(int slot);
+    bool handleFrame(int slot, const NetProtocol::Frame& frame);
+    void onTick();
+    void stepRoom(int index);
+    void matchWaiting();
+    void openRoom(int first, int second);
+    void closeRoom(int index, uint8_t winner);
+    void watch(int slot, int index);
+    void leaveRoom(int slot);
+    void send(int slot, const SharedFrame& frame);
+    void skipToKeyframe(int slot);
+    void flush(int slot);
+    void drop(int slot);
+    std::chrono::microseconds percentile(double fraction) const;
+};
+
+} // namespace SnakeGame
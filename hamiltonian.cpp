@@ -0,0 +1,103 @@
+#include "hamiltonian.h"
+#include <algorithm>
+
+namespace SnakeGame {
+
+namespace {
+
+constexpr Direction MOVES[] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+
+// Free cycle cells a shortcut must leave in front of the tail, on top of
+// one per body segment
+constexpr uint32_t SHORTCUT_GAP = 3;
+
+} // namespace
+
+HamiltonianSolver::HamiltonianSolver(const GameConfig& config)
+    : width(config.width), height(config.height), cycleLength(0) {
+    int columns = width - 2;
+    int rows = height - 2;
+    if (rows % 2 != 0) rows++;  // borrow the bottom border row
+    if (columns < 6 || rows < 2) return;
+
+    order.assign(static_cast<size_t>(width) * height, OFF_CYCLE);
+    // The starting snake from SimState: head mid-board, body trailing left
+    Point head(width / 2, height / 2);
+    Point neck(head.x - 1, head.y);
+    Point tail(head.x - 2, head.y);
+    for (int variant = 0; variant < 4; ++variant) {
+        build(1, 1, columns, rows, (variant & 1) != 0, (variant & 2) != 0);
+        uint32_t t = orderOf(tail);
+        if (orderOf(neck) == (t + 1) % cycleLength && orderOf(head) == (t + 2) % cycleLength) {
+            return;
+        }
+    }
+    cycleLength = 0;
+    order.clear();
+}
+
+void HamiltonianSolver::build(int left, int top, int columns, int rows, bool mirrorX, bool mirrorY) {
+    uint32_t next = 0;
+    auto visit = [&](int i, int j) {
+        int x = left + (mirrorX ? columns - 1 - i : i);
+        int y = top + (mirrorY ? rows - 1 - j : j);
+        order[static_cast<size_t>(y) * width + x] = next++;
+    };
+    for (int i = 0; i < columns; ++i) {
+        visit(i, 0);
+    }
+    for (int j = 1; j < rows; ++j) {
+        if (j % 2 != 0) {
+            for (int i = columns - 1; i >= 1; --i) visit(i, j);
+        } else {
+            for (int i = 1; i < columns; ++i) visit(i, j);
+        }
+    }
+    for (int j = rows - 1; j >= 1; --j) {
+        visit(0, j);
+    }
+    cycleLength = next;
+}
+
+uint32_t HamiltonianSolver::orderOf(const Point& p) const {
+    if (p.x < 0 || p.x >= width || p.y < 0 || p.y >= height || order.empty()) return OFF_CYCLE;
+    return order[static_cast<size_t>(p.y) * width + p.x];
+}
+
+Direction HamiltonianSolver::decide(const SimState& state) {
+    const Snake& snake = state.snake;
+    if (!isValid() || snake.isTeleporting()) return Direction::NONE;
+    stats.moves++;
+
+    Point head = snake.getHead();
+    uint32_t at = orderOf(head);
+    uint32_t tail = orderOf(snake.getBody().back());
+    if (at == OFF_CYCLE || tail == OFF_CYCLE) return Direction::NONE;
+
+    // Cycle cells strictly between head and tail are free; anything up to
+    // the food may be skipped
+    uint32_t gap = ahead(at, tail);
+    uint32_t food = state.food.isPlaced() ? orderOf(state.food.getPosition()) : OFF_CYCLE;
+    uint32_t length = static_cast<uint32_t>(snake.getLength());
+    uint32_t reserve = length + SHORTCUT_GAP;
+    uint32_t limit = 1;
+    if (food != OFF_CYCLE && gap > reserve) {
+        limit = std::min(ahead(at, food), gap - reserve);
+    }
+
+    Direction best = Direction::NONE;
+    uint32_t bestSkip = 0;
+    for (Direction dir : MOVES) {
+        uint32_t to = orderOf(head + DirectionManager::getDirectionVector(dir));
+        if (to == OFF_CYCLE || to == at) continue;
+        uint32_t skip = ahead(at, to);
+        if (skip > bestSkip && (skip == 1 || skip <= limit)) {
+            best = dir;
+            bestSkip = skip;
+        }
+    }
+    if (bestSkip > 1) stats.shortcuts++;
+    return best;
+}
+
+} // namespace SnakeGame
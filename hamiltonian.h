@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "sim.h"
+
+namespace SnakeGame {
+
+struct HamiltonianStats {
+    uint64_t moves = 0;
+    uint64_t shortcuts = 0;  // moves that skipped ahead along the cycle
+};
+
+// "Perfect snake" solver: follows a Hamiltonian cycle through the board's
+// interior, so it can never trap itself, and skips ahead along the cycle
+// toward the food while that is provably safe.
+//
+// The cycle is the usual serpentine: row 0 left to right, then back and
+// forth over the remaining rows in columns 1 and up, and home up column 0.
+// That needs an even number of rows, so when the interior has an odd
+// count the bottom border row joins the cycle (the snake may use it, food
+// never spawns there). The pattern is mirrored as needed so the starting
+// snake already lies along the cycle head-first.
+//
+// The body always occupies cells in cycle order between tail and head, so
+// every cell on the cycle from the head up to the tail is free. A shortcut
+// to a neighbour further along is taken only if it does not pass the food
+// and still leaves the snake's length plus SHORTCUT_GAP free cells in
+// front of the tail. Skipped cells stay empty behind the head until the
+// tail passes them, and every apple eaten meanwhile stalls the tail for a
+// tick, so the slack has to outlast a run of apples; that also stops
+// shortcuts once the snake is half the board.
+//
+// Expects a SimState without portals; a teleport would break the order.
+class HamiltonianSolver {
+public:
+    // Builds the cycle for the config's board in one pass over its cells
+    explicit HamiltonianSolver(const GameConfig& config);
+
+    // False when the board is too small for a cycle the starting snake
+    // fits on (under 8x4)
+    bool isValid() const { return cycleLength != 0; }
+    uint32_t getCycleLength() const { return cycleLength; }
+    // Position of a cell along the cycle, or OFF_CYCLE
+    uint32_t orderOf(const Point& p) const;
+
+    Direction decide(const SimState& state);
+
+    const HamiltonianStats& getStats() const { return stats; }
+
+    static constexpr uint32_t OFF_CYCLE = 0xFFFFFFFFu;
+
+private:
+    int width;
+    int height;
+    uint32_t cycleLength;
+    std::vector<uint32_t> order;  // per board cell
+    HamiltonianStats stats;
+
+    uint32_t ahead(uint32_t from, uint32_t to) const {
+        return to >= from ? to - from : to + cycleLength - from;
+    }
+    void build(int left, int top, int columns, int rows, bool mirrorX, bool mirrorY);
+};
+
+} // namespace SnakeGame
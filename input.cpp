@@ -0,0 +1,182 @@
+#include "input.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <conio.h>
+#else
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace SnakeGame {
+
+namespace {
+
+#ifndef _WIN32
+struct termios savedTermios;
+bool termiosSaved = false;
+
+// How long to wait for the rest of an escape sequence after a lone ESC
+constexpr int ESCAPE_TIMEOUT_MS = 25;
+// How often the reader wakes up to check for shutdown
+constexpr int READ_POLL_MS = 50;
+
+void enterRawMode() {
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &savedTermios) != 0) return;
+    termiosSaved = true;
+
+    struct termios raw = savedTermios;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+}
+
+void leaveRawMode() {
+    if (termiosSaved) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedTermios);
+        termiosSaved = false;
+    }
+}
+
+bool waitReadable(int timeoutMs) {
+    struct pollfd pfd{STDIN_FILENO, POLLIN, 0};
+    return ::poll(&pfd, 1, timeoutMs) > 0 && (pfd.revents & POLLIN);
+}
+#endif
+
+} // namespace
+
+InputThread::InputThread()
+    : running(true)
+    , received(0)
+    , dropped(0)
+    , consumed(0)
+    , totalLatency(0)
+    , maxLatency(0) {
+#ifndef _WIN32
+    enterRawMode();
+#endif
+    reader = std::thread(&InputThread::readLoop, this);
+}
+
+InputThread::~InputThread() {
+    running = false;
+    if (reader.joinable()) reader.join();
+#ifndef _WIN32
+    leaveRawMode();
+#endif
+}
+
+bool InputThread::poll(InputEvent& event) {
+    if (!queue.tryPop(event)) return false;
+
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - event.timestamp);
+    consumed++;
+    totalLatency += latency;
+    maxLatency = std::max(maxLatency, latency);
+    return true;
+}
+
+InputEvent InputThread::wait() {
+    InputEvent event;
+    while (!poll(event)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return event;
+}
+
+InputStats InputThread::getStats() const {
+    return {received.load(), dropped.load(), consumed, totalLatency, maxLatency};
+}
+
+InputAction InputThread::actionForKey(char key) {
+    switch (key) {
+        case 'w': case 'W': return InputAction::MOVE_UP;
+        case 's': case 'S': return InputAction::MOVE_DOWN;
+        case 'a': case 'A': return InputAction::MOVE_LEFT;
+        case 'd': case 'D': return InputAction::MOVE_RIGHT;
+        case 'p': case 'P': return InputAction::PAUSE;
+        case 27:            return InputAction::BACK;
+        case 13: case 10:   return InputAction::CONFIRM;
+        default:            return InputAction::NONE;
+    }
+}
+
+void InputThread::publish(InputAction action, char key) {
+    received++;
+    if (!queue.tryPush({action, key, std::chrono::steady_clock::now()})) {
+        dropped++;
+    }
+}
+
+#ifdef _WIN32
+
+void InputThread::readLoop() {
+    while (running) {
+        if (!_kbhit()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        int key = _getch();
+        if (key == 0 || key == 224) {
+            // Extended key: arrows arrive as a prefix plus a scan code
+            switch (_getch()) {
+                case 72: publish(InputAction::MOVE_UP, 0); break;
+                case 80: publish(InputAction::MOVE_DOWN, 0); break;
+                case 75: publish(InputAction::MOVE_LEFT, 0); break;
+                case 77: publish(InputAction::MOVE_RIGHT, 0); break;
+            }
+            continue;
+        }
+        publish(actionForKey(static_cast<char>(key)), static_cast<char>(key));
+    }
+}
+
+#else
+
+void InputThread::readLoop() {
+    char buffer[64];
+    while (running) {
+        if (!waitReadable(READ_POLL_MS)) continue;
+
+        ssize_t count = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (count <= 0) continue;
+
+        for (ssize_t i = 0; i < count; ++i) {
+            char key = buffer[i];
+            if (key != 27) {
+                publish(actionForKey(key), key);
+                continue;
+            }
+
+            // ESC: either a lone key or the start of "ESC [ A".."ESC [ D".
+            // Top up the buffer if the sequence was split across reads.
+            if (i + 2 >= count && waitReadable(ESCAPE_TIMEOUT_MS)) {
+                ssize_t kept = count - i;
+                std::copy(buffer + i, buffer + count, buffer);
+                ssize_t more = read(STDIN_FILENO, buffer + kept, sizeof(buffer) - kept);
+                count = kept + (more > 0 ? more : 0);
+                i = 0;
+            }
+            if (i + 2 < count && (buffer[i + 1] == '[' || buffer[i + 1] == 'O')) {
+                switch (buffer[i + 2]) {
+                    case 'A': publish(InputAction::MOVE_UP, 0); break;
+                    case 'B': publish(InputAction::MOVE_DOWN, 0); break;
+                    case 'C': publish(InputAction::MOVE_RIGHT, 0); break;
+                    case 'D': publish(InputAction::MOVE_LEFT, 0); break;
+                    default: break;
+                }
+                i += 2;
+                continue;
+            }
+            publish(InputAction::BACK, key);
+        }
+    }
+}
+
+#endif
+
+} // namespace SnakeGame
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include "constants.h"
+#include "spsc_queue.h"
+
+namespace SnakeGame {
+
+struct InputEvent {
+    InputAction action;
+    char key;  // raw key for menus; 0 for escape sequences
+    std::chrono::steady_clock::time_point timestamp;
+};
+
+struct InputStats {
+    uint64_t received;
+    uint64_t dropped;            // queue was full when the key arrived
+    uint64_t consumed;
+    std::chrono::microseconds totalLatency;
+    std::chrono::microseconds maxLatency;
+};
+
+// Reads the keyboard on a dedicated thread (raw termios mode on POSIX) and
+// hands timestamped events to the game loop through a lock-free queue.
+// The game thread is the only consumer.
+class InputThread {
+public:
+    InputThread();
+    ~InputThread();
+
+    InputThread(const InputThread&) = delete;
+    InputThread& operator=(const InputThread&) = delete;
+
+    // Non-blocking; also records the key-to-consume latency
+    bool poll(InputEvent& event);
+    // Blocks until a key arrives, for menus
+    InputEvent wait();
+
+    InputStats getStats() const;
+
+    // Map a raw key to an action (WASD, P, ESC, Enter)
+    static InputAction actionForKey(char key);
+
+private:
+    static constexpr size_t QUEUE_CAPACITY = 256;
+
+    SpscQueue<InputEvent, QUEUE_CAPACITY> queue;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> received;
+    std::atomic<uint64_t> dropped;
+    uint64_t consumed;
+    std::chrono::microseconds totalLatency;
+    std::chrono::microseconds maxLatency;
+    std::thread reader;
+
+    void readLoop();
+    void publish(InputAction action, char key);
+};
+
+} // namespace SnakeGame
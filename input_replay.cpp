@@ -0,0 +1,145 @@
+#include "input_replay.h"
+#include <algorithm>
+
+namespace SnakeGame {
+
+namespace {
+
+constexpr uint8_t DIRECTION_COUNT = static_cast<uint8_t>(Direction::NONE);
+// Playing a log back steps every tick of it, so a game may go on without a
+// turn or speed change for this long (about 14 hours at 50 ms) and no more
+constexpr uint64_t MAX_TICKS_PAST_LAST_EVENT = uint64_t(1) << 20;
+
+} // namespace
+
+void InputLog::begin(const SimState& initial) {
+    seed = initial.seed;
+    config = initial.config;
+    portals = !initial.portals.empty();
+    initialPeriodMs = static_cast<uint32_t>(initial.tickDuration.count());
+    inputs.clear();
+    speeds.clear();
+    totalTicks = 0;
+}
+
+void InputLog::record(uint64_t tick, Direction input, std::chrono::milliseconds period) {
+    uint32_t t = static_cast<uint32_t>(tick);
+    uint32_t periodMs = static_cast<uint32_t>(period.count());
+    uint32_t current = speeds.empty() ? initialPeriodMs : speeds.back().periodMs;
+    if (periodMs != current) {
+        speeds.push_back({t, periodMs});
+    }
+    if (input != Direction::NONE) {
+        inputs.push_back({t, input});
+    }
+    totalTicks = t + 1;
+}
+
+void InputLog::write(ByteWriter& out) const {
+    out.u32(seed);
+    writeGameConfig(out, config);
+    out.u8(portals);
+    out.u32(initialPeriodMs);
+
+    out.u32(totalTicks);
+    out.u32(static_cast<uint32_t>(inputs.size()));
+    for (const auto& input : inputs) {
+        out.u32(input.tick);
+        out.u8(static_cast<uint8_t>(input.direction));
+    }
+    out.u32(static_cast<uint32_t>(speeds.size()));
+    for (const auto& speed : speeds) {
+        out.u32(speed.tick);
+        out.u32(speed.periodMs);
+    }
+}
+
+bool InputLog::read(ByteReader& in) {
+    seed = in.u32();
+    readGameConfig(in, config);
+    portals = in.u8() != 0;
+    initialPeriodMs = in.u32();
+
+    totalTicks = in.u32();
+    if (totalTicks > MAX_LOG_TICKS) return false;
+    uint32_t inputCount = in.u32();
+    if (!in.ok() || inputCount > in.remaining() / 5) return false;
+    if (config.width < 3 || config.height < 3 || config.width > MAX_WORLD_SIZE || config.height > MAX_WORLD_SIZE) {
+        return false;
+    }
+    // Events are recorded in tick order, each before its tick was counted
+    uint32_t lastEvent = 0;
+    inputs.resize(inputCount);
+    for (auto& input : inputs) {
+        input.tick = in.u32();
+        uint8_t direction = in.u8();
+        if (direction >= DIRECTION_COUNT || input.tick < lastEvent || input.tick >= totalTicks) return false;
+        input.direction = static_cast<Direction>(direction);
+        lastEvent = input.tick;
+    }
+    uint32_t speedCount = in.u32();
+    if (!in.ok() || speedCount > in.remaining() / 8) return false;
+    speeds.resize(speedCount);
+    uint32_t lastSpeed = 0;
+    for (auto& speed : speeds) {
+        speed.tick = in.u32();
+        speed.periodMs = in.u32();
+        if (speed.tick < lastSpeed || speed.tick >= totalTicks) return false;
+        lastSpeed = speed.tick;
+    }
+    lastEvent = std::max(lastEvent, lastSpeed);
+    return in.ok() && totalTicks <= lastEvent + MAX_TICKS_PAST_LAST_EVENT;
+}
+
+InputLogPlayer::InputLogPlayer(const InputLog& log)
+    : log(log)
+    , sim(log.config, log.seed, log.portals)
+    , nextInput(0)
+    , nextSpeed(0) {
+    sim.tickDuration = std::chrono::milliseconds(log.initialPeriodMs);
+}
+
+InputLogPlayer::InputLogPlayer(const InputLog& log, const SimState& resumeFrom)
+    : log(log)
+    , sim(resumeFrom)
+    , nextInput(0)
+    , nextSpeed(0) {
+    // Skip entries the saved state already consumed; it carries its own
+    // tick length, so only later speed changes matter
+    uint64_t tick = sim.tick;
+    auto input = std::lower_bound(log.inputs.begin(), log.inputs.end(), tick,
+        [](const TickInput& entry, uint64_t t) { return entry.tick < t; });
+    nextInput = static_cast<size_t>(input - log.inputs.begin());
+    auto speed = std::lower_bound(log.speeds.begin(), log.speeds.end(), tick,
+        [](const TickSpeed& entry, uint64_t t) { return entry.tick < t; });
+    nextSpeed = static_cast<size_t>(speed - log.speeds.begin());
+}
+
+StepEvents InputLogPlayer::advance() {
+    uint64_t tick = sim.tick;
+    while (nextSpeed < log.speeds.size() && log.speeds[nextSpeed].tick <= tick) {
+        sim.tickDuration = std::chrono::milliseconds(log.speeds[nextSpeed].periodMs);
+        ++nextSpeed;
+    }
+    Direction input = Direction::NONE;
+    while (nextInput < log.inputs.size() && log.inputs[nextInput].tick <= tick) {
+        input = log.inputs[nextInput].direction;
+        ++nextInput;
+    }
+    return step(sim, input);
+}
+
+InputLogCheck verifyInputLog(const InputLog& log, int expectedScore, uint64_t stepBudget) {
+    InputLogPlayer player(log);
+    while (!player.done()) {
+        if (player.state().tick >= stepBudget) {
+            return {false, player.state().score, player.state().tick, true};
+        }
+        player.advance();
+    }
+    const SimState& end = player.state();
+    bool complete = end.tick == log.totalTicks;
+    return {complete && end.score == expectedScore, end.score, end.tick, false};
+}
+
+} // namespace SnakeGame
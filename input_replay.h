@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "constants.h"
+#include "direction.h"
+#include "sim.h"
+#include "replay_format.h"
+
+namespace SnakeGame {
+
+// A turn fed to step() on the given tick (0 = the first step)
+struct TickInput {
+    uint32_t tick;
+    Direction direction;
+};
+
+// The simulated tick length from the given tick on (hardcore speed-ups)
+struct TickSpeed {
+    uint32_t tick;
+    uint32_t periodMs;
+};
+
+// Longest game a log may describe: about 39 days of play at 50 ms a tick,
+// and seconds to re-simulate. Files claiming more are rejected on read.
+constexpr uint32_t MAX_LOG_TICKS = uint32_t(1) << 26;
+
+// Everything needed to re-run a game: the rules are deterministic given
+// the seed, the config and the inputs, so no frame is ever stored.
+struct InputLog {
+    uint32_t seed = 0;
+    GameConfig config = GameConfig::defaultConfig();
+    bool portals = true;
+    uint32_t initialPeriodMs = 0;
+    std::vector<TickInput> inputs;
+    std::vector<TickSpeed> speeds;
+    uint32_t totalTicks = 0;
+
+    void begin(const SimState& initial);
+    // Called once per step with the input about to be applied; only
+    // turns and period changes are stored
+    void record(uint64_t tick, Direction input, std::chrono::milliseconds period);
+
+    void write(ByteWriter& out) const;
+    bool read(ByteReader& in);
+};
+
+// Re-simulates an InputLog one tick at a time
+class InputLogPlayer {
+public:
+    explicit InputLogPlayer(const InputLog& log);
+    // Continue from a state saved earlier while playing the same log
+    InputLogPlayer(const InputLog& log, const SimState& resumeFrom);
+
+    bool done() const { return sim.tick >= log.totalTicks || sim.gameOver; }
+    StepEvents advance();
+    const SimState& state() const { return sim; }
+
+private:
+    const InputLog& log;
+    SimState sim;
+    size_t nextInput;
+    size_t nextSpeed;
+};
+
+struct InputLogCheck {
+    bool matches;
+    int score;
+    uint64_t ticks;
+    bool outOfSteps;  // gave up at the step budget
+};
+
+// Runs the log to the end and compares the outcome with what was recorded.
+// A log longer than stepBudget ticks fails without being run further.
+InputLogCheck verifyInputLog(const InputLog& log, int expectedScore, uint64_t stepBudget = MAX_LOG_TICKS);
+
+} // namespace SnakeGame
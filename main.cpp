@@ -1,7 +1,13 @@
 #include "game.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
-int main() {
+int main(int argc, char** argv) {
+#ifdef _WIN32
     // Hide cursor
     HANDLE consoleHandle = GetStdHandle(STD_OUTPUT_HANDLE);
     CONSOLE_CURSOR_INFO info;
@@ -12,10 +18,69 @@ int main() {
     // Set console size
     SMALL_RECT windowSize = {0, 0, 80, 40};
     SetConsoleWindowInfo(consoleHandle, TRUE, &windowSize);
+#endif
+    
+    bool showStats = false;
+    bool frameReplays = false;
+    bool demo = false;
+    bool solver = false;
+    const char* network = nullptr;
+    int width = 0;
+    int height = 0;
+    int arenaSnakes = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--stats") == 0) showStats = true;
+        if (std::strcmp(argv[i], "--frame-replays") == 0) frameReplays = true;
+        if (std::strcmp(argv[i], "--demo") == 0) demo = true;
+        if (std::strcmp(argv[i], "--solver") == 0) solver = true;
+        if (std::strcmp(argv[i], "--neural") == 0 && i + 1 < argc) network = argv[++i];
+        if (std::strcmp(argv[i], "--arena") == 0 && i + 1 < argc) arenaSnakes = std::atoi(argv[++i]);
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc &&
+            std::sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+            width = -1;
+        }
+    }
     
     // Create and run game
-    SnakeGame::Game game;
-    game.run();
+    SnakeGame::InputStats stats;
+    SnakeGame::TickStats tickStats;
+    {
+        SnakeGame::Game game;
+        game.setFrameReplays(frameReplays);
+        game.setDemoMode(demo);
+        game.setSolverMode(solver);
+        if (width != 0 && !game.setWorldSize(width, height)) {
+            std::fprintf(stderr, "snake_game: world size must be %d to %d cells a side\n",
+                         SnakeGame::MIN_WORLD_SIZE, SnakeGame::MAX_WORLD_SIZE);
+            return 1;
+        }
+        if (!game.setArenaMode(arenaSnakes)) {
+            std::fprintf(stderr, "snake_game: arena takes at most %d snakes\n", SnakeGame::MAX_ARENA_SNAKES);
+            return 1;
+        }
+        if (network && !game.loadNeuralPilot(network)) {
+            std::fprintf(stderr, "snake_game: cannot load network %s\n", network);
+            return 1;
+        }
+        game.run();
+        stats = game.getInputStats();
+        tickStats = game.getTickStats();
+    }
+    
+    if (showStats) {
+        double avgUs = stats.consumed > 0
+            ? static_cast<double>(stats.totalLatency.count()) / stats.consumed : 0.0;
+        std::printf("input: %llu keys, %llu dropped, latency avg %.1f us, max %lld us\n",
+                    static_cast<unsigned long long>(stats.received),
+                    static_cast<unsigned long long>(stats.dropped),
+                    avgUs, static_cast<long long>(stats.maxLatency.count()));
+        std::printf("ticks: %llu run, %llu skipped, jitter p50 %lld us, p99 %lld us, max %lld us\n",
+                    static_cast<unsigned long long>(tickStats.ticks),
+                    static_cast<unsigned long long>(tickStats.skippedTicks),
+                    static_cast<long long>(tickStats.jitterP50.count()),
+                    static_cast<long long>(tickStats.jitterP99.count()),
+                    static_cast<long long>(tickStats.jitterMax.count()));
+    }
     
     return 0;
-} 
\ No newline at end of file
+}
@@ -0,0 +1,115 @@
+#include "mapped_file.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SnakeGame {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : bytes(nullptr), length(0), fileHandle(nullptr), mappingHandle(nullptr) {}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    bytes = static_cast<const uint8_t*>(view);
+    length = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) UnmapViewOfFile(bytes);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    bytes = nullptr;
+    length = 0;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+}
+
+void MappedFile::adviseSequential() const {}
+
+void MappedFile::release(size_t, size_t) const {}
+
+#else
+
+MappedFile::MappedFile() : bytes(nullptr), length(0) {}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps the file alive
+    if (view == MAP_FAILED) return false;
+
+    bytes = static_cast<const uint8_t*>(view);
+    length = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) munmap(const_cast<uint8_t*>(bytes), length);
+    bytes = nullptr;
+    length = 0;
+}
+
+void MappedFile::adviseSequential() const {
+    if (bytes) madvise(const_cast<uint8_t*>(bytes), length, MADV_SEQUENTIAL);
+}
+
+void MappedFile::release(size_t offset, size_t size) const {
+    if (!bytes || offset >= length) return;
+
+    // madvise works on whole pages; only drop pages fully inside the range
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t first = (offset + page - 1) / page * page;
+    size_t last = std::min(offset + size, length) / page * page;
+    if (last > first) {
+        madvise(const_cast<uint8_t*>(bytes) + first, last - first, MADV_DONTNEED);
+    }
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace SnakeGame {
+
+// Read-only view of a whole file. Pages are faulted in on first touch, so
+// opening is constant time whatever the file size.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool isOpen() const { return bytes != nullptr; }
+
+    // Hints that a range was read sequentially / is no longer needed, so
+    // its pages can be dropped from the resident set
+    void adviseSequential() const;
+    void release(size_t offset, size_t size) const;
+
+private:
+    const uint8_t* bytes;
+    size_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
+
+} // namespace SnakeGame
@@ -0,0 +1,211 @@
+#include "net_protocol.h"
+
+namespace SnakeGame {
+
+namespace {
+
+uint32_t packFood(const Point& p) {
+    return p.x < 0 ? ReplayFormat::NO_FOOD : SnakeBody::pack(p);
+}
+
+Point unpackFood(uint32_t cell) {
+    return cell == ReplayFormat::NO_FOOD ? Point(-1, -1) : SnakeBody::unpack(cell);
+}
+
+void writeBody(ByteWriter& out, const SnakeBody& body) {
+    out.varint(body.size());
+    for (size_t i = 0; i < body.size(); ++i) out.u32(body.packedAt(i));
+}
+
+} // namespace
+
+namespace NetProtocol {
+
+long readFrame(const uint8_t* data, size_t size, Frame& frame) {
+    size_t payload = 0;
+    size_t used = 0;
+    for (int shift = 0;; shift += 7) {
+        if (used == size) return 0;
+        if (shift > 28) return -1;
+        uint8_t byte = data[used++];
+        payload |= static_cast<size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) break;
+    }
+    if (payload > MAX_FRAME_SIZE) return -1;
+    if (size - used < payload + 1) return 0;
+    frame.type = static_cast<MessageType>(data[used]);
+    frame.payload = data + used + 1;
+    frame.size = payload;
+    return static_cast<long>(used + 1 + payload);
+}
+
+} // namespace NetProtocol
+
+void ArenaDeltaEncoder::writeSnapshot(const Arena& arena, std::vector<uint8_t>& out) {
+    NetProtocol::appendFrame(out, NetProtocol::SNAPSHOT, [&](ByteWriter& w) {
+        w.varint(arena.getTick());
+        w.u8(static_cast<uint8_t>(arena.getSnakeCount()));
+        for (int i = 0; i < arena.getSnakeCount(); ++i) {
+            const ArenaSnake& snake = arena.getSnake(i);
+            w.u8(snake.alive);
+            w.u8(static_cast<uint8_t>(snake.heading));
+            w.varint(snake.score);
+            writeBody(w, snake.body);
+        }
+        w.varint(arena.getFood().size());
+        for (const Point& p : arena.getFood()) w.u32(packFood(p));
+    });
+    remember(arena);
+}
+
+void ArenaDeltaEncoder::writeDelta(const Arena& arena, std::vector<uint8_t>& out) {
+    using namespace NetProtocol;
+    appendFrame(out, DELTA, [&](ByteWriter& w) {
+        w.varint(arena.getTick());
+        for (int i = 0; i < arena.getSnakeCount(); ++i) {
+            const ArenaSnake& snake = arena.getSnake(i);
+            const Seen& last = seen[i];
+            uint8_t flags = 0;
+            if (snake.deaths != last.deaths) {
+                flags |= DIED;
+            }
+            if (snake.alive && (!last.alive || snake.deaths != last.deaths)) {
+                // Came back (it moves on the tick it respawns): send it whole
+                flags |= SPAWNED;
+            } else if (snake.alive && SnakeBody::pack(snake.body.front()) != last.head) {
+                // Every move pops the tail; eating puts one segment back
+                flags |= MOVED | TAIL_POPPED | static_cast<uint8_t>(snake.heading);
+                if (snake.body.size() > last.length) flags |= GREW;
+            }
+            if (snake.score != last.score) flags |= SCORE;
+
+            w.u8(flags);
+            if (flags & SPAWNED) {
+                w.u8(static_cast<uint8_t>(snake.heading));
+                writeBody(w, snake.body);
+            }
+            if (flags & SCORE) w.varint(snake.score);
+        }
+
+        const std::vector<Point>& now = arena.getFood();
+        size_t changed = 0;
+        for (size_t i = 0; i < now.size(); ++i) changed += now[i] != food[i];
+        w.varint(changed);
+        for (size_t i = 0; i < now.size() && changed > 0; ++i) {
+            if (now[i] == food[i]) continue;
+            w.varint(i);
+            w.u32(packFood(now[i]));
+            changed--;
+        }
+    });
+    remember(arena);
+}
+
+void ArenaDeltaEncoder::remember(const Arena& arena) {
+    seen.resize(arena.getSnakeCount());
+    for (int i = 0; i < arena.getSnakeCount(); ++i) {
+        const ArenaSnake& snake = arena.getSnake(i);
+        seen[i] = {snake.alive, snake.deaths, snake.alive ? SnakeBody::pack(snake.body.front()) : 0,
+                   snake.body.size(), snake.score};
+    }
+    food = arena.getFood();
+}
+
+bool ArenaView::apply(const NetProtocol::Frame& frame) {
+    ByteReader in(frame.payload, frame.size);
+    switch (frame.type) {
+        case NetProtocol::WELCOME: {
+            room = static_cast<uint32_t>(in.varint());
+            seat = in.u8();
+            size_t count = in.u8();
+            if (!readGameConfig(in, config)) return false;
+            snakes.assign(count, ViewSnake());
+            food.clear();
+            started = true;
+            synced = false;
+            over = false;
+            winner = NetProtocol::NO_WINNER;
+            tick = 0;
+            return seat < static_cast<int>(count) || seat == NetProtocol::SPECTATOR;
+        }
+        case NetProtocol::SNAPSHOT:
+            synced = started && readSnapshot(in);
+            return synced;
+        case NetProtocol::DELTA:
+            return synced && !over && readDelta(in);
+        case NetProtocol::GAME_OVER:
+            if (!started) return false;
+            tick = in.varint();
+            winner = in.u8();
+            over = true;
+            // Final scores double as a check that no delta was misread
+            for (ViewSnake& snake : snakes) {
+                if (static_cast<int>(in.varint()) != snake.score && synced) return false;
+            }
+            return in.ok();
+        default:
+            return false;
+    }
+}
+
+bool ArenaView::readSnapshot(ByteReader& in) {
+    tick = in.varint();
+    if (in.u8() != snakes.size()) return false;
+    for (ViewSnake& snake : snakes) {
+        snake.alive = in.u8() != 0;
+        snake.heading = static_cast<Direction>(in.u8() & 3);
+        snake.score = static_cast<int>(in.varint());
+        if (!readBody(in, snake)) return false;
+    }
+    size_t count = in.varint();
+    if (!in.ok() || count > in.remaining() / 4) return false;
+    food.resize(count);
+    for (Point& p : food) p = unpackFood(in.u32());
+    return in.ok();
+}
+
+bool ArenaView::readDelta(ByteReader& in) {
+    using namespace NetProtocol;
+    uint64_t next = in.varint();
+    if (next != tick + 1) return false;
+    tick = next;
+    for (ViewSnake& snake : snakes) {
+        uint8_t flags = in.u8();
+        if (flags & DIED) {
+            snake.alive = false;
+            snake.body.clear();
+        }
+        if (flags & SPAWNED) {
+            snake.heading = static_cast<Direction>(in.u8() & 3);
+            if (!readBody(in, snake)) return false;
+            snake.alive = true;
+        } else if (flags & MOVED) {
+            if (snake.body.empty()) return false;
+            snake.heading = static_cast<Direction>(flags & DIRECTION_MASK);
+            Point head = snake.body.front() + DirectionManager::getDirectionVector(snake.heading);
+            if (config.wrapAround) head = head.wrap(config.width, config.height);
+            snake.body.pushFront(head);
+            if (flags & TAIL_POPPED) snake.body.popBack();
+            if (flags & GREW) snake.body.pushBack(snake.body.back());
+        }
+        if (flags & SCORE) snake.score = static_cast<int>(in.varint());
+    }
+    size_t changes = in.varint();
+    for (size_t i = 0; i < changes && in.ok(); ++i) {
+        size_t index = in.varint();
+        uint32_t cell = in.u32();
+        if (index >= food.size()) return false;
+        food[index] = unpackFood(cell);
+    }
+    return in.ok();
+}
+
+bool ArenaView::readBody(ByteReader& in, ViewSnake& snake) {
+    size_t length = in.varint();
+    if (!in.ok() || length > in.remaining() / 4) return false;
+    snake.body.clear();
+    for (size_t i = 0; i < length; ++i) snake.body.pushBack(SnakeBody::unpack(in.u32()));
+    return in.ok();
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "arena.h"
+#include "constants.h"
+#include "direction.h"
+#include "point.h"
+#include "replay_format.h"
+#include "snake_body.h"
+
+namespace SnakeGame {
+
+// Wire format shared by snake_server and its clients (integers
+// little-endian, varints LEB128 as in replay_format.h).
+//
+// A stream is a sequence of frames: varint payload size, u8 type, payload.
+//
+// Client to server:
+//   JOIN      u8 PROTOCOL_VERSION; asks for a seat in the next 1v1 room
+//   TURN      varint tick, u8 direction; steer from that tick on (0: as
+//             soon as possible)
+//   WATCH     u8 PROTOCOL_VERSION, varint room (0: any); spectate
+//
+// Server to client:
+//   WELCOME   varint room, u8 seat (SPECTATOR for a spectator), u8 snakes,
+//             config (writeGameConfig)
+//   SNAPSHOT  varint tick, u8 snakes, per snake: u8 alive, u8 heading,
+//             varint score, varint length, u32 packed cell per segment
+//             head first; varint food count, u32 packed cell per food
+//             (ReplayFormat::NO_FOOD while unplaced)
+//   DELTA     varint tick, per snake: u8 DeltaFlags and the fields they
+//             call for; varint food changes, per change: varint index,
+//             u32 packed cell
+//   GAME_OVER varint tick, u8 winning seat (NO_WINNER for a draw), per
+//             snake: varint final score (matching the last DELTA)
+//
+// A room opens with WELCOME and SNAPSHOT, then sends one DELTA per tick:
+// a byte per snake in the common case, since a head can only move one
+// step along its heading.
+//
+// A spectator gets WELCOME, then nothing until the room's next SNAPSHOT,
+// which is sent at the following tick. Every SNAPSHOT is a keyframe: a
+// spectator that falls behind has its queued frames discarded and picks
+// up again at the next one. When a game ends its spectators get GAME_OVER
+// and are moved to the next room that opens, with a new WELCOME.
+namespace NetProtocol {
+
+constexpr uint8_t PROTOCOL_VERSION = 1;
+constexpr uint8_t NO_WINNER = 0xFF;
+constexpr uint8_t SPECTATOR = 0xFF;
+// Bigger frames are a broken or hostile peer
+constexpr size_t MAX_FRAME_SIZE = size_t(1) << 24;
+
+enum MessageType : uint8_t {
+    JOIN = 1,
+    TURN = 2,
+    WATCH = 3,
+
+    WELCOME = 16,
+    SNAPSHOT = 17,
+    DELTA = 18,
+    GAME_OVER = 19
+};
+
+// Per-snake delta flags. The low two bits are the direction the head
+// stepped (Direction's order), valid with MOVED.
+enum DeltaFlags : uint8_t {
+    DIRECTION_MASK = 0x03,
+    MOVED          = 0x04,  // new head one step from the old one, wrapping
+    TAIL_POPPED    = 0x08,  // tail segment removed
+    GREW           = 0x10,  // tail segment duplicated (ate)
+    DIED           = 0x20,  // body left the board
+    SPAWNED        = 0x40,  // u8 heading, varint length, u32 packed cells follow
+    SCORE          = 0x80   // varint new score follows
+};
+
+// Appends a frame: size, type, then whatever write() adds
+template <typename Write>
+void appendFrame(std::vector<uint8_t>& out, MessageType type, Write write) {
+    // Payloads go after a worst-case size field and are moved down once known
+    constexpr size_t SIZE_FIELD = 4;
+    size_t start = out.size();
+    out.resize(start + SIZE_FIELD);
+    out.push_back(type);
+    ByteWriter writer(out);
+    write(writer);
+    size_t payload = out.size() - start - SIZE_FIELD - 1;
+
+    size_t used = 0;
+    do {
+        out[start + used++] = static_cast<uint8_t>(payload >= 0x80 ? (payload | 0x80) : payload);
+        payload >>= 7;
+    } while (payload != 0);
+    out.erase(out.begin() + start + used, out.begin() + start + SIZE_FIELD);
+}
+
+// One frame parsed off the front of a buffer
+struct Frame {
+    MessageType type;
+    const uint8_t* payload;
+    size_t size;
+};
+
+// Bytes taken by the frame at the front of data, 0 if it is not all there
+// yet, or -1 if the stream is malformed
+long readFrame(const uint8_t* data, size_t size, Frame& frame);
+
+} // namespace NetProtocol
+
+// Server side: turns an Arena's progress into SNAPSHOT and DELTA frames by
+// comparing it with what the last frame described.
+class ArenaDeltaEncoder {
+public:
+    void writeSnapshot(const Arena& arena, std::vector<uint8_t>& out);
+    void writeDelta(const Arena& arena, std::vector<uint8_t>& out);
+
+private:
+    struct Seen {
+        bool alive;
+        uint32_t deaths;
+        uint32_t head;
+        size_t length;
+        int score;
+    };
+    std::vector<Seen> seen;
+    std::vector<Point> food;
+
+    void remember(const Arena& arena);
+};
+
+// Client side: the room as rebuilt from the frames received so far
+class ArenaView {
+public:
+    struct ViewSnake {
+        SnakeBody body;
+        Direction heading = Direction::RIGHT;
+        bool alive = false;
+        int score = 0;
+    };
+
+    // Applies one server frame; false if it is malformed, out of order, or
+    // a GAME_OVER whose scores disagree with the view
+    bool apply(const NetProtocol::Frame& frame);
+
+    bool isStarted() const { return started; }
+    // Has had a SNAPSHOT since WELCOME; spectators wait for one
+    bool isSynced() const { return synced; }
+    bool isOver() const { return over; }
+    uint32_t getRoom() const { return room; }
+    int getSeat() const { return seat; }
+    uint8_t getWinner() const { return winner; }
+    uint64_t getTick() const { return tick; }
+    const GameConfig& getConfig() const { return config; }
+    const std::vector<ViewSnake>& getSnakes() const { return snakes; }
+    const std::vector<Point>& getFood() const { return food; }
+
+private:
+    GameConfig config = GameConfig::defaultConfig();
+    uint32_t room = 0;
+    int seat = 0;
+    bool started = false;
+    bool synced = false;
+    bool over = false;
+    uint8_t winner = NetProtocol::NO_WINNER;
+    uint64_t tick = 0;
+    std::vector<ViewSnake> snakes;
+    std::vector<Point> food;
+
+    bool readSnapshot(ByteReader& in);
+    bool readDelta(ByteReader& in);
+    bool readBody(ByteReader& in, ViewSnake& snake);
+};
+
+} // namespace SnakeGame
@@ -0,0 +1,327 @@
+#include "neural.h"
+#include "replay_format.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SNAKE_NEURAL_AVX2 1
+#endif
+
+namespace SnakeGame {
+
+namespace {
+
+constexpr char MAGIC[] = "SNAKE_NET_v1";
+constexpr int LANES = NeuralBatch::LANES;
+constexpr int HIDDEN_WEIGHTS = NeuralNet::HIDDEN * (NeuralNet::INPUTS + 1);
+
+// Unit steps per heading, indexed by Direction
+constexpr int STEP_X[] = {0, 0, -1, 1};
+constexpr int STEP_Y[] = {-1, 1, 0, 0};
+// Turning left and right, indexed by Direction
+constexpr Direction LEFT_OF[] = {Direction::LEFT, Direction::RIGHT, Direction::DOWN, Direction::UP};
+constexpr Direction RIGHT_OF[] = {Direction::RIGHT, Direction::LEFT, Direction::UP, Direction::DOWN};
+
+inline float relu(float x) {
+    return x > 0.0f ? x : 0.0f;
+}
+
+// Both layers for LANES networks at once. The batch keeps its weights
+// input-major, (input * units + unit) * LANES + lane, so every unit of a
+// layer accumulates side by side: sixteen independent sums per input
+// instead of one long dependency chain. Each sum still starts from the
+// bias and adds the inputs in order, as NeuralNet::forward does.
+__attribute__((always_inline)) inline void forwardLanes(const float* __restrict w,
+                                                        const float* __restrict in,
+                                                        float* __restrict out) {
+    constexpr int H = NeuralNet::HIDDEN;
+    constexpr int O = NeuralNet::OUTPUTS;
+    float hidden[H * LANES];
+    const float* bias = w + NeuralNet::INPUTS * H * LANES;
+    for (int j = 0; j < H * LANES; ++j) hidden[j] = bias[j];
+    for (int i = 0; i < NeuralNet::INPUTS; ++i) {
+        const float* row = w + i * H * LANES;
+        const float* x = in + i * LANES;
+        for (int h = 0; h < H; ++h) {
+            for (int l = 0; l < LANES; ++l) hidden[h * LANES + l] += row[h * LANES + l] * x[l];
+        }
+    }
+    for (int j = 0; j < H * LANES; ++j) hidden[j] = relu(hidden[j]);
+
+    const float* second = w + HIDDEN_WEIGHTS * LANES;
+    const float* outBias = second + H * O * LANES;
+    for (int j = 0; j < O * LANES; ++j) out[j] = outBias[j];
+    for (int h = 0; h < H; ++h) {
+        const float* row = second + h * O * LANES;
+        for (int o = 0; o < O; ++o) {
+            for (int l = 0; l < LANES; ++l) out[o * LANES + l] += row[o * LANES + l] * hidden[h * LANES + l];
+        }
+    }
+}
+
+void forwardBaseline(const float* w, const float* in, float* out) {
+    forwardLanes(w, in, out);
+}
+
+#ifdef SNAKE_NEURAL_AVX2
+// AVX2 without FMA: a fused multiply-add rounds once instead of twice and
+// would make the kernels disagree
+__attribute__((target("avx2"))) void forwardAvx2(const float* w, const float* in, float* out) {
+    forwardLanes(w, in, out);
+}
+#endif
+
+// Shortest signed offset from a to b along an axis of `size` cells
+inline int axisOffset(int a, int b, int size, bool wraps) {
+    int d = b - a;
+    if (wraps) {
+        if (d > size / 2) d -= size;
+        if (d < -size / 2) d += size;
+    }
+    return d;
+}
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    return bits;
+}
+
+float bitsFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof value);
+    return value;
+}
+
+} // namespace
+
+void NeuralNet::forward(const float* inputs, float* outputs) const {
+    const float* w = weights.data();
+    float hidden[HIDDEN];
+    for (int h = 0; h < HIDDEN; ++h) {
+        const float* row = w + h * (INPUTS + 1);
+        float acc = row[INPUTS];
+        for (int i = 0; i < INPUTS; ++i) acc += row[i] * inputs[i];
+        hidden[h] = relu(acc);
+    }
+    for (int o = 0; o < OUTPUTS; ++o) {
+        const float* row = w + HIDDEN_WEIGHTS + o * (HIDDEN + 1);
+        float acc = row[HIDDEN];
+        for (int h = 0; h < HIDDEN; ++h) acc += row[h] * hidden[h];
+        outputs[o] = acc;
+    }
+}
+
+void extractFeatures(const SimState& state, float* features) {
+    const Snake& snake = state.snake;
+    const GameConfig& config = state.config;
+    const int width = config.width;
+    const int height = config.height;
+    const bool wraps = config.wrapAround;
+    // Off-board cells are only walls where step() kills for them
+    const bool walls = !wraps && config.mode == GameMode::CLASSIC;
+    const Point head = snake.getHead();
+    const bool hasFood = state.food.isPlaced();
+    // Off the board when there is no food, so no ray sees it
+    const Point food = hasFood ? state.food.getPosition() : Point(-1, -1);
+
+    int heading = static_cast<int>(snake.getCurrentDirection());
+    int fx = STEP_X[heading], fy = STEP_Y[heading];
+    // Clockwise on screen, where y grows downward
+    int rx = -fy, ry = fx;
+    const int rayX[NeuralNet::RAYS] = {fx, fx + rx, rx, rx - fx, -fx, -fx - rx, -rx, fx - rx};
+    const int rayY[NeuralNet::RAYS] = {fy, fy + ry, ry, ry - fy, -fy, -fy - ry, -ry, fy - ry};
+
+    // The grid covers the whole board, which is all a ray visits
+    const OccupancyGrid& occupancy = snake.getOccupancy();
+    // Boards have two portals; rays report the first four entrances
+    Point entrances[4];
+    int entranceCount = 0;
+    for (const auto& entrance : state.portals) {
+        if (entrance.active && entranceCount < 4) entrances[entranceCount++] = entrance.position;
+    }
+
+    const int reach = std::max(width, height);
+    for (int r = 0; r < NeuralNet::RAYS; ++r) {
+        float wall = 0.0f, body = 0.0f, portal = 0.0f, seen = 0.0f;
+        Point p = head;
+        for (int k = 1; k <= reach; ++k) {
+            p.x += rayX[r];
+            p.y += rayY[r];
+            if (wraps) {
+                // Rays step at most one cell per axis, so no division needed
+                p.x += p.x < 0 ? width : (p.x >= width ? -width : 0);
+                p.y += p.y < 0 ? height : (p.y >= height ? -height : 0);
+            } else if (p.x < 0 || p.x >= width || p.y < 0 || p.y >= height) {
+                if (walls) wall = 1.0f / k;
+                break;
+            }
+            if (p == head) break;  // came all the way round
+            if (body == 0.0f && occupancy.isOccupied(p)) body = 1.0f / k;
+            if (p == food) seen = 1.0f;
+            if (portal == 0.0f) {
+                for (int e = 0; e < entranceCount; ++e) {
+                    if (entrances[e] == p) portal = 1.0f / k;
+                }
+            }
+        }
+        float* ray = features + r * NeuralNet::FEATURES_PER_RAY;
+        ray[0] = wall;
+        ray[1] = body;
+        ray[2] = seen;
+        ray[3] = portal;
+    }
+
+    float* offset = features + NeuralNet::RAYS * NeuralNet::FEATURES_PER_RAY;
+    if (hasFood) {
+        int dx = axisOffset(head.x, food.x, width, wraps);
+        int dy = axisOffset(head.y, food.y, height, wraps);
+        offset[0] = static_cast<float>(dx * fx + dy * fy) / reach;  // ahead
+        offset[1] = static_cast<float>(dx * rx + dy * ry) / reach;  // to the right
+    } else {
+        offset[0] = 0.0f;
+        offset[1] = 0.0f;
+    }
+}
+
+int bestMove(const float* outputs, int stride) {
+    int best = 0;
+    for (int i = 1; i < NeuralNet::OUTPUTS; ++i) {
+        if (outputs[i * stride] > outputs[best * stride]) best = i;
+    }
+    return best;
+}
+
+Direction relativeMove(Direction heading, int move) {
+    if (heading == Direction::NONE) return Direction::NONE;
+    int index = static_cast<int>(heading);
+    if (move == 0) return LEFT_OF[index];
+    if (move == 2) return RIGHT_OF[index];
+    return heading;
+}
+
+NeuralBatch::NeuralBatch()
+    : weights(static_cast<size_t>(NeuralNet::WEIGHTS) * LANES, 0.0f)
+#ifdef SNAKE_NEURAL_AVX2
+    , useAvx2(__builtin_cpu_supports("avx2"))
+#else
+    , useAvx2(false)
+#endif
+{
+}
+
+void NeuralBatch::load(const NeuralNet* const* nets, int count) {
+    constexpr int H = NeuralNet::HIDDEN;
+    constexpr int O = NeuralNet::OUTPUTS;
+    std::fill(weights.begin(), weights.end(), 0.0f);
+    for (int l = 0; l < std::min(count, LANES); ++l) {
+        const float* source = nets[l]->weights.data();
+        // NeuralNet order is unit-major with the bias last in each unit
+        for (int h = 0; h < H; ++h) {
+            for (int i = 0; i <= NeuralNet::INPUTS; ++i) {
+                weights[(static_cast<size_t>(i) * H + h) * LANES + l] = source[h * (NeuralNet::INPUTS + 1) + i];
+            }
+        }
+        const float* second = source + HIDDEN_WEIGHTS;
+        for (int o = 0; o < O; ++o) {
+            for (int h = 0; h <= H; ++h) {
+                weights[(HIDDEN_WEIGHTS + static_cast<size_t>(h) * O + o) * LANES + l] = second[o * (H + 1) + h];
+            }
+        }
+    }
+}
+
+void NeuralBatch::forward(const float* inputs, float* outputs) const {
+#ifdef SNAKE_NEURAL_AVX2
+    if (useAvx2) {
+        forwardAvx2(weights.data(), inputs, outputs);
+        return;
+    }
+#endif
+    forwardBaseline(weights.data(), inputs, outputs);
+}
+
+Direction NeuralPilot::decide(const SimState& state) const {
+    const Snake& snake = state.snake;
+    if (snake.isTeleporting()) return Direction::NONE;  // step() ignores it anyway
+    float features[NeuralNet::INPUTS];
+    float outputs[NeuralNet::OUTPUTS];
+    extractFeatures(state, features);
+    net.forward(features, outputs);
+    return relativeMove(snake.getCurrentDirection(), bestMove(outputs));
+}
+
+bool NeuralCheckpoint::save(const std::string& filename) const {
+    std::vector<uint8_t> body;
+    ByteWriter out(body);
+    out.u32(NeuralNet::INPUTS);
+    out.u32(NeuralNet::HIDDEN);
+    out.u32(NeuralNet::OUTPUTS);
+    out.u32(generation);
+    writeGameConfig(out, config);
+    out.u32(static_cast<uint32_t>(networks.size()));
+    for (size_t n = 0; n < networks.size(); ++n) {
+        out.u32(floatBits(n < fitness.size() ? fitness[n] : 0.0f));
+        for (float w : networks[n].weights) out.u32(floatBits(w));
+    }
+    uint32_t sum = ReplayFormat::checksum(body.data(), body.size());
+
+    // Written aside and renamed, so a crash mid-save keeps the last one
+    std::string temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file << MAGIC << '\n';
+        file.write(reinterpret_cast<const char*>(body.data()), body.size());
+        std::vector<uint8_t> trailer;
+        ByteWriter(trailer).u32(sum);
+        file.write(reinterpret_cast<const char*>(trailer.data()), trailer.size());
+        if (!file) return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, filename, error);
+    return !error;
+}
+
+bool NeuralCheckpoint::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) return false;
+    std::string version;
+    std::getline(file, version);
+    if (version != MAGIC) return false;
+
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+    if (bytes.size() < 4) return false;
+    size_t bodySize = bytes.size() - 4;
+    ByteReader sum(bytes.data() + bodySize, 4);
+    if (sum.u32() != ReplayFormat::checksum(bytes.data(), bodySize)) return false;
+
+    ByteReader in(bytes.data(), bodySize);
+    if (in.u32() != NeuralNet::INPUTS || in.u32() != NeuralNet::HIDDEN ||
+        in.u32() != NeuralNet::OUTPUTS) {
+        return false;
+    }
+    NeuralCheckpoint loaded;
+    loaded.generation = in.u32();
+    if (!readGameConfig(in, loaded.config)) return false;
+    uint32_t count = in.u32();
+    // Each network takes 4 bytes of fitness and 4 per weight
+    if (!in.ok() || count == 0 || in.remaining() != static_cast<size_t>(count) * (NeuralNet::WEIGHTS + 1) * 4) {
+        return false;
+    }
+    loaded.networks.resize(count);
+    loaded.fitness.resize(count);
+    for (uint32_t n = 0; n < count; ++n) {
+        loaded.fitness[n] = bitsFloat(in.u32());
+        for (float& w : loaded.networks[n].weights) w = bitsFloat(in.u32());
+    }
+    if (!in.ok()) return false;
+    *this = std::move(loaded);
+    return true;
+}
+
+} // namespace SnakeGame
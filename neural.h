@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sim.h"
+
+namespace SnakeGame {
+
+// A small fixed-shape MLP that steers the snake: ray-cast features in, one
+// of three moves relative to the heading out (turn left, keep going, turn
+// right). Hidden units use ReLU; the move with the largest output wins.
+//
+// Weights are one flat array: for each hidden unit its INPUTS weights and
+// a bias, then for each output its HIDDEN weights and a bias.
+class NeuralNet {
+public:
+    // Eight rays from the head, ahead first and turning clockwise; each
+    // reports 1/distance to the nearest wall, body segment and portal
+    // entrance on it (0 when none) and 1 if the food lies on it. Two more
+    // inputs give the food's offset in the snake's own frame, as a
+    // fraction of the board.
+    static constexpr int RAYS = 8;
+    static constexpr int FEATURES_PER_RAY = 4;
+    static constexpr int INPUTS = RAYS * FEATURES_PER_RAY + 2;
+    static constexpr int HIDDEN = 16;
+    static constexpr int OUTPUTS = 3;
+    static constexpr int WEIGHTS = HIDDEN * (INPUTS + 1) + OUTPUTS * (HIDDEN + 1);
+
+    NeuralNet() : weights(WEIGHTS, 0.0f) {}
+
+    std::vector<float> weights;
+
+    // Runs one network on one feature vector
+    void forward(const float* inputs, float* outputs) const;
+};
+
+// Fills INPUTS features for the snake in `state`
+void extractFeatures(const SimState& state, float* features);
+
+// Index of the largest of OUTPUTS values spaced `stride` floats apart
+int bestMove(const float* outputs, int stride = 1);
+
+// The absolute direction for a relative move (0 left, 1 ahead, 2 right)
+Direction relativeMove(Direction heading, int move);
+
+// Up to LANES networks evaluated side by side. Weights are interleaved so
+// the same weight of every lane sits in one contiguous run; a forward pass
+// is then the same multiply-add on LANES floats at a time, which maps onto
+// one AVX register (two SSE ones). An AVX2 build of the kernel is picked
+// at run time where the CPU has it. Results match NeuralNet::forward bit
+// for bit on either kernel.
+class NeuralBatch {
+public:
+    static constexpr int LANES = 8;
+
+    NeuralBatch();
+
+    // Lanes past `count` get all-zero networks
+    void load(const NeuralNet* const* nets, int count);
+    // inputs holds INPUTS x LANES floats, lane-minor (feature i of lane j
+    // at i * LANES + j); outputs gets OUTPUTS x LANES the same way
+    void forward(const float* inputs, float* outputs) const;
+
+private:
+    std::vector<float> weights;  // WEIGHTS x LANES
+    bool useAvx2;
+};
+
+// Plays with a trained network; drop-in for Autopilot::decide
+class NeuralPilot {
+public:
+    explicit NeuralPilot(const NeuralNet& net) : net(net) {}
+
+    Direction decide(const SimState& state) const;
+
+private:
+    NeuralNet net;
+};
+
+// Training snapshot: the networks best first, with the rules they were
+// trained under. Saved as SNAKE_NET_v1 (little-endian): the magic line,
+// u32 inputs, hidden and outputs (the shape must match on load), u32
+// generation, the game config as in replays, u32 network count, then per
+// network f32 fitness and WEIGHTS f32 weights, then a u32 checksum of
+// everything after the magic line.
+struct NeuralCheckpoint {
+    uint32_t generation = 0;
+    GameConfig config = GameConfig::defaultConfig();
+    std::vector<NeuralNet> networks;
+    std::vector<float> fitness;
+
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+};
+
+} // namespace SnakeGame
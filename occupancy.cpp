@@ -0,0 +1,200 @@
+#include "occupancy.h"
+#include "rng.h"
+#include <algorithm>
+
+namespace SnakeGame {
+
+namespace {
+
+// Random cells tried before a sampled draw falls back to a scan
+constexpr int SAMPLE_ATTEMPTS = 64;
+
+} // namespace
+
+OccupancyGrid::OccupancyGrid(int width, int height)
+    : width(std::max(width, 0))
+    , height(std::max(height, 0))
+    , chunkColumns((this->width + CHUNK - 1) >> CHUNK_BITS)
+    , directory(static_cast<size_t>(chunkColumns) * ((this->height + CHUNK - 1) >> CHUNK_BITS), NO_CHUNK)
+    , sampled(false)
+    , spawnMinX(0), spawnMinY(0), spawnMaxX(-1), spawnMaxY(-1)
+    , spawnFree(0) {
+}
+
+uint32_t OccupancyGrid::allocateChunk(size_t home) {
+    uint32_t chunk;
+    if (!freeChunks.empty()) {
+        chunk = freeChunks.back();
+        freeChunks.pop_back();
+        chunkHome[chunk] = static_cast<uint32_t>(home);
+    } else {
+        chunk = static_cast<uint32_t>(chunkHome.size());
+        cells.resize(cells.size() + CHUNK_CELLS, 0);
+        chunkSegments.push_back(0);
+        chunkHome.push_back(static_cast<uint32_t>(home));
+    }
+    return chunk;
+}
+
+void OccupancyGrid::clear() {
+    std::vector<bool> idle(chunkHome.size(), false);
+    for (uint32_t chunk : freeChunks) idle[chunk] = true;
+    for (uint32_t chunk = 0; chunk < chunkHome.size(); ++chunk) {
+        if (idle[chunk]) continue;
+        std::fill(cells.begin() + chunk * CHUNK_CELLS, cells.begin() + (chunk + 1) * CHUNK_CELLS, 0);
+        chunkSegments[chunk] = 0;
+        directory[chunkHome[chunk]] = NO_CHUNK;
+        freeChunks.push_back(chunk);
+    }
+    for (size_t cell = 0; cell < freeSlot.size(); ++cell) {
+        if (freeSlot[cell] == OCCUPIED) releaseFreeCell(cell);
+    }
+    if (sampled) {
+        spawnFree = static_cast<size_t>(spawnMaxX - spawnMinX + 1) * (spawnMaxY - spawnMinY + 1);
+        for (const Point& p : excluded) {
+            if (p.x >= spawnMinX && p.x <= spawnMaxX && p.y >= spawnMinY && p.y <= spawnMaxY) spawnFree--;
+        }
+    }
+}
+
+void OccupancyGrid::enableFreeCellIndex(int minX, int minY, int maxX, int maxY, bool sampledOnly) {
+    freeSlot.clear();
+    freeCells.clear();
+    excluded.clear();
+
+    minX = std::max(minX, 0);
+    minY = std::max(minY, 0);
+    maxX = std::min(maxX, width - 1);
+    maxY = std::min(maxY, height - 1);
+    size_t area = static_cast<size_t>(width) * height;
+    if (area > DENSE_INDEX_LIMIT || sampledOnly) {
+        sampled = true;
+        spawnMinX = minX;
+        spawnMinY = minY;
+        spawnMaxX = std::max(maxX, minX - 1);
+        spawnMaxY = std::max(maxY, minY - 1);
+        spawnFree = static_cast<size_t>(spawnMaxX - spawnMinX + 1) * (spawnMaxY - spawnMinY + 1);
+        // Take out what is already on the board, chunk by chunk
+        for (uint32_t chunk = 0; chunk < chunkHome.size(); ++chunk) {
+            if (chunkSegments[chunk] == 0) continue;
+            int baseX = static_cast<int>(chunkHome[chunk] % chunkColumns) << CHUNK_BITS;
+            int baseY = static_cast<int>(chunkHome[chunk] / chunkColumns) << CHUNK_BITS;
+            for (size_t offset = 0; offset < CHUNK_CELLS; ++offset) {
+                Point p(baseX + static_cast<int>(offset & (CHUNK - 1)), baseY + static_cast<int>(offset >> CHUNK_BITS));
+                if (cells[chunk * CHUNK_CELLS + offset] != 0 && isSpawnCell(p)) spawnFree--;
+            }
+        }
+        return;
+    }
+
+    sampled = false;
+    freeSlot.assign(area, NOT_SPAWNABLE);
+    for (int y = minY; y <= maxY; ++y) {
+        for (int x = minX; x <= maxX; ++x) {
+            Point p(x, y);
+            size_t cell = index(p);
+            if (count(p) == 0) {
+                freeSlot[cell] = static_cast<uint32_t>(freeCells.size());
+                freeCells.push_back(static_cast<uint32_t>(cell));
+            } else {
+                freeSlot[cell] = OCCUPIED;
+            }
+        }
+    }
+}
+
+void OccupancyGrid::excludeFromFreeCells(const Point& p) {
+    if (!contains(p)) return;
+    if (sampled) {
+        if (!isSpawnCell(p)) return;
+        if (count(p) == 0) spawnFree--;
+        excluded.push_back(p);
+        return;
+    }
+    if (freeSlot.empty()) return;
+    size_t cell = index(p);
+    if (freeSlot[cell] != OCCUPIED && freeSlot[cell] != NOT_SPAWNABLE) {
+        takeFreeCell(cell);
+    }
+    freeSlot[cell] = NOT_SPAWNABLE;
+}
+
+size_t OccupancyGrid::freeCellCount() const {
+    return sampled ? spawnFree : freeCells.size();
+}
+
+template <typename Rng>
+bool OccupancyGrid::randomFreeCell(Rng& rng, Point& out) const {
+    if (!sampled) {
+        if (freeCells.empty()) return false;
+        uint32_t cell = freeCells[boundedRandom(rng, static_cast<uint32_t>(freeCells.size()))];
+        out = Point(static_cast<int>(cell % width), static_cast<int>(cell / width));
+        return true;
+    }
+
+    if (spawnFree == 0) return false;
+    uint32_t spanX = static_cast<uint32_t>(spawnMaxX - spawnMinX + 1);
+    uint32_t spanY = static_cast<uint32_t>(spawnMaxY - spawnMinY + 1);
+    // A board this size is almost all free, so a few draws nearly always do
+    for (int attempt = 0; attempt < SAMPLE_ATTEMPTS; ++attempt) {
+        Point p(spawnMinX + static_cast<int>(boundedRandom(rng, spanX)),
+                spawnMinY + static_cast<int>(boundedRandom(rng, spanY)));
+        if (count(p) == 0 && isSpawnCell(p)) {
+            out = p;
+            return true;
+        }
+    }
+    // Crowded: take the first free cell after a random one, wrapping round.
+    // Not quite uniform, but it always finds one.
+    uint64_t area = static_cast<uint64_t>(spanX) * spanY;
+    uint64_t start = (static_cast<uint64_t>(rng()) << 32 | rng()) % area;
+    for (uint64_t i = 0; i < area; ++i) {
+        uint64_t cell = (start + i) % area;
+        Point p(spawnMinX + static_cast<int>(cell % spanX), spawnMinY + static_cast<int>(cell / spanX));
+        if (count(p) == 0 && isSpawnCell(p)) {
+            out = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+template bool OccupancyGrid::randomFreeCell(std::mt19937& rng, Point& out) const;
+template bool OccupancyGrid::randomFreeCell(SplitMix64& rng, Point& out) const;
+
+size_t OccupancyGrid::memoryBytes() const {
+    return directory.capacity() * sizeof(uint32_t) + cells.capacity() * sizeof(uint16_t) +
+           (chunkSegments.capacity() + chunkHome.capacity() + freeChunks.capacity()) * sizeof(uint32_t) +
+           (freeCells.capacity() + freeSlot.capacity()) * sizeof(uint32_t) +
+           excluded.capacity() * sizeof(Point);
+}
+
+bool OccupancyGrid::isSpawnCell(const Point& p) const {
+    if (p.x < spawnMinX || p.x > spawnMaxX || p.y < spawnMinY || p.y > spawnMaxY) return false;
+    // Only a couple of portals, so a scan beats any set
+    for (const Point& cell : excluded) {
+        if (cell == p) return false;
+    }
+    return true;
+}
+
+void OccupancyGrid::takeFreeCell(size_t cell) {
+    uint32_t slot = freeSlot[cell];
+    if (slot >= OCCUPIED) return;
+
+    // Swap-remove: move the last free cell into the vacated slot
+    uint32_t last = freeCells.back();
+    freeCells[slot] = last;
+    freeSlot[last] = slot;
+    freeCells.pop_back();
+    freeSlot[cell] = OCCUPIED;
+}
+
+void OccupancyGrid::releaseFreeCell(size_t cell) {
+    if (freeSlot[cell] != OCCUPIED) return;
+
+    freeSlot[cell] = static_cast<uint32_t>(freeCells.size());
+    freeCells.push_back(static_cast<uint32_t>(cell));
+}
+
+} // namespace SnakeGame
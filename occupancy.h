@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "point.h"
+
+namespace SnakeGame {
+
+// Per-cell segment counts for a width x height board. Counts rather than
+// bits because a freshly grown snake briefly stacks two segments on its tail.
+//
+// Counts live in CHUNK x CHUNK blocks that are allocated the first time a
+// segment lands in them and recycled once they empty again, so a
+// 65536x65536 world costs a directory of chunk numbers plus the chunks the
+// snake is actually on. Looking a cell up is one directory load and one
+// chunk load.
+//
+// Optionally also keeps an index of the free cells inside a spawn rectangle
+// (dense array plus per-cell slot, swap-remove on update) so a uniformly
+// random free cell can be drawn in constant time. That index is per cell,
+// so rectangles larger than DENSE_INDEX_LIMIT cells only keep a count of
+// their free cells and draw food by rejection sampling instead.
+class OccupancyGrid {
+public:
+    static constexpr int CHUNK_BITS = 6;
+    static constexpr int CHUNK = 1 << CHUNK_BITS;
+    static constexpr size_t CHUNK_CELLS = static_cast<size_t>(CHUNK) * CHUNK;
+    static constexpr size_t DENSE_INDEX_LIMIT = size_t(1) << 22;
+
+    OccupancyGrid(int width = 0, int height = 0);
+
+    bool contains(const Point& p) const {
+        return p.x >= 0 && p.x < width && p.y >= 0 && p.y < height;
+    }
+    uint16_t count(const Point& p) const {
+        if (!contains(p)) return 0;
+        uint32_t chunk = directory[chunkOf(p)];
+        return chunk == NO_CHUNK ? 0 : cells[chunk * CHUNK_CELLS + offsetOf(p)];
+    }
+    bool isOccupied(const Point& p) const { return count(p) != 0; }
+
+    void add(const Point& p) {
+        if (!contains(p)) return;
+        uint32_t& chunk = directory[chunkOf(p)];
+        if (chunk == NO_CHUNK) chunk = allocateChunk(chunkOf(p));
+        chunkSegments[chunk]++;
+        if (cells[chunk * CHUNK_CELLS + offsetOf(p)]++ == 0) takeCell(p);
+    }
+    void remove(const Point& p) {
+        if (!contains(p)) return;
+        size_t home = chunkOf(p);
+        uint32_t chunk = directory[home];
+        if (chunk == NO_CHUNK) return;
+        if (--cells[chunk * CHUNK_CELLS + offsetOf(p)] == 0) releaseCell(p);
+        if (--chunkSegments[chunk] == 0) {
+            // Every count in it is back to zero, so it can be reused as is
+            directory[home] = NO_CHUNK;
+            freeChunks.push_back(chunk);
+        }
+    }
+    void clear();
+
+    // Start indexing free cells in the inclusive rectangle [minX..maxX] x [minY..maxY].
+    // sampledOnly skips the dense index whatever the size: draws then depend
+    // only on which cells are free, not on the order they were taken and
+    // freed in, so a grid rebuilt from the same bodies draws the same cells.
+    void enableFreeCellIndex(int minX, int minY, int maxX, int maxY, bool sampledOnly = false);
+    // Permanently remove a cell from the spawn set (portals, obstacles)
+    void excludeFromFreeCells(const Point& p);
+    size_t freeCellCount() const;
+    // Returns false when no free cell is left. Rng is std::mt19937 or
+    // SplitMix64 (rng.h), the two instantiated in occupancy.cpp.
+    template <typename Rng>
+    bool randomFreeCell(Rng& rng, Point& out) const;
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    // Chunks holding at least one segment, and chunks allocated so far
+    size_t getChunksInUse() const { return chunkHome.size() - freeChunks.size(); }
+    size_t getChunksAllocated() const { return chunkHome.size(); }
+    // Heap bytes held by the grid and its free-cell index
+    size_t memoryBytes() const;
+
+private:
+    static constexpr uint32_t NOT_SPAWNABLE = 0xFFFFFFFFu;
+    static constexpr uint32_t OCCUPIED = 0xFFFFFFFEu;
+    static constexpr uint32_t NO_CHUNK = 0xFFFFFFFFu;
+
+    int width;
+    int height;
+    int chunkColumns;
+    std::vector<uint32_t> directory;      // per chunk of the board: chunk number or NO_CHUNK
+    std::vector<uint16_t> cells;          // CHUNK_CELLS counts per allocated chunk
+    std::vector<uint32_t> chunkSegments;  // per allocated chunk: segments in it
+    std::vector<uint32_t> chunkHome;      // per allocated chunk: its directory slot
+    std::vector<uint32_t> freeChunks;
+
+    // Dense index
+    std::vector<uint32_t> freeCells;  // cell indices, unordered
+    std::vector<uint32_t> freeSlot;   // per cell: position in freeCells or a marker
+
+    // Sampled index: the spawn rectangle, cells taken out of it and how
+    // many of the rest are free
+    bool sampled;
+    int spawnMinX, spawnMinY, spawnMaxX, spawnMaxY;
+    std::vector<Point> excluded;
+    size_t spawnFree;
+
+    size_t chunkOf(const Point& p) const {
+        return static_cast<size_t>(p.y >> CHUNK_BITS) * chunkColumns + (p.x >> CHUNK_BITS);
+    }
+    static size_t offsetOf(const Point& p) {
+        return static_cast<size_t>(p.y & (CHUNK - 1)) << CHUNK_BITS | (p.x & (CHUNK - 1));
+    }
+    size_t index(const Point& p) const {
+        return static_cast<size_t>(p.y) * width + p.x;
+    }
+    uint32_t allocateChunk(size_t home);
+    // A cell's count went from zero to one, or back
+    void takeCell(const Point& p) {
+        if (!freeSlot.empty()) {
+            takeFreeCell(index(p));
+        } else if (sampled && isSpawnCell(p)) {
+            spawnFree--;
+        }
+    }
+    void releaseCell(const Point& p) {
+        if (!freeSlot.empty()) {
+            releaseFreeCell(index(p));
+        } else if (sampled && isSpawnCell(p)) {
+            spawnFree++;
+        }
+    }
+    bool isSpawnCell(const Point& p) const;
+    void takeFreeCell(size_t cell);
+    void releaseFreeCell(size_t cell);
+};
+
+} // namespace SnakeGame
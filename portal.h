@@ -0,0 +1,13 @@
+#pragma once
+
+#include "point.h"
+
+namespace SnakeGame {
+
+struct Portal {
+    Point position;
+    Point destination;
+    bool active;
+};
+
+} // namespace SnakeGame
@@ -1,84 +1,118 @@
 #include "renderer.h"
-#include <iostream>
 #include <iomanip>
 #include <thread>
-#include <windows.h>
 #include <string>
 #include <sstream>
 #include <cmath>
+#include <ctime>
+
+// Console-independent drawing. Everything here is composed from the
+// primitives (clear, refresh, drawChar, drawString, setTextColor) that
+// each platform backend implements in renderer_win32.cpp / renderer_ansi.cpp.
 
 namespace SnakeGame {
 
-Renderer::Renderer(const GameConfig& config)
-    : config(config), consoleHandle(GetStdHandle(STD_OUTPUT_HANDLE)) {
-    // Set up console
-    CONSOLE_CURSOR_INFO cursorInfo;
-    GetConsoleCursorInfo(consoleHandle, &cursorInfo);
-    cursorInfo.bVisible = false;
-    SetConsoleCursorInfo(consoleHandle, &cursorInfo);
+namespace {
+
+// Lines under the board: a blank one, the score, then controls or status
+constexpr int STATUS_ROWS = 3;
+// Assumed when the terminal does not report its size
+constexpr int FALLBACK_COLUMNS = 80;
+constexpr int FALLBACK_ROWS = 24;
+
+} // namespace
+
+void Renderer::setupViewport(int terminalColumns, int terminalRows) {
+    if (terminalColumns <= 0 || terminalRows <= STATUS_ROWS) {
+        terminalColumns = FALLBACK_COLUMNS;
+        terminalRows = FALLBACK_ROWS;
+    }
+    screenColumns = terminalColumns;
+    screenRows = terminalRows;
+    viewport = Viewport(config.width, config.height, config.wrapAround);
+    viewport.resize(terminalColumns, terminalRows - STATUS_ROWS);
 }
 
-Renderer::~Renderer() {
-    // Restore cursor
-    CONSOLE_CURSOR_INFO cursorInfo;
-    GetConsoleCursorInfo(consoleHandle, &cursorInfo);
-    cursorInfo.bVisible = true;
-    SetConsoleCursorInfo(consoleHandle, &cursorInfo);
+void Renderer::setWorld(const GameConfig& world) {
+    config = world;
+    setupViewport(screenColumns, screenRows);
 }
 
-void Renderer::render(const Snake& snake, const Food& food, int score, int highScore, bool paused, bool gameOver) {
-    clearScreen();
-    
-    // Reset board
-    for (auto& row : board) {
-        std::fill(row.begin(), row.end(), EMPTY);
+void Renderer::drawCell(const Point& world, char c) {
+    Point screen;
+    if (viewport.toScreen(world, screen)) {
+        drawChar(screen.x, screen.y, c);
     }
-    
-    drawBorder();
-    drawSnake(snake);
-    drawFood(food);
-    drawScore(score, highScore);
-    drawControls();
-    
-    if (paused) showPause();
-    if (gameOver) showGameOver(score, highScore);
 }
 
-void Renderer::showGameOver(int score, int highScore) {
-    int centerY = config.height / 2;
-    centerText("GAME OVER", centerY - 2);
-    centerText("Score: " + std::to_string(score), centerY);
-    centerText("High Score: " + std::to_string(highScore), centerY + 1);
-    centerText("Press any key to exit", centerY + 3);
+void Renderer::drawSnake(const SnakeBody& body) {
+    setTextColor(FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+    for (size_t i = 0; i < body.size(); ++i) {
+        drawCell(body[i], (i == 0) ? SNAKE_HEAD : SNAKE_BODY);
+    }
+    setTextColor(FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
 }
 
-void Renderer::showPause() {
-    int centerY = config.height / 2;
-    centerText("PAUSED", centerY);
-    centerText("Press P to resume", centerY + 1);
+void Renderer::drawSnake(const Snake& snake) {
+    const SnakeBody& body = snake.getBody();
+    int columns = viewport.getColumns();
+    int rows = viewport.getRows();
+    if (body.size() <= static_cast<size_t>(columns) * rows) {
+        drawSnake(body);
+        return;
+    }
+    
+    // Longer than the window has cells: ask the grid about each one instead
+    const OccupancyGrid& occupancy = snake.getOccupancy();
+    setTextColor(FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            if (occupancy.isOccupied(viewport.toWorld(Point(x, y)))) {
+                drawChar(x, y, SNAKE_BODY);
+            }
+        }
+    }
+    drawCell(body.front(), SNAKE_HEAD);
+    setTextColor(FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
 }
 
-void Renderer::showStartScreen() {
-    clearScreen();
-    int centerY = config.height / 2;
-    
-    centerText("SNAKE GAME", centerY - 3);
-    centerText("Press ENTER to start", centerY);
-    centerText("Press C for configuration", centerY + 1);
-    centerText("Press ESC to quit", centerY + 2);
+void Renderer::drawArena(const Arena& arena, int player) {
+    // Bodies by grid lookups over the window, then one head per snake
+    const OccupancyGrid& occupancy = arena.getOccupancy();
+    setTextColor(FOREGROUND_GREEN);
+    for (int y = 0; y < viewport.getRows(); ++y) {
+        for (int x = 0; x < viewport.getColumns(); ++x) {
+            if (occupancy.isOccupied(viewport.toWorld(Point(x, y)))) {
+                drawChar(x, y, SNAKE_BODY);
+            }
+        }
+    }
+    setTextColor(FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+    for (int i = 0; i < arena.getSnakeCount(); ++i) {
+        const ArenaSnake& snake = arena.getSnake(i);
+        if (snake.alive && i != player) drawCell(snake.body.front(), RIVAL_HEAD);
+    }
+    const ArenaSnake& self = arena.getSnake(player);
+    if (self.alive) {
+        setTextColor(FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+        drawCell(self.body.front(), SNAKE_HEAD);
+    }
+    for (const Point& food : arena.getFood()) {
+        // Slots still waiting for a free cell sit off the board
+        if (occupancy.contains(food)) drawFood(food);
+    }
+    setTextColor(FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
 }
 
-void Renderer::showConfigScreen(const GameConfig& config) {
-    clearScreen();
-    int centerY = config.height / 2;
-    
-    centerText("CONFIGURATION", centerY - 4);
-    centerText("1. Grid Size: " + std::to_string(config.width) + "x" + std::to_string(config.height), centerY - 2);
-    centerText("2. Game Mode: " + (config.mode == GameMode::CLASSIC ? "Classic" : "Wrap Around"), centerY - 1);
-    centerText("3. Difficulty: " + std::to_string(static_cast<int>(config.difficulty)), centerY);
-    centerText("4. Special Food: " + (config.enableSpecialFood ? "On" : "Off"), centerY + 1);
-    centerText("5. Animations: " + (config.enableAnimations ? "On" : "Off"), centerY + 2);
-    centerText("Press number to change, ENTER to start", centerY + 4);
+void Renderer::drawArenaStatus(int alive, int snakes) {
+    drawString(0, viewport.getRows() + 2, "Arena: " + std::to_string(alive) + "/" +
+                                          std::to_string(snakes) + " snakes alive");
+}
+
+void Renderer::drawFood(const Point& position) {
+    setTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
+    drawCell(position, FOOD);
+    setTextColor(FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
 }
 
 void Renderer::animateFoodEaten(const Point& position) {
@@ -89,95 +123,72 @@ void Renderer::animateFoodEaten(const Point& position) {
     
     // Flash effect
     for (int i = 0; i < 3; ++i) {
-        board[position.y][position.x] = '*';
-        render(Snake(0, 0), Food(config), 0, 0, false, false);
+        drawCell(position, '*');
+        refresh();
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        board[position.y][position.x] = EMPTY;
-        render(Snake(0, 0), Food(config), 0, 0, false, false);
+        drawCell(position, EMPTY);
+        refresh();
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     
     isAnimating = false;
 }
 
-void Renderer::animateSnakeDeath(const std::vector<Point>& snakeBody) {
+void Renderer::animateSnakeDeath(const SnakeBody& snakeBody) {
     if (!config.enableAnimations) return;
     
     isAnimating = true;
     lastAnimationTime = std::chrono::steady_clock::now();
     
     // Death animation
-    for (const auto& point : snakeBody) {
-        board[point.y][point.x] = 'X';
-        render(Snake(0, 0), Food(config), 0, 0, false, false);
+    for (Point point : snakeBody) {
+        drawCell(point, 'X');
+        refresh();
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
     }
     
     isAnimating = false;
 }
 
-void Renderer::clearScreen() {
-    system("cls");
-}
-
 void Renderer::drawBorder() {
-    for (int i = 0; i < config.width; i++) {
-        board[0][i] = WALL;
-        board[config.height - 1][i] = WALL;
-    }
-    for (int i = 0; i < config.height; i++) {
-        board[i][0] = WALL;
-        board[i][config.width - 1] = WALL;
-    }
-}
-
-void Renderer::drawSnake(const Snake& snake) {
-    const auto& body = snake.getBody();
-    for (size_t i = 0; i < body.size(); ++i) {
-        const auto& point = body[i];
-        board[point.y][point.x] = (i == 0) ? SNAKE_HEAD : SNAKE_BODY;
+    // Only the rows in view, so a huge world costs no more than a small one
+    for (int y = 0; y < viewport.getRows(); ++y) {
+        int worldY = viewport.toWorld(Point(0, y)).y;
+        if (worldY == 0 || worldY == config.height - 1) {
+            drawString(0, y, std::string(viewport.getColumns(), WALL));
+        } else {
+            drawCell(Point(0, worldY), WALL);
+            drawCell(Point(config.width - 1, worldY), WALL);
+        }
     }
 }
 
-void Renderer::drawFood(const Food& food) {
-    const auto& pos = food.getPosition();
-    board[pos.y][pos.x] = food.getDisplayChar();
-}
-
 void Renderer::drawScore(int score, int highScore) {
-    std::cout << "\nScore: " << score << " | High Score: " << highScore << '\n';
+    drawString(0, viewport.getRows() + 1, "Score: " + std::to_string(score) +
+                                     " | High Score: " + std::to_string(highScore));
 }
 
 void Renderer::drawControls() {
-    std::cout << "Controls: WASD to move, P to pause, ESC to quit\n";
-}
-
-void Renderer::centerText(const std::string& text, int y) {
-    int x = (config.width - text.length()) / 2;
-    std::cout << std::string(x, ' ') << text << '\n';
+    drawString(0, viewport.getRows() + 2, "Controls: WASD to move, P to pause, ESC to quit");
 }
 
 void Renderer::drawBox(int x, int y, int width, int height) {
-    for (int i = 0; i < height; ++i) {
-        for (int j = 0; j < width; ++j) {
-            if (i == 0 || i == height - 1 || j == 0 || j == width - 1) {
-                board[y + i][x + j] = WALL;
-            }
-        }
+    // Draw top border
+    drawString(x, y, std::string(width, '-'));
+    
+    // Draw sides
+    for (int i = 1; i < height - 1; ++i) {
+        drawChar(x, y + i, '|');
+        drawChar(x + width - 1, y + i, '|');
     }
-}
-
-void Renderer::clear() {
-    system("cls");
-}
-
-void Renderer::refresh() {
-    // No need to do anything special for Windows console
+    
+    // Draw bottom border
+    drawString(x, y + height - 1, std::string(width, '-'));
 }
 
 void Renderer::drawPortal(const Point& position) {
     setTextColor(FOREGROUND_BLUE | FOREGROUND_INTENSITY);
-    drawChar(position.x, position.y, 'O');
+    drawCell(position, PORTAL);
 }
 
 void Renderer::drawCombo(int combo) {
@@ -185,10 +196,17 @@ void Renderer::drawCombo(int combo) {
         setTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
         std::stringstream ss;
         ss << "Combo x" << combo << "!";
-        drawString(config.width - ss.str().length() - 2, 0, ss.str());
+        drawString(viewport.getColumns() - ss.str().length() - 2, 0, ss.str());
     }
 }
 
+void Renderer::drawReplayStatus(uint32_t tick, uint32_t tickCount, bool paused) {
+    std::stringstream ss;
+    ss << (paused ? "[paused] " : "") << "Tick " << tick + 1 << "/" << tickCount
+       << " | A/D step (paused) or seek | W/S speed | P pause | ESC back";
+    drawString(0, viewport.getRows() + 2, ss.str());
+}
+
 void Renderer::drawHardcoreMode() {
     setTextColor(FOREGROUND_RED | FOREGROUND_INTENSITY);
     drawString(2, 1, "HARDCORE MODE");
@@ -261,16 +279,17 @@ void Renderer::drawHighScoreTable(const std::vector<HighScoreEntry>& highScores)
     }
     
     // Draw fancy high score table
-    drawBox(2, 4, config.width - 4, highScores.size() + 3);
+    drawBox(2, 4, viewport.getColumns() - 4, highScores.size() + 3);
     drawString(4, 5, "HIGH SCORES");
     
     for (size_t i = 0; i < highScores.size(); ++i) {
         const auto& entry = highScores[i];
+        std::time_t date = std::chrono::system_clock::to_time_t(entry.date);
         std::stringstream ss;
         ss << std::setw(2) << (i + 1) << ". " 
            << std::setw(15) << std::left << entry.name << " "
            << std::setw(5) << std::right << entry.score << " "
-           << std::put_time(std::localtime(&std::chrono::system_clock::to_time_t(entry.date)), "%Y-%m-%d");
+           << std::put_time(std::localtime(&date), "%Y-%m-%d");
         
         drawString(4, 6 + i, ss.str());
     }
@@ -292,7 +311,7 @@ void Renderer::drawGameOver(int finalScore) {
             " \\_____|\\__,_|_| |_| |_|\\___|  \\____/  \\_/ \\___|_|  (_)"
         };
         
-        int startY = (config.height - gameOverArt.size()) / 2;
+        int startY = (viewport.getRows() - gameOverArt.size()) / 2;
         for (const auto& line : gameOverArt) {
             drawCenteredText(startY++, line);
         }
@@ -303,7 +322,7 @@ void Renderer::drawGameOver(int finalScore) {
     
     // Draw continue message
     setTextColor(FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    drawCenteredText(config.height - 2, "Press any key to continue...");
+    drawCenteredText(viewport.getRows() - 2, "Press any key to continue...");
 }
 
 void Renderer::drawStartScreen() {
@@ -320,7 +339,7 @@ void Renderer::drawStartScreen() {
         "|_____/|_|\\__,_|_| |_(_)  \\_____|\\__,_|_| |_| |_|\\___|"
     };
     
-    int startY = (config.height - titleArt.size()) / 2;
+    int startY = (viewport.getRows() - titleArt.size()) / 2;
     for (const auto& line : titleArt) {
         drawCenteredText(startY++, line);
     }
@@ -330,14 +349,15 @@ void Renderer::drawStartScreen() {
     drawCenteredText(startY + 2, "1. Start Game");
     drawCenteredText(startY + 3, "2. Configuration");
     drawCenteredText(startY + 4, "3. Exit");
+    drawCenteredText(startY + 5, "4. Replays");
 }
 
-void Renderer::drawConfigScreen() {
+void Renderer::drawConfigScreen(const GameConfig& config) {
     clear();
     setTextColor(FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
     
     drawCenteredText(2, "Configuration");
-    drawBox(2, 4, config.width - 4, 10);
+    drawBox(2, 4, viewport.getColumns() - 4, 10);
     
     int y = 6;
     drawString(4, y++, "Grid Size: " + std::to_string(config.width) + "x" + std::to_string(config.height));
@@ -345,47 +365,12 @@ void Renderer::drawConfigScreen() {
     drawString(4, y++, "Wrap Around: " + std::string(config.wrapAround ? "Yes" : "No"));
     drawString(4, y++, "Hardcore Mode: " + std::string(config.hardcoreMode ? "Yes" : "No"));
     
-    drawCenteredText(config.height - 2, "Use arrow keys to navigate, ENTER to select");
-}
-
-void Renderer::setCursorPosition(int x, int y) {
-    COORD coord;
-    coord.X = x;
-    coord.Y = y;
-    SetConsoleCursorPosition(consoleHandle, coord);
-}
-
-void Renderer::setTextColor(int color) {
-    SetConsoleTextAttribute(consoleHandle, color);
-}
-
-void Renderer::drawChar(int x, int y, char c) {
-    setCursorPosition(x, y);
-    std::cout << c;
-}
-
-void Renderer::drawString(int x, int y, const std::string& str) {
-    setCursorPosition(x, y);
-    std::cout << str;
-}
-
-void Renderer::drawBox(int x, int y, int width, int height) {
-    // Draw top border
-    drawString(x, y, std::string(width, '-'));
-    
-    // Draw sides
-    for (int i = 1; i < height - 1; ++i) {
-        drawChar(x, y + i, '|');
-        drawChar(x + width - 1, y + i, '|');
-    }
-    
-    // Draw bottom border
-    drawString(x, y + height - 1, std::string(width, '-'));
+    drawCenteredText(viewport.getRows() - 2, "Use arrow keys to navigate, ENTER to select");
 }
 
 void Renderer::drawCenteredText(int y, const std::string& text) {
-    int x = (config.width - text.length()) / 2;
+    int x = (viewport.getColumns() - text.length()) / 2;
     drawString(x, y, text);
 }
 
-} // namespace SnakeGame 
\ No newline at end of file
+} // namespace SnakeGame
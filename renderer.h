@@ -1,13 +1,20 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
 #include <vector>
 #include <chrono>
-#include <deque>
 #include "constants.h"
 #include "snake.h"
 #include "food.h"
+#include "arena.h"
 #include "point.h"
+#include "snake_body.h"
+#include "viewport.h"
+#ifndef _WIN32
+#include "ansi_terminal.h"
+#include "framebuffer.h"
+#endif
 
 namespace SnakeGame {
 
@@ -17,6 +24,14 @@ struct HighScoreEntry {
     std::chrono::system_clock::time_point date;
 };
 
+// Drawing API used by Game. Screen compositions live in renderer.cpp; the
+// console primitives come from a platform backend (renderer_win32.cpp or
+// renderer_ansi.cpp).
+//
+// Board drawing goes through a Viewport sized to the terminal (less the
+// status lines), so worlds larger than the screen scroll with the camera
+// and only what is in view is drawn. Screens and status lines are laid out
+// on the viewport's size rather than the world's.
 class Renderer {
 public:
     Renderer(const GameConfig& config);
@@ -25,12 +40,25 @@ public:
     void clear();
     void refresh();
     
+    // Keep this world cell (the snake's head) comfortably in view
+    void followCamera(const Point& focus) { viewport.follow(focus); }
+    const Viewport& getViewport() const { return viewport; }
+    // Draw a different board (a replay's) in the same terminal
+    void setWorld(const GameConfig& world);
+    const GameConfig& getWorld() const { return config; }
+    
     // Drawing methods
-    void drawSnake(const std::deque<Point>& body);
+    void drawSnake(const SnakeBody& body);
+    // Same, but costs no more than the cells in view however long it gets
+    void drawSnake(const Snake& snake);
+    // Every snake of an arena and its food; `player` gets the usual head
+    void drawArena(const Arena& arena, int player);
+    void drawArenaStatus(int alive, int snakes);
     void drawFood(const Point& position);
     void drawPortal(const Point& position);
     void drawScore(int score, int highScore);
     void drawCombo(int combo);
+    void drawReplayStatus(uint32_t tick, uint32_t tickCount, bool paused);
     void drawHardcoreMode();
     void drawGameOver(int finalScore);
     void drawStartScreen();
@@ -42,7 +70,7 @@ public:
     
     // Animation methods
     void animateFoodEaten(const Point& position);
-    void animateSnakeDeath(const std::deque<Point>& snakeBody);
+    void animateSnakeDeath(const SnakeBody& snakeBody);
     void animateScoreCountUp(int finalScore, int startScore = 0);
     void animateBounceText(int y, const std::string& text, int duration);
     void animateWaveText(int y, const std::string& text, int duration);
@@ -54,19 +82,28 @@ public:
     
 private:
     GameConfig config;
-    std::vector<std::vector<char>> board;
     std::chrono::steady_clock::time_point lastAnimationTime;
     bool isAnimating;
     bool minimalMode;
+    Viewport viewport;
+    int screenColumns = 0;
+    int screenRows = 0;
+#ifdef _WIN32
     void* consoleHandle;
+#else
+    AnsiTerminal terminal;
+    FrameBuffer frame;
+    std::string frameBytes;
+    int textColor;
+#endif
     
     void setCursorPosition(int x, int y);
     void setTextColor(int color);
+    void setupViewport(int terminalColumns, int terminalRows);
+    // Draws a world cell if it is in view
+    void drawCell(const Point& world, char c);
     void drawBorder();
-    void drawSnake(const Snake& snake);
-    void drawFood(const Food& food);
     void drawControls();
-    void centerText(const std::string& text, int y);
 };
 
 } // namespace SnakeGame 
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "renderer.h"
+
+// POSIX terminal backend for Renderer. Drawing only touches the back
+// buffer; refresh() diffs it against the previous frame and sends just the
+// changed runs to the terminal in one write().
+
+namespace SnakeGame {
+
+Renderer::Renderer(const GameConfig& config)
+    : config(config)
+    , isAnimating(false)
+    , minimalMode(false)
+    , terminal()
+    , frame(terminal.getColumns(), terminal.getRows())
+    , textColor(FrameBuffer::DEFAULT_COLOR) {
+    setupViewport(terminal.getColumns(), terminal.getRows());
+}
+
+Renderer::~Renderer() = default;
+
+void Renderer::clear() {
+    frame.clear();
+}
+
+void Renderer::refresh() {
+    frameBytes.clear();
+    if (frame.diff(frameBytes) > 0) {
+        terminal.write(frameBytes);
+    }
+}
+
+void Renderer::setCursorPosition(int x, int y) {
+    // Every write is positioned explicitly, nothing to track
+    (void)x;
+    (void)y;
+}
+
+void Renderer::setTextColor(int color) {
+    textColor = color;
+}
+
+void Renderer::drawChar(int x, int y, char c) {
+    frame.put(x, y, c, static_cast<uint8_t>(textColor));
+}
+
+void Renderer::drawString(int x, int y, const std::string& str) {
+    frame.putString(x, y, str, static_cast<uint8_t>(textColor));
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,64 @@
+#include "renderer.h"
+#include <iostream>
+#include <windows.h>
+
+// Windows console backend for Renderer
+
+namespace SnakeGame {
+
+Renderer::Renderer(const GameConfig& config)
+    : config(config), isAnimating(false), minimalMode(false),
+      consoleHandle(GetStdHandle(STD_OUTPUT_HANDLE)) {
+    // Set up console
+    CONSOLE_CURSOR_INFO cursorInfo;
+    GetConsoleCursorInfo(consoleHandle, &cursorInfo);
+    cursorInfo.bVisible = false;
+    SetConsoleCursorInfo(consoleHandle, &cursorInfo);
+    
+    CONSOLE_SCREEN_BUFFER_INFO screenInfo;
+    if (GetConsoleScreenBufferInfo(consoleHandle, &screenInfo)) {
+        setupViewport(screenInfo.srWindow.Right - screenInfo.srWindow.Left + 1,
+                      screenInfo.srWindow.Bottom - screenInfo.srWindow.Top + 1);
+    } else {
+        setupViewport(0, 0);
+    }
+}
+
+Renderer::~Renderer() {
+    // Restore cursor
+    CONSOLE_CURSOR_INFO cursorInfo;
+    GetConsoleCursorInfo(consoleHandle, &cursorInfo);
+    cursorInfo.bVisible = true;
+    SetConsoleCursorInfo(consoleHandle, &cursorInfo);
+}
+
+void Renderer::clear() {
+    system("cls");
+}
+
+void Renderer::refresh() {
+    // No need to do anything special for Windows console
+}
+
+void Renderer::setCursorPosition(int x, int y) {
+    COORD coord;
+    coord.X = x;
+    coord.Y = y;
+    SetConsoleCursorPosition(consoleHandle, coord);
+}
+
+void Renderer::setTextColor(int color) {
+    SetConsoleTextAttribute(consoleHandle, color);
+}
+
+void Renderer::drawChar(int x, int y, char c) {
+    setCursorPosition(x, y);
+    std::cout << c;
+}
+
+void Renderer::drawString(int x, int y, const std::string& str) {
+    setCursorPosition(x, y);
+    std::cout << str;
+}
+
+} // namespace SnakeGame
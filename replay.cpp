@@ -2,19 +2,63 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <iterator>
+#include <algorithm>
 
 namespace SnakeGame {
 
-ReplaySystem::ReplaySystem() : recording(false) {}
+namespace {
 
-void ReplaySystem::startRecording(const std::string& playerName) {
+// A streamed block is cut after this many ticks even if a keyframe is not
+// due yet, bounding what a crash can lose
+constexpr uint32_t STREAM_CHECKPOINT_TICKS = 300;
+// Frames reserved up front when re-running an input log; a longer game
+// grows the list as it goes rather than trusting the file's tick count
+constexpr uint32_t MAX_RESERVED_FRAMES = 1 << 16;
+
+} // namespace
+
+ReplaySystem::ReplaySystem(ReplayMode mode)
+    : mode(mode), library(nullptr), recording(false), streamBlocksOffset(0) {}
+
+ReplaySystem::~ReplaySystem() {
+    if (stream) retireStream(std::string());
+}
+
+void ReplaySystem::startRecording(const std::string& playerName, const SimState& initial,
+                                  const std::string& streamPath) {
+    // An abandoned stream from the last game is not kept
+    if (stream) retireStream(std::string());
+    retiredStreams.erase(
+        std::remove_if(retiredStreams.begin(), retiredStreams.end(),
+                       [](const std::unique_ptr<ReplayStreamWriter>& writer) { return writer->isDone(); }),
+        retiredStreams.end());
+    
     currentReplay = ReplayData();
+    currentReplay.mode = mode;
+    currentReplay.inputLog.begin(initial);
+    currentReplay.hasConfig = true;
     currentReplay.playerName = playerName;
     currentReplay.date = std::chrono::system_clock::now();
     currentReplay.finalScore = 0;
     currentReplay.maxCombo = 0;
     recording = true;
+    encoder.reset();
     startTime = std::chrono::steady_clock::now();
+    
+    if (mode == ReplayMode::FRAMES && !streamPath.empty()) {
+        std::vector<uint8_t> header;
+        ByteWriter out(header);
+        writeHeader(out, ReplayFormat::MAGIC_V2);
+        if (const GameConfig* known = configIfKnown()) {
+            out.u32(ReplayFormat::CONFIG_MAGIC);
+            writeGameConfig(out, *known);
+        }
+        streamBlocksOffset = header.size();
+        stream.reset(new ReplayStreamWriter());
+        stream->start(streamPath);
+        stream->append(std::move(header));
+    }
 }
 
 void ReplaySystem::recordMove(Direction dir) {
@@ -22,62 +66,170 @@ void ReplaySystem::recordMove(Direction dir) {
     currentReplay.moves.push_back(dir);
 }
 
-void ReplaySystem::recordState(const std::deque<Point>& snakeBody, const Point& foodPos, 
+void ReplaySystem::recordInput(const SimState& state, Direction input) {
+    if (!recording) return;
+    currentReplay.inputLog.record(state.tick, input, state.tickDuration);
+}
+
+void ReplaySystem::recordState(const Snake& snake, const Point& foodPos, 
                              int score, int combo) {
     if (!recording) return;
-    
-    GameState state;
-    state.snakeBody = snakeBody;
-    state.foodPosition = foodPos;
-    state.score = score;
-    state.combo = combo;
-    state.timestamp = std::chrono::steady_clock::now();
-    
-    currentReplay.states.push_back(state);
     currentReplay.finalScore = score;
     currentReplay.maxCombo = std::max(currentReplay.maxCombo, combo);
+    if (currentReplay.mode == ReplayMode::INPUTS) return;
+    
+    int64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    encoder.record(snake.getBody(), snake.getMoveCount(), snake.getGrowCount(),
+                   foodPos, score, combo, timestamp);
+    if (stream) {
+        if (encoder.openBlockTicks() >= STREAM_CHECKPOINT_TICKS) encoder.cutBlock();
+        streamBlocks();
+    }
+}
+
+void ReplaySystem::streamBlocks() {
+    if (encoder.data().empty()) return;
+    std::vector<uint8_t> chunk;
+    encoder.takeData(chunk);
+    stream->append(std::move(chunk));
+}
+
+void ReplaySystem::retireStream(const std::string& finalPath) {
+    stream->finish(finalPath);
+    retiredStreams.push_back(std::move(stream));
 }
 
 void ReplaySystem::stopRecording() {
     if (!recording) return;
     
+    encoder.finish();
     currentReplay.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::steady_clock::now() - startTime);
     recording = false;
+    
+    if (stream) {
+        streamBlocks();
+        std::vector<uint8_t> tail;
+        ByteWriter out(tail);
+        writeReplayTail(out, summary(encoder.tickCount()), encoder.blockIndex(),
+                        currentReplay.moves, configIfKnown(),
+                        streamBlocksOffset, encoder.dataSize());
+        stream->append(std::move(tail));
+    }
 }
 
-bool ReplaySystem::saveReplay(const std::string& filename) const {
+void ReplaySystem::discardRecording() {
+    if (stream) retireStream(std::string());
+}
+
+void ReplaySystem::writeHeader(ByteWriter& out, const char* magic) const {
+    out.bytes(magic, std::char_traits<char>::length(magic));
+    out.u8('\n');
+    size_t nameLength = std::min<size_t>(currentReplay.playerName.size(), 0xFFFF);
+    out.u16(static_cast<uint16_t>(nameLength));
+    out.bytes(currentReplay.playerName.data(), nameLength);
+    out.i64(static_cast<int64_t>(std::chrono::system_clock::to_time_t(currentReplay.date)));
+}
+
+bool ReplaySystem::saveReplay(const std::string& filename) {
+    bool saved = true;
+    if (stream) {
+        retireStream(filename);
+    } else if (currentReplay.mode == ReplayMode::INPUTS) {
+        saved = saveInputReplay(filename);
+    } else {
+        saved = saveFrameReplay(filename);
+    }
+    
+    // Described from memory: a streamed file only appears once the writer
+    // thread renames it
+    if (saved && library) {
+        library->add(describe(filename));
+    }
+    return saved;
+}
+
+ReplayInfo ReplaySystem::describe(const std::string& filename) const {
+    ReplayInfo info;
+    info.file = filename;
+    info.playerName = currentReplay.playerName;
+    info.date = static_cast<int64_t>(std::chrono::system_clock::to_time_t(currentReplay.date));
+    info.finalScore = currentReplay.finalScore;
+    info.maxCombo = currentReplay.maxCombo;
+    info.durationMs = static_cast<int64_t>(currentReplay.duration.count());
+    if (currentReplay.mode == ReplayMode::INPUTS) {
+        info.format = ReplayFileFormat::INPUTS;
+        info.totalTicks = currentReplay.inputLog.totalTicks;
+    } else {
+        info.format = ReplayFileFormat::FRAMES_V2;
+        info.totalTicks = encoder.tickCount() > 0 ? encoder.tickCount()
+                                                  : static_cast<uint32_t>(currentReplay.states.size());
+    }
+    info.hasConfig = currentReplay.hasConfig;
+    info.config = currentReplay.inputLog.config;
+    return info;
+}
+
+bool ReplaySystem::saveInputReplay(const std::string& filename) const {
+    std::vector<uint8_t> bytes;
+    ByteWriter out(bytes);
+    writeHeader(out, ReplayFormat::MAGIC_INPUTS);
+    size_t bodyStart = sizeof(ReplayFormat::MAGIC_INPUTS);  // past the magic line
+    
+    currentReplay.inputLog.write(out);
+    out.i32(currentReplay.finalScore);
+    out.i32(currentReplay.maxCombo);
+    out.i64(currentReplay.duration.count());
+    out.u32(ReplayFormat::checksum(bytes.data() + bodyStart, bytes.size() - bodyStart));
+    
     std::ofstream file(filename, std::ios::binary);
     if (!file) return false;
-    
-    // Write header
-    file << "SNAKE_REPLAY_v1\n";
-    file << currentReplay.playerName << "\n";
-    file << std::chrono::system_clock::to_time_t(currentReplay.date) << "\n";
-    file << currentReplay.finalScore << "\n";
-    file << currentReplay.maxCombo << "\n";
-    file << currentReplay.duration.count() << "\n";
-    
-    // Write moves
-    file << currentReplay.moves.size() << "\n";
-    for (const auto& move : currentReplay.moves) {
-        file << static_cast<int>(move) << "\n";
-    }
-    
-    // Write states
-    file << currentReplay.states.size() << "\n";
-    for (const auto& state : currentReplay.states) {
-        file << state.snakeBody.size() << "\n";
-        for (const auto& point : state.snakeBody) {
-            file << point.x << " " << point.y << "\n";
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return static_cast<bool>(file);
+}
+
+const GameConfig* ReplaySystem::configIfKnown() const {
+    return currentReplay.hasConfig ? &currentReplay.inputLog.config : nullptr;
+}
+
+ReplaySummary ReplaySystem::summary(uint32_t totalTicks) const {
+    return {currentReplay.finalScore, currentReplay.maxCombo,
+            static_cast<int64_t>(currentReplay.duration.count()), totalTicks};
+}
+
+bool ReplaySystem::saveFrameReplay(const std::string& filename) const {
+    // A loaded replay has frames but no encoded blocks; re-encode it
+    ReplayEncoder converted;
+    const ReplayEncoder* blocks = &encoder;
+    if (encoder.tickCount() == 0 && !currentReplay.states.empty()) {
+        for (const auto& state : currentReplay.states) {
+            converted.record(state);
         }
-        file << state.foodPosition.x << " " << state.foodPosition.y << "\n";
-        file << state.score << "\n";
-        file << state.combo << "\n";
-        file << std::chrono::steady_clock::to_time_t(state.timestamp) << "\n";
+        converted.finish();
+        blocks = &converted;
     }
     
-    return true;
+    std::vector<uint8_t> bytes;
+    ByteWriter out(bytes);
+    
+    writeHeader(out, ReplayFormat::MAGIC_V2);
+    uint64_t blocksOffset = bytes.size();
+    
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    
+    // Blocks go out straight from the encoder's buffer
+    const auto& data = blocks->data();
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    
+    bytes.clear();
+    writeReplayTail(out, summary(blocks->tickCount()), blocks->blockIndex(),
+                    currentReplay.moves, configIfKnown(), blocksOffset, data.size());
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    
+    return static_cast<bool>(file);
 }
 
 bool ReplaySystem::loadReplay(const std::string& filename) {
@@ -86,50 +238,168 @@ bool ReplaySystem::loadReplay(const std::string& filename) {
     
     std::string version;
     std::getline(file, version);
-    if (version != "SNAKE_REPLAY_v1") return false;
+    currentReplay = ReplayData();
+    currentReplay.mode = ReplayMode::FRAMES;
+    currentReplay.hasConfig = false;
+    encoder.reset();
+    
+    if (version == ReplayFormat::MAGIC_V1) {
+        return loadReplayV1(file);
+    }
+    if (version != ReplayFormat::MAGIC_V2 && version != ReplayFormat::MAGIC_INPUTS) {
+        return false;
+    }
+    
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+    if (version == ReplayFormat::MAGIC_INPUTS) {
+        return loadInputReplay(bytes);
+    }
+    return loadReplayV2(bytes);
+}
+
+bool ReplaySystem::loadInputReplay(const std::vector<uint8_t>& bytes) {
+    if (bytes.size() < 4) return false;
+    size_t bodySize = bytes.size() - 4;
+    ByteReader sum(bytes.data() + bodySize, 4);
+    if (sum.u32() != ReplayFormat::checksum(bytes.data(), bodySize)) return false;
+    
+    ByteReader in(bytes.data(), bodySize);
+    currentReplay.mode = ReplayMode::INPUTS;
     
     // Read header
-    std::getline(file, currentReplay.playerName);
+    uint16_t nameLength = in.u16();
+    const uint8_t* name = in.bytes(nameLength);
+    if (!in.ok()) return false;
+    currentReplay.playerName.assign(reinterpret_cast<const char*>(name), nameLength);
+    currentReplay.date = std::chrono::system_clock::from_time_t(static_cast<time_t>(in.i64()));
     
-    time_t date;
-    file >> date;
-    currentReplay.date = std::chrono::system_clock::from_time_t(date);
+    InputLog& log = currentReplay.inputLog;
+    if (!log.read(in)) return false;
+    currentReplay.hasConfig = true;
+    currentReplay.finalScore = in.i32();
+    currentReplay.maxCombo = in.i32();
+    currentReplay.duration = std::chrono::milliseconds(in.i64());
+    if (!in.ok() || in.remaining() != 0) return false;
     
-    file >> currentReplay.finalScore;
-    file >> currentReplay.maxCombo;
+    for (const auto& input : log.inputs) {
+        currentReplay.moves.push_back(input.direction);
+    }
+    
+    // Rebuild the frames by running the rules; this doubles as the
+    // verification pass
+    InputLogPlayer player(log);
+    currentReplay.states.reserve(std::min(log.totalTicks, MAX_RESERVED_FRAMES));
+    while (!player.done()) {
+        player.advance();
+        const SimState& sim = player.state();
+        ReplayFrame frame;
+        frame.snakeBody = sim.snake.getBody();
+        frame.foodPosition = sim.food.getPosition();
+        frame.score = sim.score;
+        frame.combo = sim.snake.getCurrentCombo();
+        frame.timestamp = sim.clock;
+        currentReplay.states.push_back(frame);
+    }
     
+    const SimState& end = player.state();
+    return end.tick == log.totalTicks && end.score == currentReplay.finalScore;
+}
+
+bool ReplaySystem::loadReplayV2(const std::vector<uint8_t>& bytes) {
+    ByteReader in(bytes.data(), bytes.size());
+    
+    // Read header
+    uint16_t nameLength = in.u16();
+    const uint8_t* name = in.bytes(nameLength);
+    if (!in.ok()) return false;
+    currentReplay.playerName.assign(reinterpret_cast<const char*>(name), nameLength);
+    currentReplay.date = std::chrono::system_clock::from_time_t(static_cast<time_t>(in.i64()));
+    if (!readHeaderConfig(in, currentReplay.inputLog.config, currentReplay.hasConfig)) return false;
+    
+    uint32_t blockCount = 0;
+    if (!decodeReplayBlocks(in, currentReplay.states, blockCount)) return false;
+    
+    // Read trailer
+    if (in.u32() != ReplayFormat::TRAILER_MAGIC) return false;
+    currentReplay.finalScore = in.i32();
+    currentReplay.maxCombo = in.i32();
+    currentReplay.duration = std::chrono::milliseconds(in.i64());
+    uint32_t totalTicks = in.u32();
+    uint32_t totalBlocks = in.u32();
+    uint32_t moveCount = in.u32();
+    if (!in.ok() || totalTicks != currentReplay.states.size() || totalBlocks != blockCount) {
+        return false;
+    }
+    const uint8_t* moves = in.bytes(moveCount);
+    if (!in.ok()) return false;
+    currentReplay.moves.reserve(moveCount);
+    for (uint32_t i = 0; i < moveCount; ++i) {
+        currentReplay.moves.push_back(static_cast<Direction>(moves[i]));
+    }
+    
+    // Older files go straight on to the index here
+    ByteReader peek = in;
+    if (peek.u8() == 1) {
+        in.u8();
+        currentReplay.hasConfig = readGameConfig(in, currentReplay.inputLog.config);
+    }
+    
+    return true;
+}
+
+bool ReplaySystem::loadReplayV1(std::istream& file) {
+    // Counts come from the file; none may claim more entries than the
+    // bytes left could spell out, at two per number ("0 ")
+    std::streampos here = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streampos end = file.tellg();
+    file.seekg(here);
+    if (here < 0 || end < here) return false;
+    auto numbersLeft = [&]() -> size_t {
+        std::streampos at = file.tellg();
+        return at < 0 || at > end ? 0 : static_cast<size_t>(end - at) / 2 + 1;
+    };
+    
+    // Read header
+    std::getline(file, currentReplay.playerName);
+    
+    time_t date;
     long long duration;
-    file >> duration;
+    if (!(file >> date >> currentReplay.finalScore >> currentReplay.maxCombo >> duration)) return false;
+    currentReplay.date = std::chrono::system_clock::from_time_t(date);
     currentReplay.duration = std::chrono::milliseconds(duration);
     
     // Read moves
     size_t moveCount;
-    file >> moveCount;
+    if (!(file >> moveCount) || moveCount > numbersLeft()) return false;
     currentReplay.moves.resize(moveCount);
     for (size_t i = 0; i < moveCount; ++i) {
         int move;
-        file >> move;
+        if (!(file >> move)) return false;
         currentReplay.moves[i] = static_cast<Direction>(move);
     }
     
-    // Read states
+    // Read states: body size, food x and y, score, combo and timestamp at least
+    constexpr size_t STATE_NUMBERS = 6;
     size_t stateCount;
-    file >> stateCount;
+    if (!(file >> stateCount) || stateCount > numbersLeft() / STATE_NUMBERS) return false;
     currentReplay.states.resize(stateCount);
     for (auto& state : currentReplay.states) {
         size_t bodySize;
-        file >> bodySize;
-        state.snakeBody.resize(bodySize);
+        if (!(file >> bodySize) || bodySize > numbersLeft() / 2) return false;
+        state.snakeBody.clear();
         for (size_t i = 0; i < bodySize; ++i) {
-            file >> state.snakeBody[i].x >> state.snakeBody[i].y;
+            Point point;
+            if (!(file >> point.x >> point.y)) return false;
+            state.snakeBody.pushBack(point);
+        }
+        long long timestamp;
+        if (!(file >> state.foodPosition.x >> state.foodPosition.y >> state.score >> state.combo >> timestamp)) {
+            return false;
         }
-        file >> state.foodPosition.x >> state.foodPosition.y;
-        file >> state.score;
-        file >> state.combo;
-        
-        time_t timestamp;
-        file >> timestamp;
-        state.timestamp = std::chrono::steady_clock::from_time_t(timestamp);
+        state.timestamp = std::chrono::steady_clock::time_point(
+            std::chrono::milliseconds(timestamp));
     }
     
     return true;
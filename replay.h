@@ -3,24 +3,33 @@
 #include <vector>
 #include <string>
 #include <chrono>
-#include <deque>
+#include <istream>
+#include <memory>
 #include "point.h"
 #include "direction.h"
+#include "snake.h"
+#include "sim.h"
+#include "replay_v2.h"
+#include "input_replay.h"
+#include "replay_stream.h"
+#include "replay_library.h"
 
 namespace SnakeGame {
 
-struct GameState {
-    std::deque<Point> snakeBody;
-    Point foodPosition;
-    int score;
-    int combo;
-    std::chrono::steady_clock::time_point timestamp;
+enum class ReplayMode {
+    FRAMES,  // SNAKE_REPLAY_v2: every tick's state, delta encoded
+    INPUTS   // SNAKE_INPUTS_v1: seed, config and turns; frames are re-simulated
 };
 
+// states is filled by loadReplay; while recording, ticks go straight to the
+// compact delta encoder (or the input log) instead of being copied
 struct ReplayData {
+    ReplayMode mode;
+    InputLog inputLog;
     std::string playerName;
     std::chrono::system_clock::time_point date;
-    std::vector<GameState> states;
+    bool hasConfig;  // inputLog.config holds the rules the game was played under
+    std::vector<ReplayFrame> states;
     std::vector<Direction> moves;
     int finalScore;
     int maxCombo;
@@ -29,24 +38,62 @@ struct ReplayData {
 
 class ReplaySystem {
 public:
-    ReplaySystem();
+    explicit ReplaySystem(ReplayMode mode = ReplayMode::INPUTS);
+    // A clean shutdown discards an unfinished stream; only a crash leaves
+    // one behind for recovery
+    ~ReplaySystem();
     
-    void startRecording(const std::string& playerName);
+    void setMode(ReplayMode newMode) { mode = newMode; }
+    ReplayMode getMode() const { return mode; }
+    // Every successful saveReplay is recorded in the library, if one is set
+    void setLibrary(ReplayLibrary* replayLibrary) { library = replayLibrary; }
+    
+    // With a stream path, a FRAMES recording is appended to that file on a
+    // background thread as it goes instead of being held in memory
+    void startRecording(const std::string& playerName, const SimState& initial,
+                        const std::string& streamPath = std::string());
     void recordMove(Direction dir);
-    void recordState(const std::deque<Point>& snakeBody, const Point& foodPos, 
+    // Call right before step() with the input it is about to receive
+    void recordInput(const SimState& state, Direction input);
+    void recordState(const Snake& snake, const Point& foodPos, 
                     int score, int combo);
     void stopRecording();
     
-    bool saveReplay(const std::string& filename) const;
+    // Writes the recording's own format; loading accepts v1 text files too.
+    // Input replays are re-simulated on load and rejected if the final
+    // score does not come out the same.
+    // A streamed recording is finished and renamed by the writer thread
+    bool saveReplay(const std::string& filename);
     bool loadReplay(const std::string& filename);
+    // Drops a streamed recording that is not worth keeping
+    void discardRecording();
+    size_t getRecordedTicks() const { return encoder.tickCount(); }
     
     const ReplayData& getCurrentReplay() const { return currentReplay; }
     bool isRecording() const { return recording; }
     
 private:
     ReplayData currentReplay;
+    ReplayMode mode;
+    ReplayLibrary* library;
     bool recording;
     std::chrono::steady_clock::time_point startTime;
+    ReplayEncoder encoder;
+    std::unique_ptr<ReplayStreamWriter> stream;
+    std::vector<std::unique_ptr<ReplayStreamWriter>> retiredStreams;
+    uint64_t streamBlocksOffset;
+
+    void writeHeader(ByteWriter& out, const char* magic) const;
+    ReplaySummary summary(uint32_t totalTicks) const;
+    const GameConfig* configIfKnown() const;
+    ReplayInfo describe(const std::string& filename) const;
+    void streamBlocks();
+    void retireStream(const std::string& finalPath);
+    bool saveFrameReplay(const std::string& filename) const;
+    bool saveInputReplay(const std::string& filename) const;
+    bool loadReplayV1(std::istream& file);
+    bool loadReplayV2(const std::vector<uint8_t>& bytes);
+    bool loadInputReplay(const std::vector<uint8_t>& bytes);
 };
 
 } // namespace SnakeGame 
\ No newline at end of file
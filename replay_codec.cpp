@@ -0,0 +1,416 @@
+#include "replay_codec.h"
+#include "replay_format.h"
+
+namespace SnakeGame {
+namespace ReplayCodec {
+
+namespace {
+
+// Symbols by frequency, measured on synthetic games of several board
+// sizes: short runs and zero/one-cell steps, the plain move and eat tick
+// tokens, a score delta of 10. Every other symbol follows in numeric order.
+constexpr uint8_t HOT_SYMBOLS[] = {
+    0, 1, 2, 20, 3, 157, 6, 4, 5, 7, 129, 9, 8, 10, 11, 37,
+    13, 38, 12, 15, 14, 18, 16, 19, 17, 128, 193, 100, 22, 78, 21, 77
+};
+
+// Code lengths by frequency rank, close to a Huffman code for the same
+// games (within about 10% of their order-0 entropy). Kraft sum 0.96, so
+// the code is prefix-free with room to spare.
+struct CodeClass {
+    int firstRank;
+    int bits;
+};
+constexpr CodeClass CODE_CLASSES[] = {
+    {0, 3}, {1, 4}, {3, 5}, {10, 6}, {15, 7}, {29, 8}, {42, 9}, {85, 10}
+};
+constexpr int MAX_CODE_BITS = 10;
+
+struct PrefixCode {
+    uint16_t code[256];
+    uint8_t length[256];
+    // Indexed by the next MAX_CODE_BITS bits: symbol and code length
+    uint8_t symbol[1 << MAX_CODE_BITS];
+    uint8_t symbolLength[1 << MAX_CODE_BITS];
+
+    PrefixCode() : symbolLength() {
+        uint8_t byRank[256];
+        bool hot[256] = {};
+        int ranked = 0;
+        for (uint8_t s : HOT_SYMBOLS) {
+            byRank[ranked++] = s;
+            hot[s] = true;
+        }
+        for (int s = 0; s < 256; ++s) {
+            if (!hot[s]) byRank[ranked++] = static_cast<uint8_t>(s);
+        }
+
+        // Canonical assignment: ranks in order, codes counting up
+        size_t classes = sizeof(CODE_CLASSES) / sizeof(CODE_CLASSES[0]);
+        uint32_t next = 0;
+        int bits = CODE_CLASSES[0].bits;
+        for (size_t c = 0; c < classes; ++c) {
+            next <<= CODE_CLASSES[c].bits - bits;
+            bits = CODE_CLASSES[c].bits;
+            int last = (c + 1 < classes) ? CODE_CLASSES[c + 1].firstRank : 256;
+            for (int rank = CODE_CLASSES[c].firstRank; rank < last; ++rank) {
+                uint8_t s = byRank[rank];
+                code[s] = static_cast<uint16_t>(next);
+                length[s] = static_cast<uint8_t>(bits);
+                uint32_t first = next << (MAX_CODE_BITS - bits);
+                uint32_t count = 1u << (MAX_CODE_BITS - bits);
+                for (uint32_t i = 0; i < count; ++i) {
+                    symbol[first + i] = s;
+                    symbolLength[first + i] = static_cast<uint8_t>(bits);
+                }
+                ++next;
+            }
+        }
+    }
+};
+
+const PrefixCode& prefixCode() {
+    static const PrefixCode table;
+    return table;
+}
+
+// Token stream layout
+//
+//   keyframe  varint length, varint head x, varint head y,
+//             segments (steps from the previous cell), food, svarint score,
+//             svarint combo, svarint timestamp ms
+//   ticks     run tokens and tick tokens until tickCount - 1 ticks are covered
+//
+// A token below RUN_LIMIT is a run: bits 0-1 the direction, bits 2-6 the
+// length minus one. In the keyframe any other byte escapes a single
+// arbitrary step (svarint dx, svarint dy); among ticks it is a tick token
+// whose low bits say which fields follow, in the order of the v2 delta.
+constexpr uint8_t RUN_LIMIT = 0x80;
+constexpr uint32_t MAX_RUN = 32;
+constexpr uint8_t STEP_ESCAPE = 0x80;
+
+enum TickFlags : uint8_t {
+    TICK     = 0x80,
+    MOVE     = 0x01,  // step: head pushed, tail popped
+    SET      = 0x02,  // step: head moved in place
+    GROW     = 0x04,
+    FOOD     = 0x08,  // food cell
+    SCORE    = 0x10,  // svarint delta
+    COMBO    = 0x20,  // svarint
+    INTERVAL = 0x40   // varint ms
+};
+
+// Steps are taken per 16-bit axis, matching SnakeBody::pack, so they
+// wrap exactly like the packed cells do
+int16_t stepX(uint32_t from, uint32_t to) {
+    return static_cast<int16_t>(static_cast<uint16_t>((to & 0xFFFF) - (from & 0xFFFF)));
+}
+
+int16_t stepY(uint32_t from, uint32_t to) {
+    return static_cast<int16_t>(static_cast<uint16_t>((to >> 16) - (from >> 16)));
+}
+
+uint32_t applyStep(uint32_t from, int64_t dx, int64_t dy) {
+    uint16_t x = static_cast<uint16_t>((from & 0xFFFF) + dx);
+    uint16_t y = static_cast<uint16_t>((from >> 16) + dy);
+    return static_cast<uint32_t>(x) | (static_cast<uint32_t>(y) << 16);
+}
+
+// Direction codes share Direction's order: up, down, left, right
+constexpr int16_t UNIT_X[4] = {0, 0, -1, 1};
+constexpr int16_t UNIT_Y[4] = {-1, 1, 0, 0};
+
+int unitDirection(uint32_t from, uint32_t to) {
+    int16_t dx = stepX(from, to);
+    int16_t dy = stepY(from, to);
+    for (int d = 0; d < 4; ++d) {
+        if (dx == UNIT_X[d] && dy == UNIT_Y[d]) return d;
+    }
+    return -1;
+}
+
+void putStep(ByteWriter& out, uint32_t from, uint32_t to) {
+    out.svarint(stepX(from, to));
+    out.svarint(stepY(from, to));
+}
+
+uint32_t getStep(ByteReader& in, uint32_t from) {
+    int64_t dx = in.svarint();
+    int64_t dy = in.svarint();
+    return applyStep(from, dx, dy);
+}
+
+// Food is absolute: it jumps to a random cell. Zero means no food.
+void putFood(ByteWriter& out, uint32_t food) {
+    if (food == ReplayFormat::NO_FOOD) {
+        out.varint(0);
+        return;
+    }
+    out.varint((food & 0xFFFF) + 1);
+    out.varint(food >> 16);
+}
+
+uint32_t getFood(ByteReader& in) {
+    uint64_t x = in.varint();
+    if (x == 0) return ReplayFormat::NO_FOOD;
+    uint64_t y = in.varint();
+    return static_cast<uint32_t>(static_cast<uint16_t>(x - 1)) |
+           (static_cast<uint32_t>(static_cast<uint16_t>(y)) << 16);
+}
+
+// Collects unit steps in one direction into run tokens
+class RunWriter {
+public:
+    explicit RunWriter(ByteWriter& out) : out(out), direction(-1), length(0) {}
+
+    bool add(uint32_t from, uint32_t to) {
+        int d = unitDirection(from, to);
+        if (d < 0) return false;
+        if (d != direction || length == MAX_RUN) flush();
+        direction = d;
+        ++length;
+        return true;
+    }
+
+    void flush() {
+        if (length > 0) out.u8(static_cast<uint8_t>(((length - 1) << 2) | direction));
+        length = 0;
+        direction = -1;
+    }
+
+private:
+    ByteWriter& out;
+    int direction;
+    uint32_t length;
+};
+
+} // namespace
+
+bool compressBlock(const uint8_t* payload, size_t size, uint32_t tickCount,
+                   std::vector<uint8_t>& out) {
+    if (tickCount == 0) return false;
+
+    std::vector<uint8_t> tokens;
+    tokens.reserve(size);
+    ByteWriter token(tokens);
+    ByteReader in(payload, size);
+
+    // Keyframe
+    uint32_t length = in.u32();
+    if (length > in.remaining() / sizeof(uint32_t)) return false;
+    token.varint(length);
+    uint32_t head = 0;
+    if (length > 0) {
+        head = in.u32();
+        token.varint(head & 0xFFFF);
+        token.varint(head >> 16);
+
+        RunWriter runs(token);
+        uint32_t previous = head;
+        for (uint32_t i = 1; i < length; ++i) {
+            uint32_t cell = in.u32();
+            if (!runs.add(previous, cell)) {
+                runs.flush();
+                token.u8(STEP_ESCAPE);
+                putStep(token, previous, cell);
+            }
+            previous = cell;
+        }
+        runs.flush();
+    }
+    putFood(token, in.u32());
+    token.svarint(in.i32());
+    token.svarint(in.i32());
+    token.svarint(in.i64());
+
+    // Deltas
+    RunWriter runs(token);
+    for (uint32_t i = 1; i < tickCount; ++i) {
+        uint8_t flags = in.u8();
+        bool push = (flags & ReplayFormat::HEAD_PUSH) != 0;
+        bool set = (flags & ReplayFormat::HEAD_SET) != 0;
+        if (push != ((flags & ReplayFormat::TAIL_POP) != 0) || (push && set)) return false;
+
+        uint32_t cell = (push || set) ? in.u32() : head;
+        if (flags == (ReplayFormat::HEAD_PUSH | ReplayFormat::TAIL_POP) && runs.add(head, cell)) {
+            head = cell;
+            continue;
+        }
+        runs.flush();
+
+        uint8_t tick = TICK;
+        if (push) tick |= MOVE;
+        if (set) tick |= SET;
+        if (flags & ReplayFormat::TAIL_DUP) tick |= GROW;
+        if (flags & ReplayFormat::FOOD) tick |= FOOD;
+        if (flags & ReplayFormat::SCORE) tick |= SCORE;
+        if (flags & ReplayFormat::COMBO) tick |= COMBO;
+        if (flags & ReplayFormat::INTERVAL) tick |= INTERVAL;
+        token.u8(tick);
+
+        if (push || set) putStep(token, head, cell);
+        if (flags & ReplayFormat::FOOD) putFood(token, in.u32());
+        if (flags & ReplayFormat::SCORE) token.svarint(in.i32());
+        if (flags & ReplayFormat::COMBO) token.svarint(in.i32());
+        if (flags & ReplayFormat::INTERVAL) token.varint(in.u32());
+        head = cell;
+    }
+    runs.flush();
+    if (!in.ok() || in.remaining() != 0) return false;
+
+    out.clear();
+    ByteWriter header(out);
+    header.varint(tokens.size());
+    entropyEncode(tokens.data(), tokens.size(), out);
+    return true;
+}
+
+bool expandBlock(const uint8_t* data, size_t size, uint32_t tickCount,
+                 std::vector<uint8_t>& out) {
+    if (tickCount == 0) return false;
+
+    ByteReader header(data, size);
+    uint64_t tokenCount = header.varint();
+    // Every token costs at least three bits
+    if (!header.ok() || tokenCount > header.remaining() * 8 / 3) return false;
+    std::vector<uint8_t> tokens;
+    if (!entropyDecode(header.position(), header.remaining(), static_cast<size_t>(tokenCount), tokens)) {
+        return false;
+    }
+
+    ByteReader in(tokens.data(), tokens.size());
+    out.clear();
+    ByteWriter payload(out);
+
+    // Keyframe; a run token covers at most MAX_RUN segments
+    uint64_t length = in.varint();
+    if (length > 1 + static_cast<uint64_t>(in.remaining()) * MAX_RUN) return false;
+    out.reserve(static_cast<size_t>(length) * 4 + 32 + tickCount * 5);
+    payload.u32(static_cast<uint32_t>(length));
+    uint32_t head = 0;
+    if (length > 0) {
+        uint64_t x = in.varint();
+        uint64_t y = in.varint();
+        head = static_cast<uint32_t>(static_cast<uint16_t>(x)) |
+               (static_cast<uint32_t>(static_cast<uint16_t>(y)) << 16);
+        payload.u32(head);
+
+        uint32_t cell = head;
+        for (uint64_t written = 1; written < length;) {
+            uint8_t t = in.u8();
+            if (!in.ok()) return false;
+            if (t == STEP_ESCAPE) {
+                cell = getStep(in, cell);
+                payload.u32(cell);
+                ++written;
+                continue;
+            }
+            if (t > STEP_ESCAPE) return false;
+            uint32_t run = (t >> 2) + 1u;
+            if (written + run > length) return false;
+            for (uint32_t i = 0; i < run; ++i) {
+                cell = applyStep(cell, UNIT_X[t & 3], UNIT_Y[t & 3]);
+                payload.u32(cell);
+            }
+            written += run;
+        }
+    }
+    payload.u32(getFood(in));
+    payload.i32(static_cast<int32_t>(in.svarint()));
+    payload.i32(static_cast<int32_t>(in.svarint()));
+    payload.i64(in.svarint());
+
+    // Deltas
+    for (uint32_t done = 1; done < tickCount;) {
+        uint8_t t = in.u8();
+        if (!in.ok()) return false;
+
+        if (t < RUN_LIMIT) {
+            uint32_t run = (t >> 2) + 1u;
+            if (run > tickCount - done) return false;
+            for (uint32_t i = 0; i < run; ++i) {
+                head = applyStep(head, UNIT_X[t & 3], UNIT_Y[t & 3]);
+                payload.u8(ReplayFormat::HEAD_PUSH | ReplayFormat::TAIL_POP);
+                payload.u32(head);
+            }
+            done += run;
+            continue;
+        }
+
+        if ((t & MOVE) && (t & SET)) return false;
+        uint8_t flags = 0;
+        if (t & MOVE) flags |= ReplayFormat::HEAD_PUSH | ReplayFormat::TAIL_POP;
+        if (t & SET) flags |= ReplayFormat::HEAD_SET;
+        if (t & GROW) flags |= ReplayFormat::TAIL_DUP;
+        if (t & FOOD) flags |= ReplayFormat::FOOD;
+        if (t & SCORE) flags |= ReplayFormat::SCORE;
+        if (t & COMBO) flags |= ReplayFormat::COMBO;
+        if (t & INTERVAL) flags |= ReplayFormat::INTERVAL;
+        payload.u8(flags);
+
+        if (t & (MOVE | SET)) {
+            head = getStep(in, head);
+            payload.u32(head);
+        }
+        if (t & FOOD) payload.u32(getFood(in));
+        if (t & SCORE) payload.i32(static_cast<int32_t>(in.svarint()));
+        if (t & COMBO) payload.i32(static_cast<int32_t>(in.svarint()));
+        if (t & INTERVAL) payload.u32(static_cast<uint32_t>(in.varint()));
+        ++done;
+    }
+    return in.ok() && in.remaining() == 0;
+}
+
+void entropyEncode(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    const PrefixCode& table = prefixCode();
+    out.reserve(out.size() + size / 2 + 8);
+
+    // Codes are written most significant bit first
+    uint64_t bits = 0;
+    int pending = 0;
+    for (size_t i = 0; i < size; ++i) {
+        bits = (bits << table.length[data[i]]) | table.code[data[i]];
+        pending += table.length[data[i]];
+        while (pending >= 8) {
+            pending -= 8;
+            out.push_back(static_cast<uint8_t>(bits >> pending));
+        }
+    }
+    if (pending > 0) out.push_back(static_cast<uint8_t>(bits << (8 - pending)));
+}
+
+bool entropyDecode(const uint8_t* data, size_t size, size_t count, std::vector<uint8_t>& out) {
+    const PrefixCode& table = prefixCode();
+    out.resize(count);
+
+    // The tail is padded with zero bits; a valid stream never reads into them
+    uint64_t bits = 0;
+    int available = 0;
+    size_t position = 0;
+    uint64_t padding = 0;
+    for (size_t i = 0; i < count; ++i) {
+        while (available < MAX_CODE_BITS) {
+            uint8_t byte = 0;
+            if (position < size) {
+                byte = data[position++];
+            } else {
+                ++padding;
+            }
+            bits = (bits << 8) | byte;
+            available += 8;
+        }
+        uint32_t peek = static_cast<uint32_t>(bits >> (available - MAX_CODE_BITS)) &
+                        ((1u << MAX_CODE_BITS) - 1);
+        int length = table.symbolLength[peek];
+        if (length == 0) return false;
+        out[i] = table.symbol[peek];
+        available -= length;
+        if (static_cast<uint64_t>(available) < padding * 8) return false;
+    }
+    // Nothing but padding may follow the last code
+    uint64_t leftover = (size - position) * 8 + static_cast<uint64_t>(available) - padding * 8;
+    return leftover < 8;
+}
+
+} // namespace ReplayCodec
+} // namespace SnakeGame
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SnakeGame {
+
+// Lossless compression of v2 block payloads, stored under
+// ReplayFormat::COMPACT_BLOCK_MAGIC.
+//
+// The payload is first rewritten as a token stream. Cells become zigzag
+// varint steps from the previous cell, and consecutive unit steps in one
+// direction (straight stretches of the body, ticks where the snake simply
+// moved on) collapse into a single run token. The tokens are mostly small
+// bytes, so a fixed prefix code then stores the most common ones in 3 or
+// 4 bits.
+//
+// Compact payload: varint token count, then the prefix-coded tokens.
+namespace ReplayCodec {
+
+// Returns false when the payload is malformed or uses a delta the token
+// stream cannot express; the caller keeps the plain payload then
+bool compressBlock(const uint8_t* payload, size_t size, uint32_t tickCount,
+                   std::vector<uint8_t>& out);
+// Rebuilds the plain payload byte for byte
+bool expandBlock(const uint8_t* data, size_t size, uint32_t tickCount,
+                 std::vector<uint8_t>& out);
+
+// The static prefix code on its own; appends to out
+void entropyEncode(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+// Decodes exactly count symbols into out (replacing its contents)
+bool entropyDecode(const uint8_t* data, size_t size, size_t count, std::vector<uint8_t>& out);
+
+} // namespace ReplayCodec
+
+} // namespace SnakeGame
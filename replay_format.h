@@ -0,0 +1,226 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "constants.h"
+#include "point.h"
+#include "snake_body.h"
+
+namespace SnakeGame {
+
+// One recorded tick as seen on screen
+struct ReplayFrame {
+    SnakeBody snakeBody;
+    Point foodPosition;
+    int score;
+    int combo;
+    std::chrono::steady_clock::time_point timestamp;
+};
+
+// On-disk layout of SNAKE_REPLAY_v2 (all integers little-endian):
+//
+//   header   "SNAKE_REPLAY_v2\n", u16 name length, name bytes, i64 date,
+//            then in streamed files u32 CONFIG_MAGIC and the config, so a
+//            file recovered without its trailer still has it
+//   block*   u32 BLOCK_MAGIC, u32 first tick, u32 tick count,
+//            u32 payload size, payload, u32 payload checksum
+//   trailer  u32 TRAILER_MAGIC, i32 final score, i32 max combo,
+//            i64 duration ms, u32 total ticks, u32 block count,
+//            u32 move count, u8 move per entry, u8 has config (0 or 1),
+//            config (see writeGameConfig) when it is 1
+//   index    u32 INDEX_MAGIC, u32 entry count,
+//            per block: u32 first tick, u64 file offset of the block
+//   footer   u64 trailer offset, u64 index offset, u32 FOOTER_MAGIC
+//
+// The fixed-size footer lets a reader find everything else from the end
+// of the file without scanning; files saved before the index existed end
+// after the trailer and are read sequentially instead, and files from
+// before configs were recorded end the trailer after the moves.
+//
+// A block payload starts with a keyframe (the full state of its first
+// tick) followed by one delta per remaining tick; see replay_v2.h. Blocks
+// tagged COMPACT_BLOCK_MAGIC hold the same payload run through the codec
+// in replay_codec.h; the checksum covers the stored bytes either way.
+//
+// SNAKE_INPUTS_v1 shares the header, then holds an InputLog (see
+// input_replay.h), i32 final score, i32 max combo, i64 duration ms and a
+// u32 checksum of everything after the magic line.
+namespace ReplayFormat {
+
+constexpr char MAGIC_V1[] = "SNAKE_REPLAY_v1";
+constexpr char MAGIC_V2[] = "SNAKE_REPLAY_v2";
+constexpr char MAGIC_INPUTS[] = "SNAKE_INPUTS_v1";
+constexpr uint32_t BLOCK_MAGIC = 0x324B4C42;    // "BLK2"
+constexpr uint32_t COMPACT_BLOCK_MAGIC = 0x434B4C42;  // "BLKC"
+constexpr uint32_t TRAILER_MAGIC = 0x32444E45;  // "END2"
+constexpr uint32_t INDEX_MAGIC = 0x32584449;    // "IDX2"
+constexpr uint32_t FOOTER_MAGIC = 0x32525446;   // "FTR2"
+constexpr uint32_t CONFIG_MAGIC = 0x32474643;   // "CFG2"
+constexpr size_t INDEX_ENTRY_SIZE = 12;
+constexpr size_t FOOTER_SIZE = 20;
+constexpr size_t BLOCK_HEADER_SIZE = 16;
+constexpr uint32_t NO_FOOD = 0xFFFFFFFF;        // food cell when the board is full
+
+// Per-tick delta flags; optional fields follow in flag order
+enum DeltaFlags : uint8_t {
+    HEAD_PUSH = 0x01,  // u32 packed cell: new head pushed on the front
+    HEAD_SET  = 0x02,  // u32 packed cell: head moved in place (teleport)
+    TAIL_POP  = 0x04,  // tail segment removed
+    TAIL_DUP  = 0x08,  // tail segment duplicated (growth)
+    FOOD      = 0x10,  // u32 packed cell: food moved
+    SCORE     = 0x20,  // i32 score delta
+    COMBO     = 0x40,  // i32 new combo
+    INTERVAL  = 0x80   // u32 ms between ticks, when it changes
+};
+
+inline bool isBlockMagic(uint32_t magic) {
+    return magic == BLOCK_MAGIC || magic == COMPACT_BLOCK_MAGIC;
+}
+
+// FNV-1a, used to detect torn or corrupted blocks
+inline uint32_t checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+} // namespace ReplayFormat
+
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    size_t size() const { return out.size(); }
+
+    void u8(uint8_t v) { out.push_back(v); }
+    void u16(uint16_t v) { putLE(v, 2); }
+    void u32(uint32_t v) { putLE(v, 4); }
+    void u64(uint64_t v) { putLE(v, 8); }
+    void i32(int32_t v) { u32(static_cast<uint32_t>(v)); }
+    void i64(int64_t v) { u64(static_cast<uint64_t>(v)); }
+    // LEB128: seven bits per byte, low bits first
+    void varint(uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+    // Zigzag first, so small negative values stay short too
+    void svarint(int64_t v) {
+        varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    }
+    void bytes(const void* data, size_t size) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), p, p + size);
+    }
+
+private:
+    std::vector<uint8_t>& out;
+
+    void putLE(uint64_t v, int size) {
+        for (int i = 0; i < size; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+};
+
+// Bounds-checked reader; once a read runs past the end every later read
+// returns zero and ok() turns false
+class ByteReader {
+public:
+    ByteReader() : cursor(nullptr), end(nullptr), valid(false) {}
+    ByteReader(const uint8_t* data, size_t size) : cursor(data), end(data + size), valid(true) {}
+
+    uint8_t u8() { return static_cast<uint8_t>(getLE(1)); }
+    uint16_t u16() { return static_cast<uint16_t>(getLE(2)); }
+    uint32_t u32() { return static_cast<uint32_t>(getLE(4)); }
+    uint64_t u64() { return getLE(8); }
+    int32_t i32() { return static_cast<int32_t>(u32()); }
+    int64_t i64() { return static_cast<int64_t>(u64()); }
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (!take(1)) return 0;
+            uint8_t byte = cursor[-1];
+            v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return v;
+        }
+        valid = false;
+        return 0;
+    }
+    int64_t svarint() {
+        uint64_t v = varint();
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+    const uint8_t* bytes(size_t size) {
+        if (!take(size)) return nullptr;
+        const uint8_t* p = cursor - size;
+        return p;
+    }
+
+    bool ok() const { return valid; }
+    size_t remaining() const { return static_cast<size_t>(end - cursor); }
+    const uint8_t* position() const { return cursor; }
+
+private:
+    const uint8_t* cursor;
+    const uint8_t* end;
+    bool valid;
+
+    bool take(size_t size) {
+        if (!valid || remaining() < size) {
+            valid = false;
+            return false;
+        }
+        cursor += size;
+        return true;
+    }
+    uint64_t getLE(int size) {
+        if (!take(size)) return 0;
+        uint64_t v = 0;
+        for (int i = 0; i < size; ++i) v |= static_cast<uint64_t>(cursor[i - size]) << (8 * i);
+        return v;
+    }
+};
+
+// The rules a game was played under, as stored by input logs and v2 trailers
+inline void writeGameConfig(ByteWriter& out, const GameConfig& config) {
+    out.i32(config.width);
+    out.i32(config.height);
+    out.u32(static_cast<uint32_t>(config.initialSpeed.count()));
+    out.u8(config.wrapAround);
+    out.u8(config.hardcoreMode);
+    out.u8(config.enableAnimations);
+    out.u8(config.enableSpecialFood);
+    out.u8(static_cast<uint8_t>(config.mode));
+    out.u8(static_cast<uint8_t>(config.difficulty));
+}
+
+inline bool readGameConfig(ByteReader& in, GameConfig& config) {
+    config.width = in.i32();
+    config.height = in.i32();
+    config.initialSpeed = std::chrono::milliseconds(in.u32());
+    config.wrapAround = in.u8() != 0;
+    config.hardcoreMode = in.u8() != 0;
+    config.enableAnimations = in.u8() != 0;
+    config.enableSpecialFood = in.u8() != 0;
+    config.mode = static_cast<GameMode>(in.u8());
+    config.difficulty = static_cast<Difficulty>(in.u8());
+    return in.ok();
+}
+
+// The config a streamed v2 header may carry; found stays false for files
+// without one, and false comes back only for one cut short
+inline bool readHeaderConfig(ByteReader& in, GameConfig& config, bool& found) {
+    ByteReader peek = in;
+    found = peek.u32() == ReplayFormat::CONFIG_MAGIC && peek.ok();
+    if (!found) return true;
+    in.u32();
+    return readGameConfig(in, config);
+}
+
+} // namespace SnakeGame
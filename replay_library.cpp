@@ -0,0 +1,394 @@
+#include "replay_library.h"
+#include "mapped_file.h"
+#include "replay_format.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace SnakeGame {
+
+namespace {
+
+constexpr char LIBRARY_MAGIC[] = "SNAKE_LIBRARY_v1";
+constexpr char INDEX_FILE[] = "library.idx";
+
+// Superseded records tolerated on top of the live ones before a rewrite
+constexpr size_t COMPACT_SLACK = 256;
+
+enum RecordType : uint8_t {
+    RECORD_ADD = 1,
+    RECORD_REMOVE = 2
+};
+
+bool hasMagic(const uint8_t* data, size_t size, const char* magic) {
+    size_t length = std::strlen(magic);
+    return size > length && std::memcmp(data, magic, length) == 0 && data[length] == '\n';
+}
+
+void putString(ByteWriter& out, const std::string& s) {
+    size_t length = std::min<size_t>(s.size(), 0xFFFF);
+    out.u16(static_cast<uint16_t>(length));
+    out.bytes(s.data(), length);
+}
+
+std::string getString(ByteReader& in) {
+    uint16_t length = in.u16();
+    const uint8_t* data = in.bytes(length);
+    if (!data) return std::string();
+    return std::string(reinterpret_cast<const char*>(data), length);
+}
+
+// Name and date, shared by the binary formats
+bool readBinaryHeader(ByteReader& in, ReplayInfo& info) {
+    info.playerName = getString(in);
+    info.date = in.i64();
+    return in.ok();
+}
+
+bool readFramesInfo(const uint8_t* data, size_t size, ReplayInfo& info) {
+    size_t start = std::strlen(ReplayFormat::MAGIC_V2) + 1;
+    ByteReader header(data + start, size - start);
+    if (!readBinaryHeader(header, info)) return false;
+    if (!readHeaderConfig(header, info.config, info.hasConfig)) return false;
+    size_t headerEnd = static_cast<size_t>(header.position() - data);
+
+    // The footer points at the trailer; older files are walked block by block
+    size_t trailerOffset = 0;
+    size_t trailerEnd = size;
+    if (size >= headerEnd + ReplayFormat::FOOTER_SIZE) {
+        ByteReader footer(data + size - ReplayFormat::FOOTER_SIZE, ReplayFormat::FOOTER_SIZE);
+        uint64_t trailer = footer.u64();
+        uint64_t index = footer.u64();
+        if (footer.u32() == ReplayFormat::FOOTER_MAGIC && trailer >= headerEnd && trailer < index &&
+            index < size) {
+            trailerOffset = static_cast<size_t>(trailer);
+            trailerEnd = static_cast<size_t>(index);
+        }
+    }
+    if (trailerOffset == 0) {
+        ByteReader scan(data + headerEnd, size - headerEnd);
+        for (;;) {
+            ByteReader peek = scan;
+            if (!ReplayFormat::isBlockMagic(peek.u32()) || !peek.ok()) break;
+            scan.bytes(12);
+            scan.bytes(scan.u32());
+            scan.u32();
+            if (!scan.ok()) return false;
+        }
+        trailerOffset = static_cast<size_t>(scan.position() - data);
+    }
+
+    ByteReader trailer(data + trailerOffset, trailerEnd - trailerOffset);
+    if (trailer.u32() != ReplayFormat::TRAILER_MAGIC) return false;
+    info.finalScore = trailer.i32();
+    info.maxCombo = trailer.i32();
+    info.durationMs = trailer.i64();
+    info.totalTicks = trailer.u32();
+    trailer.u32();  // blocks
+    trailer.bytes(trailer.u32());  // moves
+    if (!trailer.ok()) return false;
+
+    info.format = ReplayFileFormat::FRAMES_V2;
+    ByteReader peek = trailer;
+    if (peek.u8() == 1) {
+        trailer.u8();
+        info.hasConfig = readGameConfig(trailer, info.config);
+    }
+    return true;
+}
+
+bool readInputsInfo(const uint8_t* data, size_t size, ReplayInfo& info) {
+    size_t start = std::strlen(ReplayFormat::MAGIC_INPUTS) + 1;
+    ByteReader in(data + start, size - start);
+    if (!readBinaryHeader(in, info)) return false;
+
+    // The log opens with the rules; the outcome sits just before the checksum
+    in.u32();  // seed
+    info.hasConfig = readGameConfig(in, info.config);
+    in.u8();   // portals
+    in.u32();  // initial period
+    info.totalTicks = in.u32();
+    if (!in.ok() || in.remaining() < 20) return false;
+
+    ByteReader tail(data + size - 20, 16);
+    info.finalScore = tail.i32();
+    info.maxCombo = tail.i32();
+    info.durationMs = tail.i64();
+    info.format = ReplayFileFormat::INPUTS;
+    return tail.ok();
+}
+
+bool readTextInfo(const uint8_t* data, size_t size, ReplayInfo& info) {
+    // The header is the first few lines; the frames are never reached
+    std::istringstream in(std::string(reinterpret_cast<const char*>(data), std::min<size_t>(size, 4096)));
+    std::string magic;
+    std::getline(in, magic);
+    std::getline(in, info.playerName);
+    long long date = 0;
+    long long duration = 0;
+    in >> date >> info.finalScore >> info.maxCombo >> duration;
+    info.date = date;
+    info.durationMs = duration;
+    info.totalTicks = 0;
+    info.format = ReplayFileFormat::TEXT_V1;
+    info.hasConfig = false;
+    return static_cast<bool>(in);
+}
+
+std::vector<uint8_t> encodeAdd(const ReplayInfo& info) {
+    std::vector<uint8_t> record;
+    ByteWriter out(record);
+    out.u8(RECORD_ADD);
+    putString(out, info.file);
+    putString(out, info.playerName);
+    out.i64(info.date);
+    out.i32(info.finalScore);
+    out.i32(info.maxCombo);
+    out.i64(info.durationMs);
+    out.u32(info.totalTicks);
+    out.u8(static_cast<uint8_t>(info.format));
+    out.u8(info.hasConfig);
+    if (info.hasConfig) writeGameConfig(out, info.config);
+    return record;
+}
+
+std::vector<uint8_t> encodeRemove(const std::string& file) {
+    std::vector<uint8_t> record;
+    ByteWriter out(record);
+    out.u8(RECORD_REMOVE);
+    putString(out, file);
+    return record;
+}
+
+void frameRecord(ByteWriter& out, const std::vector<uint8_t>& record) {
+    out.u32(static_cast<uint32_t>(record.size()));
+    out.bytes(record.data(), record.size());
+    out.u32(ReplayFormat::checksum(record.data(), record.size()));
+}
+
+} // namespace
+
+bool readReplayInfo(const std::string& path, ReplayInfo& info) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    const uint8_t* data = file.data();
+    size_t size = file.size();
+    if (hasMagic(data, size, ReplayFormat::MAGIC_V2)) return readFramesInfo(data, size, info);
+    if (hasMagic(data, size, ReplayFormat::MAGIC_INPUTS)) return readInputsInfo(data, size, info);
+    if (hasMagic(data, size, ReplayFormat::MAGIC_V1)) return readTextInfo(data, size, info);
+    return false;
+}
+
+ReplayLibrary::ReplayLibrary(const std::string& directory)
+    : directory(directory)
+    , indexPath((std::filesystem::path(directory) / INDEX_FILE).string())
+    , records(0) {
+}
+
+void ReplayLibrary::open() {
+    if (!load()) rebuild();
+}
+
+bool ReplayLibrary::rebuild() {
+    entries.clear();
+    keys.clear();
+    byFile.clear();
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.path().extension() != ".replay") continue;
+        ReplayInfo info;
+        if (readReplayInfo(entry.path().string(), info)) {
+            info.file = entry.path().filename().string();
+            put(info);
+        }
+    }
+    return save();
+}
+
+bool ReplayLibrary::add(const ReplayInfo& info) {
+    ReplayInfo entry = info;
+    entry.file = std::filesystem::path(info.file).filename().string();
+    put(entry);
+    return append(encodeAdd(entry));
+}
+
+bool ReplayLibrary::addFile(const std::string& path) {
+    ReplayInfo info;
+    if (!readReplayInfo(path, info)) return false;
+    info.file = path;
+    return add(info);
+}
+
+bool ReplayLibrary::remove(const std::string& file) {
+    if (byFile.find(file) == byFile.end()) return false;
+    erase(file);
+    return append(encodeRemove(file));
+}
+
+std::vector<const ReplayInfo*> ReplayLibrary::query(const ReplayQuery& query) const {
+    std::vector<uint32_t> matches;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const Key& key = keys[i];
+        if (key.score < query.minScore || key.combo < query.minCombo) continue;
+        if (!query.playerName.empty() && entries[i].playerName != query.playerName) continue;
+        matches.push_back(static_cast<uint32_t>(i));
+    }
+
+    auto before = [&](uint32_t a, uint32_t b) {
+        const Key& x = keys[a];
+        const Key& y = keys[b];
+        switch (query.order) {
+            case ReplayOrder::DATE:
+                if (x.date != y.date) return x.date > y.date;
+                break;
+            case ReplayOrder::DURATION:
+                if (x.durationMs != y.durationMs) return x.durationMs > y.durationMs;
+                break;
+            default:
+                break;
+        }
+        if (x.score != y.score) return x.score > y.score;
+        return x.date > y.date;
+    };
+    size_t count = std::min(query.limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + count, matches.end(), before);
+
+    std::vector<const ReplayInfo*> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        result.push_back(&entries[matches[i]]);
+    }
+    return result;
+}
+
+std::string ReplayLibrary::pathOf(const ReplayInfo& info) const {
+    return (std::filesystem::path(directory) / info.file).string();
+}
+
+bool ReplayLibrary::load() {
+    entries.clear();
+    keys.clear();
+    byFile.clear();
+    records = 0;
+
+    MappedFile file;
+    if (!file.open(indexPath) || !hasMagic(file.data(), file.size(), LIBRARY_MAGIC)) return false;
+
+    size_t start = std::strlen(LIBRARY_MAGIC) + 1;
+    ByteReader in(file.data() + start, file.size() - start);
+    bool torn = false;
+    while (in.remaining() > 0) {
+        uint32_t size = in.u32();
+        const uint8_t* data = in.bytes(size);
+        uint32_t sum = in.u32();
+        if (!in.ok() || sum != ReplayFormat::checksum(data, size)) {
+            torn = true;
+            break;
+        }
+
+        ByteReader record(data, size);
+        uint8_t type = record.u8();
+        ReplayInfo info;
+        info.file = getString(record);
+        if (type == RECORD_REMOVE) {
+            erase(info.file);
+        } else if (type == RECORD_ADD) {
+            info.playerName = getString(record);
+            info.date = record.i64();
+            info.finalScore = record.i32();
+            info.maxCombo = record.i32();
+            info.durationMs = record.i64();
+            info.totalTicks = record.u32();
+            info.format = static_cast<ReplayFileFormat>(record.u8());
+            info.hasConfig = record.u8() != 0;
+            if (info.hasConfig) readGameConfig(record, info.config);
+            if (!record.ok()) {
+                torn = true;
+                break;
+            }
+            put(info);
+        }
+        ++records;
+    }
+
+    // Drop a half-written record so later appends follow a clean log
+    file.close();
+    if (torn) return save();
+    return true;
+}
+
+bool ReplayLibrary::save() {
+    std::vector<uint8_t> bytes;
+    ByteWriter out(bytes);
+    out.bytes(LIBRARY_MAGIC, std::strlen(LIBRARY_MAGIC));
+    out.u8('\n');
+    for (const auto& info : entries) {
+        frameRecord(out, encodeAdd(info));
+    }
+
+    // Written aside and renamed, so a crash leaves the old index intact
+    std::string temporary = indexPath + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        if (!file) return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, indexPath, error);
+    if (error) return false;
+    records = entries.size();
+    return true;
+}
+
+bool ReplayLibrary::append(const std::vector<uint8_t>& record) {
+    if (records >= entries.size() * 2 + COMPACT_SLACK) return save();
+
+    std::error_code error;
+    if (!std::filesystem::exists(indexPath, error)) return save();
+
+    std::vector<uint8_t> bytes;
+    ByteWriter out(bytes);
+    frameRecord(out, record);
+    std::ofstream file(indexPath, std::ios::binary | std::ios::app);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    if (!file) return false;
+    ++records;
+    return true;
+}
+
+void ReplayLibrary::put(const ReplayInfo& info) {
+    Key key = {info.finalScore, info.maxCombo, info.date, info.durationMs};
+    auto found = byFile.find(info.file);
+    if (found != byFile.end()) {
+        entries[found->second] = info;
+        keys[found->second] = key;
+        return;
+    }
+    byFile.emplace(info.file, entries.size());
+    entries.push_back(info);
+    keys.push_back(key);
+}
+
+void ReplayLibrary::erase(const std::string& file) {
+    auto found = byFile.find(file);
+    if (found == byFile.end()) return;
+
+    // Swap with the last entry so removal stays constant time
+    size_t index = found->second;
+    byFile.erase(found);
+    if (index + 1 != entries.size()) {
+        entries[index] = std::move(entries.back());
+        keys[index] = keys.back();
+        byFile[entries[index].file] = index;
+    }
+    entries.pop_back();
+    keys.pop_back();
+}
+
+} // namespace SnakeGame
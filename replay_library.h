@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "constants.h"
+
+namespace SnakeGame {
+
+enum class ReplayFileFormat : uint8_t {
+    TEXT_V1,
+    FRAMES_V2,
+    INPUTS
+};
+
+// What the replay menu needs to know about a saved game
+struct ReplayInfo {
+    std::string file;        // name inside the library directory
+    std::string playerName;
+    int64_t date;            // seconds since the epoch
+    int finalScore;
+    int maxCombo;
+    int64_t durationMs;
+    uint32_t totalTicks;     // 0 when the format does not say
+    ReplayFileFormat format;
+    bool hasConfig;          // older frame replays lack it
+    GameConfig config;
+};
+
+// Fills info from a replay's header, trailer and footer without decoding
+// any frames or checking the body. info.file is left as it was.
+bool readReplayInfo(const std::string& path, ReplayInfo& info);
+
+enum class ReplayOrder {
+    SCORE,
+    DATE,
+    DURATION
+};
+
+struct ReplayQuery {
+    int minScore = 0;
+    int minCombo = 0;
+    std::string playerName;  // empty matches everyone
+    ReplayOrder order = ReplayOrder::SCORE;  // best, newest or longest first
+    size_t limit = 50;
+};
+
+// Persistent catalogue of the replays in one directory, kept in
+// <directory>/library.idx so the menu never walks the directory or opens a
+// replay to list it.
+//
+// The index file is an append-only log of checksummed records: saving a
+// replay appends one, and loading replays the log, later records replacing
+// earlier ones for the same file. A torn record at the end (a crash while
+// appending) is dropped. The log is rewritten once superseded records
+// outnumber live ones.
+class ReplayLibrary {
+public:
+    explicit ReplayLibrary(const std::string& directory);
+
+    // Loads the index, rebuilding it from the replay headers when it is
+    // missing or unreadable
+    void open();
+    // Forgets the index and re-reads the header of every replay on disk
+    bool rebuild();
+
+    // Records a replay saved into the directory; only the file name of
+    // info.file is kept
+    bool add(const ReplayInfo& info);
+    // Same, reading the replay's headers first
+    bool addFile(const std::string& path);
+    bool remove(const std::string& file);
+
+    // The pointers stay valid until the library next changes
+    std::vector<const ReplayInfo*> query(const ReplayQuery& query) const;
+    size_t size() const { return entries.size(); }
+    std::string pathOf(const ReplayInfo& info) const;
+
+private:
+    // The fields queries filter and sort on, packed for scanning
+    struct Key {
+        int score;
+        int combo;
+        int64_t date;
+        int64_t durationMs;
+    };
+
+    std::string directory;
+    std::string indexPath;
+    std::vector<ReplayInfo> entries;
+    std::vector<Key> keys;
+    std::unordered_map<std::string, size_t> byFile;
+    size_t records;  // in the log, live or superseded
+
+    bool load();
+    bool save();
+    bool append(const std::vector<uint8_t>& record);
+    void put(const ReplayInfo& info);
+    void erase(const std::string& file);
+};
+
+} // namespace SnakeGame
@@ -0,0 +1,329 @@
+#include "replay_reader.h"
+#include "replay.h"
+#include <algorithm>
+#include <cstring>
+
+namespace SnakeGame {
+
+namespace {
+
+bool hasMagic(const MappedFile& file, const char* magic) {
+    size_t length = std::strlen(magic);
+    return file.size() > length &&
+           std::memcmp(file.data(), magic, length) == 0 &&
+           file.data()[length] == '\n';
+}
+
+// Reads the header shared by all binary formats; returns the offset past it
+size_t readHeader(const MappedFile& file, const char* magic, std::string& playerName) {
+    size_t start = std::strlen(magic) + 1;
+    ByteReader in(file.data() + start, file.size() - start);
+    uint16_t nameLength = in.u16();
+    const uint8_t* name = in.bytes(nameLength);
+    in.i64();  // date
+    if (!in.ok()) return 0;
+    playerName.assign(reinterpret_cast<const char*>(name), nameLength);
+    return static_cast<size_t>(in.position() - file.data());
+}
+
+// Heap and inline bytes a copy of the state holds; the occupancy grid and
+// its free-cell index dominate on large boards
+size_t stateBytes(const SimState& state) {
+    return sizeof(SimState) + state.snake.getOccupancy().memoryBytes() +
+           state.snake.getBody().capacity() * sizeof(uint32_t) + state.portals.capacity() * sizeof(Portal);
+}
+
+} // namespace
+
+ReplayReader::ReplayReader() {
+    close();
+}
+
+void ReplayReader::close() {
+    file.close();
+    source = Source::NONE;
+    playerName.clear();
+    finalScore = 0;
+    hasConfig = false;
+    ticks = 0;
+    tick = 0;
+    current = nullptr;
+    headerEnd = 0;
+    trailerOffset = 0;
+    indexOffset = 0;
+    blockCount = 0;
+    scannedIndex.clear();
+    currentBlock = NO_BLOCK;
+    currentRef = {0, 0};
+    currentBlockSize = 0;
+    checkpoints.clear();
+    checkpointBytes = 0;
+    checkpointInterval = 1;
+    player.reset();
+    frames.clear();
+}
+
+bool ReplayReader::open(const std::string& filename) {
+    close();
+    if (!file.open(filename)) return false;
+
+    bool opened = false;
+    if (hasMagic(file, ReplayFormat::MAGIC_V2)) {
+        opened = openBlocks();
+    } else if (hasMagic(file, ReplayFormat::MAGIC_INPUTS)) {
+        opened = openInputs();
+    } else if (hasMagic(file, ReplayFormat::MAGIC_V1)) {
+        file.close();
+        opened = openFrames(filename);
+    }
+
+    if (!opened || !seek(0)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool ReplayReader::openBlocks() {
+    source = Source::BLOCKS;
+    headerEnd = readHeader(file, ReplayFormat::MAGIC_V2, playerName);
+    if (headerEnd == 0) return false;
+
+    const uint8_t* data = file.data();
+    size_t size = file.size();
+    ByteReader header(data + headerEnd, size - headerEnd);
+    if (!readHeaderConfig(header, config, hasConfig)) return false;
+    headerEnd = static_cast<size_t>(header.position() - data);
+
+    // Indexed files: everything is reachable from the fixed-size footer
+    bool indexed = false;
+    if (size >= headerEnd + ReplayFormat::FOOTER_SIZE) {
+        ByteReader footer(data + size - ReplayFormat::FOOTER_SIZE, ReplayFormat::FOOTER_SIZE);
+        uint64_t trailer = footer.u64();
+        uint64_t index = footer.u64();
+        // Offsets come from the file, so compare without adding to them
+        size_t footerStart = size - ReplayFormat::FOOTER_SIZE;
+        indexed = footer.u32() == ReplayFormat::FOOTER_MAGIC && footerStart >= 8 &&
+                  trailer >= headerEnd && trailer <= footerStart && trailer < index &&
+                  index <= footerStart - 8;
+        trailerOffset = static_cast<size_t>(trailer);
+        indexOffset = static_cast<size_t>(index);
+    }
+
+    if (!indexed) {
+        // Older v2 file: walk the block headers once to build the index
+        ByteReader scan(data + headerEnd, size - headerEnd);
+        for (;;) {
+            ByteReader peek = scan;
+            if (!ReplayFormat::isBlockMagic(peek.u32()) || !peek.ok()) break;
+            uint64_t offset = static_cast<uint64_t>(scan.position() - data);
+            scan.u32();
+            uint32_t firstTick = scan.u32();
+            scan.u32();
+            uint32_t payloadSize = scan.u32();
+            scan.bytes(payloadSize);
+            scan.u32();
+            if (!scan.ok()) return false;
+            scannedIndex.push_back({firstTick, offset});
+        }
+        trailerOffset = static_cast<size_t>(scan.position() - data);
+    }
+
+    ByteReader trailer(data + trailerOffset, size - trailerOffset);
+    if (trailer.u32() != ReplayFormat::TRAILER_MAGIC) return false;
+    finalScore = trailer.i32();
+    trailer.i32();  // max combo
+    trailer.i64();  // duration
+    ticks = trailer.u32();
+    blockCount = trailer.u32();
+    if (!trailer.ok() || ticks == 0 || blockCount == 0) return false;
+    trailer.bytes(trailer.u32());  // moves
+    ByteReader peek = trailer;
+    if (trailer.ok() && peek.u8() == 1) {
+        trailer.u8();
+        hasConfig = readGameConfig(trailer, config);
+    }
+
+    if (indexed) {
+        ByteReader index(data + indexOffset, size - ReplayFormat::FOOTER_SIZE - indexOffset);
+        if (index.u32() != ReplayFormat::INDEX_MAGIC || index.u32() != blockCount) return false;
+        // blockAt() trusts every entry it is asked for to be in the mapping
+        if (static_cast<uint64_t>(blockCount) * ReplayFormat::INDEX_ENTRY_SIZE > index.remaining()) return false;
+    } else if (scannedIndex.size() != blockCount) {
+        return false;
+    }
+    return true;
+}
+
+bool ReplayReader::openInputs() {
+    source = Source::INPUTS;
+    size_t magicLength = std::strlen(ReplayFormat::MAGIC_INPUTS) + 1;
+    if (file.size() < magicLength + 4) return false;
+
+    // Input logs are small; check the whole body before trusting it
+    const uint8_t* body = file.data() + magicLength;
+    size_t bodySize = file.size() - magicLength - 4;
+    ByteReader sum(body + bodySize, 4);
+    if (sum.u32() != ReplayFormat::checksum(body, bodySize)) return false;
+
+    size_t start = readHeader(file, ReplayFormat::MAGIC_INPUTS, playerName);
+    if (start == 0) return false;
+    ByteReader in(file.data() + start, file.size() - 4 - start);
+    if (!log.read(in)) return false;
+    finalScore = in.i32();
+    hasConfig = true;
+    config = log.config;
+    ticks = log.totalTicks;
+    if (!in.ok() || ticks == 0) return false;
+
+    player.reset(new InputLogPlayer(log));
+    addCheckpoint(player->state());
+    return true;
+}
+
+bool ReplayReader::openFrames(const std::string& filename) {
+    source = Source::FRAMES;
+    ReplaySystem loader;
+    if (!loader.loadReplay(filename)) return false;
+
+    const ReplayData& replay = loader.getCurrentReplay();
+    frames = replay.states;
+    playerName = replay.playerName;
+    finalScore = replay.finalScore;
+    hasConfig = replay.hasConfig;
+    config = replay.inputLog.config;
+    ticks = static_cast<uint32_t>(frames.size());
+    return ticks > 0;
+}
+
+bool ReplayReader::seek(uint32_t target) {
+    if (target >= ticks) return false;
+
+    bool found = false;
+    switch (source) {
+        case Source::BLOCKS:
+            found = seekBlocks(target);
+            break;
+        case Source::INPUTS:
+            found = seekInputs(target);
+            break;
+        case Source::FRAMES:
+            current = &frames[target];
+            found = true;
+            break;
+        default:
+            break;
+    }
+    if (found) tick = target;
+    return found;
+}
+
+ReplayBlockRef ReplayReader::blockAt(uint32_t index) const {
+    if (!scannedIndex.empty()) return scannedIndex[index];
+
+    ByteReader entry(file.data() + indexOffset + 8 + index * ReplayFormat::INDEX_ENTRY_SIZE,
+                     ReplayFormat::INDEX_ENTRY_SIZE);
+    uint32_t firstTick = entry.u32();
+    uint64_t offset = entry.u64();
+    return {firstTick, offset};
+}
+
+bool ReplayReader::loadBlock(uint32_t index) {
+    ReplayBlockRef ref = blockAt(index);
+    if (ref.offset < headerEnd || ref.offset >= trailerOffset) return false;
+
+    ByteReader in(file.data() + ref.offset, trailerOffset - static_cast<size_t>(ref.offset));
+    uint32_t magic = in.u32();
+    uint32_t firstTick = in.u32();
+    uint32_t tickCount = in.u32();
+    uint32_t payloadSize = in.u32();
+    const uint8_t* payload = in.bytes(payloadSize);
+    uint32_t sum = in.u32();
+    if (!in.ok() || !ReplayFormat::isBlockMagic(magic) || firstTick != ref.firstTick) return false;
+    if (sum != ReplayFormat::checksum(payload, payloadSize)) return false;
+
+    // Done with the previous block's pages; they fault back in if needed
+    if (currentBlock != NO_BLOCK && currentBlock != index) {
+        file.release(static_cast<size_t>(currentRef.offset), currentBlockSize);
+    }
+
+    currentBlock = NO_BLOCK;
+    if (!cursor.begin(magic, payload, payloadSize, tickCount)) return false;
+    currentBlock = index;
+    currentRef = ref;
+    currentBlockSize = ReplayFormat::BLOCK_HEADER_SIZE + payloadSize + 4;
+    return true;
+}
+
+bool ReplayReader::seekBlocks(uint32_t target) {
+    // Last block starting at or before the target
+    uint32_t low = 0;
+    uint32_t high = blockCount;
+    while (high - low > 1) {
+        uint32_t mid = low + (high - low) / 2;
+        if (blockAt(mid).firstTick <= target) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    // Moving forward inside the current block reuses the decoded frame
+    bool reuse = currentBlock == low && currentRef.firstTick + cursor.position() <= target;
+    if (!reuse && !loadBlock(low)) return false;
+
+    while (currentRef.firstTick + cursor.position() < target) {
+        if (!cursor.next()) return false;
+    }
+    current = &cursor.frame();
+    return true;
+}
+
+bool ReplayReader::seekInputs(uint32_t target) {
+    // Frame n is the state after n + 1 steps
+    uint64_t steps = static_cast<uint64_t>(target) + 1;
+
+    size_t nearest = std::min<size_t>(steps / checkpointInterval, checkpoints.size() - 1);
+    uint64_t at = player->state().tick;
+    if (at > steps || at < checkpoints[nearest].tick) {
+        player.reset(new InputLogPlayer(log, checkpoints[nearest]));
+    }
+
+    while (player->state().tick < steps) {
+        if (player->done()) return false;
+        player->advance();
+        const SimState& state = player->state();
+        if (state.tick == checkpoints.size() * static_cast<uint64_t>(checkpointInterval)) {
+            addCheckpoint(state);
+        }
+    }
+
+    const SimState& state = player->state();
+    simFrame.snakeBody = state.snake.getBody();
+    simFrame.foodPosition = state.food.getPosition();
+    simFrame.score = state.score;
+    simFrame.combo = state.snake.getCurrentCombo();
+    simFrame.timestamp = state.clock;
+    current = &simFrame;
+    return true;
+}
+
+void ReplayReader::addCheckpoint(const SimState& state) {
+    checkpoints.push_back(state);
+    checkpointBytes += stateBytes(state);
+    // Two is the least that still saves re-running from the start
+    bool overBudget = checkpointBytes > MAX_CHECKPOINT_BYTES && checkpoints.size() > 2;
+    if (checkpoints.size() <= MAX_CHECKPOINTS && !overBudget) return;
+
+    // Keep every other one and double the spacing
+    size_t kept = 0;
+    checkpointBytes = 0;
+    for (size_t i = 0; i < checkpoints.size(); i += 2) {
+        checkpoints[kept] = checkpoints[i];
+        checkpointBytes += stateBytes(checkpoints[kept++]);
+    }
+    checkpoints.erase(checkpoints.begin() + kept, checkpoints.end());
+    checkpointInterval *= 2;
+}
+
+} // namespace SnakeGame
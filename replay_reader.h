@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+#include "replay_format.h"
+#include "replay_v2.h"
+#include "input_replay.h"
+
+namespace SnakeGame {
+
+// Random access over a saved replay without loading it whole.
+//
+// Indexed SNAKE_REPLAY_v2 files are memory mapped and opened from their
+// footer in constant time; a seek binary-searches the keyframe index and
+// applies at most one block of deltas. Pages of blocks left behind are
+// released, so resident memory stays flat however long the replay is.
+// Input replays seek by re-simulating from the nearest of a bounded set of
+// saved states. Older files (v1, v2 without an index) are loaded whole.
+class ReplayReader {
+public:
+    ReplayReader();
+
+    bool open(const std::string& filename);
+    void close();
+
+    uint32_t tickCount() const { return ticks; }
+    uint32_t position() const { return tick; }
+    const ReplayFrame& frame() const { return *current; }
+    const std::string& getPlayerName() const { return playerName; }
+    int getFinalScore() const { return finalScore; }
+    // The rules the game was played under; null when the file does not say
+    const GameConfig* getConfig() const { return hasConfig ? &config : nullptr; }
+    // Set for input replays, which are verified by re-running them
+    const InputLog* getInputLog() const { return source == Source::INPUTS ? &log : nullptr; }
+
+    // Positions the reader on a tick (0-based) and updates frame()
+    bool seek(uint32_t target);
+    bool next() { return seek(tick + 1); }
+    bool previous() { return tick > 0 && seek(tick - 1); }
+
+private:
+    enum class Source {
+        NONE,
+        BLOCKS,  // mapped v2 blocks
+        INPUTS,  // re-simulated input log
+        FRAMES   // legacy file decoded up front
+    };
+
+    static constexpr uint32_t NO_BLOCK = 0xFFFFFFFFu;
+    static constexpr size_t MAX_CHECKPOINTS = 256;
+    // A saved state copies the whole occupancy grid, about 640 KB on a
+    // 256x256 board, so the list is bounded by size as well as count
+    static constexpr size_t MAX_CHECKPOINT_BYTES = size_t(16) << 20;
+
+    Source source;
+    MappedFile file;
+    std::string playerName;
+    int finalScore;
+    bool hasConfig;
+    GameConfig config;
+    uint32_t ticks;
+    uint32_t tick;
+    const ReplayFrame* current;
+
+    // BLOCKS: the index is read in place from the mapping when the file has
+    // one, otherwise collected by walking the block headers once
+    size_t headerEnd;
+    size_t trailerOffset;
+    size_t indexOffset;
+    uint32_t blockCount;
+    std::vector<ReplayBlockRef> scannedIndex;
+    uint32_t currentBlock;
+    ReplayBlockRef currentRef;
+    size_t currentBlockSize;
+    ReplayBlockCursor cursor;
+
+    // INPUTS: checkpoints[i] holds the state after i * checkpointInterval
+    // steps; the spacing doubles whenever the list fills up
+    InputLog log;
+    std::vector<SimState> checkpoints;
+    size_t checkpointBytes;
+    uint32_t checkpointInterval;
+    std::unique_ptr<InputLogPlayer> player;
+    ReplayFrame simFrame;
+
+    // FRAMES
+    std::vector<ReplayFrame> frames;
+
+    bool openBlocks();
+    bool openInputs();
+    bool openFrames(const std::string& filename);
+    ReplayBlockRef blockAt(uint32_t index) const;
+    bool loadBlock(uint32_t index);
+    bool seekBlocks(uint32_t target);
+    bool seekInputs(uint32_t target);
+    void addCheckpoint(const SimState& state);
+};
+
+} // namespace SnakeGame
@@ -0,0 +1,254 @@
+#include "replay_stream.h"
+#include "mapped_file.h"
+#include "replay_v2.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace SnakeGame {
+
+namespace {
+
+// Longest the worker sleeps when no wake-up arrives
+constexpr auto WORKER_WAIT = std::chrono::milliseconds(50);
+
+int64_t toMilliseconds(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+}
+
+} // namespace
+
+ReplayStreamWriter::ReplayStreamWriter(std::chrono::milliseconds syncInterval)
+    : syncInterval(syncInterval)
+    , stopping(false)
+    , done(false)
+    , chunks(0)
+    , deferred(0)
+    , bytesWritten(0)
+    , syncs(0)
+    , failed(false) {
+}
+
+ReplayStreamWriter::~ReplayStreamWriter() {
+    if (!worker.joinable()) return;
+
+    // Shutting down may wait: hand over everything still held back
+    while (!drainBacklog()) {
+        wake.notify_one();
+        std::this_thread::yield();
+    }
+    stopping.store(true, std::memory_order_release);
+    wake.notify_one();
+    worker.join();
+}
+
+void ReplayStreamWriter::start(const std::string& filename) {
+    path = filename;
+    worker = std::thread(&ReplayStreamWriter::run, this);
+}
+
+void ReplayStreamWriter::append(std::vector<uint8_t>&& chunk) {
+    if (chunk.empty()) return;
+    Command command;
+    command.bytes = std::move(chunk);
+    submit(std::move(command));
+    chunks++;
+}
+
+void ReplayStreamWriter::finish(const std::string& finalPath) {
+    Command command;
+    command.finish = true;
+    command.path = finalPath;
+    submit(std::move(command));
+}
+
+ReplayStreamStats ReplayStreamWriter::getStats() const {
+    return {chunks, bytesWritten.load(), syncs.load(), deferred, failed.load()};
+}
+
+void ReplayStreamWriter::submit(Command&& command) {
+    if (!drainBacklog() || !queue.tryPush(std::move(command))) {
+        backlog.push_back(std::move(command));
+        deferred++;
+    }
+    wake.notify_one();
+}
+
+bool ReplayStreamWriter::drainBacklog() {
+    while (!backlog.empty()) {
+        if (!queue.tryPush(std::move(backlog.front()))) return false;
+        backlog.pop_front();
+    }
+    return true;
+}
+
+void ReplayStreamWriter::run() {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) failed = true;
+
+    auto lastSync = std::chrono::steady_clock::now();
+    bool dirty = false;
+    for (;;) {
+        Command command;
+        while (queue.tryPop(command)) {
+            if (command.finish) {
+                if (file) {
+                    syncFile(file);
+                    std::fclose(file);
+                    file = nullptr;
+                }
+                // A file that failed part way stays behind for recovery
+                if (command.path.empty()) {
+                    std::remove(path.c_str());
+                } else if (!failed) {
+                    std::remove(command.path.c_str());
+                    std::rename(path.c_str(), command.path.c_str());
+                }
+                done.store(true, std::memory_order_release);
+                return;
+            }
+            if (!file || failed) continue;
+            if (std::fwrite(command.bytes.data(), 1, command.bytes.size(), file) != command.bytes.size()) {
+                failed = true;
+                continue;
+            }
+            bytesWritten += command.bytes.size();
+            dirty = true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (file && dirty && now - lastSync >= syncInterval) {
+            syncFile(file);
+            dirty = false;
+            lastSync = now;
+        }
+        if (stopping.load(std::memory_order_acquire) && queue.empty()) break;
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait_for(lock, WORKER_WAIT);
+    }
+
+    if (file) {
+        syncFile(file);
+        std::fclose(file);
+    }
+    done.store(true, std::memory_order_release);
+}
+
+void ReplayStreamWriter::syncFile(std::FILE* file) {
+    std::fflush(file);
+#ifdef _WIN32
+    _commit(_fileno(file));
+#else
+    fsync(fileno(file));
+#endif
+    syncs++;
+}
+
+bool recoverReplayStream(const std::string& partialPath, const std::string& outputPath) {
+    MappedFile file;
+    if (!file.open(partialPath)) return false;
+
+    const uint8_t* data = file.data();
+    size_t size = file.size();
+    size_t magicLength = std::strlen(ReplayFormat::MAGIC_V2);
+    if (size <= magicLength || std::memcmp(data, ReplayFormat::MAGIC_V2, magicLength) != 0 ||
+        data[magicLength] != '\n') {
+        return false;
+    }
+
+    // Header
+    ByteReader in(data + magicLength + 1, size - magicLength - 1);
+    uint16_t nameLength = in.u16();
+    in.bytes(nameLength);
+    in.i64();
+    GameConfig config;
+    bool hasConfig = false;
+    if (!in.ok() || !readHeaderConfig(in, config, hasConfig)) return false;
+    size_t headerEnd = static_cast<size_t>(in.position() - data);
+
+    // Keep blocks while they are complete, intact and decode cleanly
+    std::vector<ReplayBlockRef> index;
+    ReplaySummary summary = {0, 0, 0, 0};
+    int64_t firstTimestamp = 0;
+    int64_t lastTimestamp = 0;
+    size_t validEnd = headerEnd;
+    ReplayBlockCursor cursor;
+    for (;;) {
+        ByteReader block(data + validEnd, size - validEnd);
+        uint32_t magic = block.u32();
+        uint32_t firstTick = block.u32();
+        uint32_t tickCount = block.u32();
+        uint32_t payloadSize = block.u32();
+        const uint8_t* payload = block.bytes(payloadSize);
+        uint32_t sum = block.u32();
+        if (!block.ok() || !ReplayFormat::isBlockMagic(magic) || firstTick != summary.totalTicks) break;
+        if (sum != ReplayFormat::checksum(payload, payloadSize)) break;
+        if (!cursor.begin(magic, payload, payloadSize, tickCount)) break;
+        int64_t blockStart = toMilliseconds(cursor.frame().timestamp);
+
+        bool intact = true;
+        int blockMaxCombo = cursor.frame().combo;
+        while (!cursor.atEnd()) {
+            if (!cursor.next()) {
+                intact = false;
+                break;
+            }
+            blockMaxCombo = std::max(blockMaxCombo, cursor.frame().combo);
+        }
+        if (!intact || !cursor.finishedCleanly()) break;
+
+        // Everything in the block checked out; count it
+        if (index.empty()) firstTimestamp = blockStart;
+        lastTimestamp = toMilliseconds(cursor.frame().timestamp);
+        index.push_back({firstTick, static_cast<uint64_t>(validEnd - headerEnd)});
+        summary.totalTicks += tickCount;
+        summary.finalScore = cursor.frame().score;
+        summary.maxCombo = std::max(summary.maxCombo, blockMaxCombo);
+        validEnd = static_cast<size_t>(block.position() - data);
+    }
+    if (index.empty()) return false;
+    summary.durationMs = lastTimestamp - firstTimestamp;
+
+    std::vector<uint8_t> tail;
+    ByteWriter out(tail);
+    writeReplayTail(out, summary, index, std::vector<Direction>(), hasConfig ? &config : nullptr,
+                    headerEnd, validEnd - headerEnd);
+
+    std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+    if (!output) return false;
+    output.write(reinterpret_cast<const char*>(data), validEnd);
+    output.write(reinterpret_cast<const char*>(tail.data()), tail.size());
+    output.flush();
+    return static_cast<bool>(output);
+}
+
+int recoverReplayStreams(const std::string& directory, std::vector<std::string>* recovered) {
+    int count = 0;
+    std::error_code error;
+    std::vector<std::filesystem::path> partials;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.path().extension() == ".partial") {
+            partials.push_back(entry.path());
+        }
+    }
+    for (const auto& partial : partials) {
+        std::filesystem::path output = partial;
+        output.replace_extension(".replay");
+        if (recoverReplayStream(partial.string(), output.string())) {
+            count++;
+            if (recovered) recovered->push_back(output.string());
+        }
+        std::filesystem::remove(partial, error);
+    }
+    return count;
+}
+
+} // namespace SnakeGame
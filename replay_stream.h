@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "spsc_queue.h"
+
+namespace SnakeGame {
+
+struct ReplayStreamStats {
+    uint64_t chunks;        // handed to the worker
+    uint64_t bytesWritten;
+    uint64_t syncs;
+    uint64_t deferred;      // held back on the game thread because the queue was full
+    bool failed;            // a write failed; the file ends early
+};
+
+// Append-only replay file written on a background thread. The game thread
+// hands over finished chunks (the header, encoded blocks, the tail) through
+// a bounded lock-free queue and never touches the disk; if the queue is
+// full, chunks wait on the game thread and are retried on the next call.
+// The worker syncs the file to disk every syncInterval, so a crash loses at
+// most the blocks written since the last sync.
+class ReplayStreamWriter {
+public:
+    explicit ReplayStreamWriter(std::chrono::milliseconds syncInterval = std::chrono::milliseconds(1000));
+    // Drains whatever is queued and leaves an unfinished file in place
+    ~ReplayStreamWriter();
+
+    ReplayStreamWriter(const ReplayStreamWriter&) = delete;
+    ReplayStreamWriter& operator=(const ReplayStreamWriter&) = delete;
+
+    // The file is created by the worker, not by this call
+    void start(const std::string& path);
+    void append(std::vector<uint8_t>&& chunk);
+    // After a final sync the worker renames the file to finalPath, or
+    // deletes it when finalPath is empty
+    void finish(const std::string& finalPath);
+
+    bool isDone() const { return done.load(std::memory_order_acquire); }
+    ReplayStreamStats getStats() const;
+
+private:
+    struct Command {
+        bool finish = false;
+        std::vector<uint8_t> bytes;
+        std::string path;
+    };
+
+    static constexpr size_t QUEUE_CAPACITY = 64;
+
+    SpscQueue<Command, QUEUE_CAPACITY> queue;
+    std::deque<Command> backlog;  // producer-side overflow
+    std::chrono::milliseconds syncInterval;
+    std::string path;
+    std::thread worker;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<bool> stopping;
+    std::atomic<bool> done;
+
+    uint64_t chunks;
+    uint64_t deferred;
+    std::atomic<uint64_t> bytesWritten;
+    std::atomic<uint64_t> syncs;
+    std::atomic<bool> failed;
+
+    void submit(Command&& command);
+    bool drainBacklog();
+    void run();
+    void syncFile(std::FILE* file);
+};
+
+// Turns an interrupted stream back into a playable replay: every complete,
+// intact block is kept and a fresh trailer, index and footer are written
+// to outputPath. Returns false when not even one block survived.
+bool recoverReplayStream(const std::string& partialPath, const std::string& outputPath);
+
+// Recovers every *.partial file in a directory into a .replay with the
+// same stem and removes the partial file. Returns how many were recovered;
+// their paths are added to recovered when given.
+int recoverReplayStreams(const std::string& directory,
+                         std::vector<std::string>* recovered = nullptr);
+
+} // namespace SnakeGame
@@ -0,0 +1,339 @@
+#include "replay_v2.h"
+#include "replay_codec.h"
+
+namespace SnakeGame {
+
+namespace {
+
+uint32_t packFood(const Point& food) {
+    if (food.x < 0 || food.y < 0) return ReplayFormat::NO_FOOD;
+    return SnakeBody::pack(food);
+}
+
+Point unpackFood(uint32_t cell) {
+    if (cell == ReplayFormat::NO_FOOD) return Point(-1, -1);
+    return SnakeBody::unpack(cell);
+}
+
+int64_t toMilliseconds(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+}
+
+bool sameBody(const SnakeBody& a, const SnakeBody& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a.packedAt(i) != b.packedAt(i)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+ReplayEncoder::ReplayEncoder(uint32_t minKeyframeInterval, bool compact)
+    : minKeyframeInterval(minKeyframeInterval > 0 ? minKeyframeInterval : 1)
+    , compact(compact) {
+    reset();
+}
+
+void ReplayEncoder::reset() {
+    blocks.clear();
+    payload.clear();
+    index.clear();
+    drainedBytes = 0;
+    totalTicks = 0;
+    totalBlocks = 0;
+    shadow.clear();
+    lastMoves = 0;
+    lastGrows = 0;
+    lastFood = ReplayFormat::NO_FOOD;
+    lastScore = 0;
+    lastCombo = 0;
+    lastTimestamp = 0;
+    lastInterval = 0;
+    blockFirstTick = 0;
+    blockTicks = 0;
+    keyframeBytes = 0;
+}
+
+void ReplayEncoder::record(const SnakeBody& body, uint64_t moveCount, uint64_t growCount,
+                           const Point& food, int score, int combo, int64_t timestampMs) {
+    uint64_t moves = moveCount - lastMoves;
+    uint64_t grows = growCount - lastGrows;
+    lastMoves = moveCount;
+    lastGrows = growCount;
+
+    // More than one step between records cannot be expressed as a delta
+    if (moves > 1 || grows > 1) {
+        closeBlock();
+    }
+    encodeTick(body, moves == 1, grows == 1, false, packFood(food), score, combo, timestampMs);
+}
+
+void ReplayEncoder::record(const ReplayFrame& frame) {
+    const SnakeBody& body = frame.snakeBody;
+    bool grew = !shadow.empty() && body.size() == shadow.size() + 1;
+    bool moved = !shadow.empty() && body.size() >= 2 &&
+                 body.packedAt(1) == shadow.packedAt(0);
+    encodeTick(body, moved, grew, true, packFood(frame.foodPosition),
+               frame.score, frame.combo, toMilliseconds(frame.timestamp));
+}
+
+void ReplayEncoder::encodeTick(const SnakeBody& body, bool moved, bool grew, bool verifyFully,
+                               uint32_t food, int score, int combo, int64_t timestampMs) {
+    ++totalTicks;
+
+    bool keyframeDue = blockTicks >= minKeyframeInterval &&
+                       payload.size() - keyframeBytes >= 4 * keyframeBytes;
+    if (blockTicks == 0 || keyframeDue || body.empty()) {
+        closeBlock();
+        writeKeyframe(body, food, score, combo, timestampMs);
+        return;
+    }
+
+    // Replay the ring operations on the shadow copy exactly as the decoder
+    // will; if the result disagrees with the real body, fall back to a
+    // keyframe rather than emit a delta that decodes wrong
+    uint8_t flags = 0;
+    if (moved) {
+        flags |= ReplayFormat::HEAD_PUSH | ReplayFormat::TAIL_POP;
+        shadow.advance(body.front());
+    } else if (body.packedAt(0) != shadow.packedAt(0)) {
+        flags |= ReplayFormat::HEAD_SET;
+        shadow.setFront(body.front());
+    }
+    if (grew) {
+        flags |= ReplayFormat::TAIL_DUP;
+        shadow.pushBack(shadow.back());
+    }
+
+    bool consistent = shadow.size() == body.size() &&
+                      shadow.packedAt(0) == body.packedAt(0) &&
+                      shadow.packedAt(shadow.size() - 1) == body.packedAt(body.size() - 1);
+    if (consistent && verifyFully) consistent = sameBody(shadow, body);
+
+    int64_t interval = timestampMs - lastTimestamp;
+    if (!consistent || interval < 0 || interval > 0xFFFFFFFFll) {
+        closeBlock();
+        writeKeyframe(body, food, score, combo, timestampMs);
+        return;
+    }
+
+    if (food != lastFood) flags |= ReplayFormat::FOOD;
+    if (score != lastScore) flags |= ReplayFormat::SCORE;
+    if (combo != lastCombo) flags |= ReplayFormat::COMBO;
+    if (static_cast<uint32_t>(interval) != lastInterval) flags |= ReplayFormat::INTERVAL;
+
+    ByteWriter out(payload);
+    out.u8(flags);
+    if (flags & (ReplayFormat::HEAD_PUSH | ReplayFormat::HEAD_SET)) out.u32(body.packedAt(0));
+    if (flags & ReplayFormat::FOOD) out.u32(food);
+    if (flags & ReplayFormat::SCORE) out.i32(score - lastScore);
+    if (flags & ReplayFormat::COMBO) out.i32(combo);
+    if (flags & ReplayFormat::INTERVAL) out.u32(static_cast<uint32_t>(interval));
+
+    lastFood = food;
+    lastScore = score;
+    lastCombo = combo;
+    lastTimestamp = timestampMs;
+    lastInterval = static_cast<uint32_t>(interval);
+    ++blockTicks;
+}
+
+void ReplayEncoder::writeKeyframe(const SnakeBody& body, uint32_t food, int score, int combo,
+                                  int64_t timestampMs) {
+    blockFirstTick = totalTicks - 1;
+    blockTicks = 1;
+
+    ByteWriter out(payload);
+    out.u32(static_cast<uint32_t>(body.size()));
+    for (size_t i = 0; i < body.size(); ++i) {
+        out.u32(body.packedAt(i));
+    }
+    out.u32(food);
+    out.i32(score);
+    out.i32(combo);
+    out.i64(timestampMs);
+    keyframeBytes = payload.size();
+
+    shadow = body;
+    lastFood = food;
+    lastScore = score;
+    lastCombo = combo;
+    lastTimestamp = timestampMs;
+    lastInterval = 0;
+}
+
+void ReplayEncoder::closeBlock() {
+    if (blockTicks == 0) return;
+
+    uint32_t magic = ReplayFormat::BLOCK_MAGIC;
+    const std::vector<uint8_t>* stored = &payload;
+    if (compact && ReplayCodec::compressBlock(payload.data(), payload.size(), blockTicks, compressed) &&
+        compressed.size() < payload.size()) {
+        magic = ReplayFormat::COMPACT_BLOCK_MAGIC;
+        stored = &compressed;
+    }
+
+    index.push_back({blockFirstTick, drainedBytes + blocks.size()});
+    ByteWriter out(blocks);
+    out.u32(magic);
+    out.u32(blockFirstTick);
+    out.u32(blockTicks);
+    out.u32(static_cast<uint32_t>(stored->size()));
+    out.bytes(stored->data(), stored->size());
+    out.u32(ReplayFormat::checksum(stored->data(), stored->size()));
+
+    ++totalBlocks;
+    payload.clear();
+    blockTicks = 0;
+    keyframeBytes = 0;
+}
+
+void ReplayEncoder::finish() {
+    closeBlock();
+}
+
+void ReplayEncoder::takeData(std::vector<uint8_t>& out) {
+    drainedBytes += blocks.size();
+    out.swap(blocks);
+    blocks.clear();
+}
+
+void writeReplayTail(ByteWriter& out, const ReplaySummary& summary,
+                     const std::vector<ReplayBlockRef>& index, const std::vector<Direction>& moves,
+                     const GameConfig* config, uint64_t blocksOffset, uint64_t blocksSize) {
+    uint64_t trailerOffset = blocksOffset + blocksSize;
+    size_t start = out.size();
+
+    out.u32(ReplayFormat::TRAILER_MAGIC);
+    out.i32(summary.finalScore);
+    out.i32(summary.maxCombo);
+    out.i64(summary.durationMs);
+    out.u32(summary.totalTicks);
+    out.u32(static_cast<uint32_t>(index.size()));
+    out.u32(static_cast<uint32_t>(moves.size()));
+    for (Direction move : moves) {
+        out.u8(static_cast<uint8_t>(move));
+    }
+    out.u8(config != nullptr);
+    if (config) writeGameConfig(out, *config);
+
+    uint64_t indexOffset = trailerOffset + (out.size() - start);
+    out.u32(ReplayFormat::INDEX_MAGIC);
+    out.u32(static_cast<uint32_t>(index.size()));
+    for (const auto& block : index) {
+        out.u32(block.firstTick);
+        out.u64(blocksOffset + block.offset);
+    }
+    out.u64(trailerOffset);
+    out.u64(indexOffset);
+    out.u32(ReplayFormat::FOOTER_MAGIC);
+}
+
+ReplayBlockCursor::ReplayBlockCursor() : interval(0), ticks(0), index(0) {}
+
+bool ReplayBlockCursor::begin(const uint8_t* payload, size_t size, uint32_t tickCount) {
+    in = ByteReader(payload, size);
+    ticks = tickCount;
+    index = 0;
+    interval = 0;
+    if (tickCount == 0) return false;
+
+    SnakeBody& body = current.snakeBody;
+    body.clear();
+    uint32_t length = in.u32();
+    if (length > in.remaining() / sizeof(uint32_t)) return false;
+    for (uint32_t i = 0; i < length; ++i) {
+        body.pushBack(SnakeBody::unpack(in.u32()));
+    }
+    current.foodPosition = unpackFood(in.u32());
+    current.score = in.i32();
+    current.combo = in.i32();
+    int64_t timestamp = in.i64();
+    current.timestamp = std::chrono::steady_clock::time_point(std::chrono::milliseconds(timestamp));
+    return in.ok();
+}
+
+bool ReplayBlockCursor::begin(uint32_t magic, const uint8_t* data, size_t size, uint32_t tickCount) {
+    if (magic == ReplayFormat::BLOCK_MAGIC) return begin(data, size, tickCount);
+    if (magic != ReplayFormat::COMPACT_BLOCK_MAGIC) return false;
+    if (!ReplayCodec::expandBlock(data, size, tickCount, expanded)) return false;
+    return begin(expanded.data(), expanded.size(), tickCount);
+}
+
+bool ReplayBlockCursor::next() {
+    if (atEnd()) return false;
+
+    uint8_t flags = in.u8();
+    SnakeBody& body = current.snakeBody;
+
+    if (flags & (ReplayFormat::HEAD_PUSH | ReplayFormat::HEAD_SET)) {
+        Point head = SnakeBody::unpack(in.u32());
+        if (flags & ReplayFormat::HEAD_PUSH) {
+            body.pushFront(head);
+        } else {
+            if (body.empty()) return false;
+            body.setFront(head);
+        }
+    }
+    if (flags & ReplayFormat::TAIL_POP) {
+        if (body.empty()) return false;
+        body.popBack();
+    }
+    if (flags & ReplayFormat::TAIL_DUP) {
+        if (body.empty()) return false;
+        body.pushBack(body.back());
+    }
+    if (flags & ReplayFormat::FOOD) current.foodPosition = unpackFood(in.u32());
+    if (flags & ReplayFormat::SCORE) current.score += in.i32();
+    if (flags & ReplayFormat::COMBO) current.combo = in.i32();
+    if (flags & ReplayFormat::INTERVAL) interval = in.u32();
+    current.timestamp += std::chrono::milliseconds(interval);
+
+    ++index;
+    return in.ok();
+}
+
+bool decodeReplayBlock(const uint8_t* payload, size_t size, uint32_t tickCount,
+                       std::vector<ReplayFrame>& out) {
+    if (tickCount == 0) return size == 0;
+
+    ReplayBlockCursor cursor;
+    if (!cursor.begin(payload, size, tickCount)) return false;
+    out.push_back(cursor.frame());
+    while (!cursor.atEnd()) {
+        if (!cursor.next()) return false;
+        out.push_back(cursor.frame());
+    }
+    return cursor.finishedCleanly();
+}
+
+bool decodeReplayBlocks(ByteReader& reader, std::vector<ReplayFrame>& out,
+                        uint32_t& blockCount) {
+    blockCount = 0;
+    ReplayBlockCursor cursor;
+    for (;;) {
+        ByteReader peek = reader;
+        if (!ReplayFormat::isBlockMagic(peek.u32()) || !peek.ok()) return true;
+
+        uint32_t magic = reader.u32();
+        uint32_t firstTick = reader.u32();
+        uint32_t tickCount = reader.u32();
+        uint32_t payloadSize = reader.u32();
+        const uint8_t* payload = reader.bytes(payloadSize);
+        uint32_t sum = reader.u32();
+
+        if (!reader.ok() || firstTick != out.size()) return false;
+        if (sum != ReplayFormat::checksum(payload, payloadSize)) return false;
+        if (!cursor.begin(magic, payload, payloadSize, tickCount)) return false;
+        out.push_back(cursor.frame());
+        while (!cursor.atEnd()) {
+            if (!cursor.next()) return false;
+            out.push_back(cursor.frame());
+        }
+        if (!cursor.finishedCleanly()) return false;
+        ++blockCount;
+    }
+}
+
+} // namespace SnakeGame
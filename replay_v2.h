@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "direction.h"
+#include "replay_format.h"
+
+namespace SnakeGame {
+
+// Where a block starts, relative to the start of the block section
+struct ReplayBlockRef {
+    uint32_t firstTick;
+    uint64_t offset;
+};
+
+// Builds the block section of a SNAKE_REPLAY_v2 file one tick at a time.
+// Each tick costs a flag byte plus whatever actually changed, usually one
+// packed head cell; a keyframe restarts the block once the deltas since
+// the last one outweigh it, so seeking never replays more than a bounded
+// amount of history. Closed blocks are stored compact (replay_codec.h)
+// whenever that comes out smaller.
+class ReplayEncoder {
+public:
+    explicit ReplayEncoder(uint32_t minKeyframeInterval = 256, bool compact = true);
+
+    void reset();
+
+    // Fast path: the snake's move/grow counters say which ring operations
+    // happened since the previous tick, so nothing is diffed
+    void record(const SnakeBody& body, uint64_t moveCount, uint64_t growCount,
+                const Point& food, int score, int combo, int64_t timestampMs);
+    // Slow path for frames without counters (e.g. converting a v1 file):
+    // the body is compared against the previous one in full
+    void record(const ReplayFrame& frame);
+
+    // Closes the open block; data() is complete only after this
+    void finish();
+    // Closes the open block early so a streaming writer can persist it
+    void cutBlock() { closeBlock(); }
+    // Moves the finished blocks out; block offsets keep counting from the
+    // start of the whole block section
+    void takeData(std::vector<uint8_t>& out);
+
+    const std::vector<uint8_t>& data() const { return blocks; }
+    uint64_t dataSize() const { return drainedBytes + blocks.size(); }
+    uint32_t openBlockTicks() const { return blockTicks; }
+    uint32_t tickCount() const { return totalTicks; }
+    uint32_t blockCount() const { return totalBlocks; }
+    const std::vector<ReplayBlockRef>& blockIndex() const { return index; }
+
+private:
+    uint32_t minKeyframeInterval;
+    bool compact;
+    std::vector<uint8_t> blocks;
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> compressed;
+    std::vector<ReplayBlockRef> index;
+    uint64_t drainedBytes;
+    uint32_t totalTicks;
+    uint32_t totalBlocks;
+
+    // Previous tick, replayed through the same operations the decoder uses
+    SnakeBody shadow;
+    uint64_t lastMoves;
+    uint64_t lastGrows;
+    uint32_t lastFood;
+    int lastScore;
+    int lastCombo;
+    int64_t lastTimestamp;
+    uint32_t lastInterval;
+
+    uint32_t blockFirstTick;
+    uint32_t blockTicks;
+    size_t keyframeBytes;
+
+    void encodeTick(const SnakeBody& body, bool moved, bool grew, bool verifyFully,
+                    uint32_t food, int score, int combo, int64_t timestampMs);
+    void writeKeyframe(const SnakeBody& body, uint32_t food, int score, int combo,
+                       int64_t timestampMs);
+    void closeBlock();
+};
+
+// What the trailer records about a whole game
+struct ReplaySummary {
+    int finalScore;
+    int maxCombo;
+    int64_t durationMs;
+    uint32_t totalTicks;
+};
+
+// Writes trailer, keyframe index and footer. blocksOffset is the file
+// offset of the first block and blocksSize the length of the block section;
+// config may be null when the rules are not known.
+void writeReplayTail(ByteWriter& out, const ReplaySummary& summary,
+                     const std::vector<ReplayBlockRef>& index, const std::vector<Direction>& moves,
+                     const GameConfig* config, uint64_t blocksOffset, uint64_t blocksSize);
+
+// Steps through one block payload a tick at a time, keeping a single
+// frame: begin() decodes the keyframe and each next() applies one delta
+class ReplayBlockCursor {
+public:
+    ReplayBlockCursor();
+
+    ReplayBlockCursor(const ReplayBlockCursor&) = delete;
+    ReplayBlockCursor& operator=(const ReplayBlockCursor&) = delete;
+
+    bool begin(const uint8_t* payload, size_t size, uint32_t tickCount);
+    // Same, for a stored block of either kind; compact blocks are expanded
+    // into a buffer the cursor owns
+    bool begin(uint32_t magic, const uint8_t* data, size_t size, uint32_t tickCount);
+    bool next();
+
+    const ReplayFrame& frame() const { return current; }
+    uint32_t position() const { return index; }
+    bool atEnd() const { return index + 1 >= ticks; }
+    // All deltas applied and no bytes left over
+    bool finishedCleanly() const { return atEnd() && in.ok() && in.remaining() == 0; }
+
+private:
+    ByteReader in;
+    std::vector<uint8_t> expanded;
+    ReplayFrame current;
+    uint32_t interval;
+    uint32_t ticks;
+    uint32_t index;
+};
+
+// Decodes one block payload (keyframe plus tickCount - 1 deltas) and
+// appends its frames to out. Returns false on malformed input.
+bool decodeReplayBlock(const uint8_t* payload, size_t size, uint32_t tickCount,
+                       std::vector<ReplayFrame>& out);
+
+// Decodes framed blocks until something other than a block header follows,
+// verifying each checksum; blockCount receives how many were read
+bool decodeReplayBlocks(ByteReader& reader, std::vector<ReplayFrame>& out,
+                        uint32_t& blockCount);
+
+} // namespace SnakeGame
@@ -0,0 +1,137 @@
+#include "replay_verify.h"
+#include "replay_reader.h"
+#include "sim.h"
+#include <cstdlib>
+
+namespace SnakeGame {
+
+namespace {
+
+// Points for one apple: 10 times a combo multiplier capped at 5
+constexpr int POINTS_PER_FOOD = 10;
+constexpr int MAX_MULTIPLIER = 5;
+
+// One cell along one axis, or across the edge of a wrap-around board
+bool adjacent(int from, int to, int size, bool wraps) {
+    int d = std::abs(to - from);
+    if (d == 1) return true;
+    if (size <= 0) return d > 1;  // board unknown: allow any wrap
+    return wraps && d == size - 1;
+}
+
+bool singleStep(const Point& from, const Point& to, const GameConfig* config) {
+    int width = config ? config->width : 0;
+    int height = config ? config->height : 0;
+    bool wraps = config ? config->wrapAround : true;
+    if (from.y == to.y) return adjacent(from.x, to.x, width, wraps);
+    if (from.x == to.x) return adjacent(from.y, to.y, height, wraps);
+    return false;
+}
+
+bool portalJump(const Point& from, const Point& to, const GameConfig& config) {
+    for (const auto& portal : makeCornerPortals(config)) {
+        if (to == portal.destination && singleStep(from, portal.position, &config)) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+const char* checkReplayStep(const ReplayFrame& previous, const ReplayFrame& current,
+                            const GameConfig* config, bool& waiting) {
+    const SnakeBody& before = previous.snakeBody;
+    const SnakeBody& after = current.snakeBody;
+    if (before.empty() || after.empty()) return "empty snake";
+
+    int gained = current.score - previous.score;
+    bool ate = gained != 0;
+    if (gained < 0 || gained > POINTS_PER_FOOD * MAX_MULTIPLIER || gained % POINTS_PER_FOOD != 0) {
+        return "score changed by an impossible amount";
+    }
+    if (after.size() != before.size() + (ate ? 1 : 0)) {
+        return ate ? "snake did not grow when it scored" : "snake length changed without eating";
+    }
+    if (ate && after.front() != previous.foodPosition) return "score rose away from the food";
+    if (!ate && current.foodPosition != previous.foodPosition) return "food moved without being eaten";
+
+    // Fresh out of a portal the snake holds still for a tick
+    size_t kept = before.size();
+    if (waiting) {
+        waiting = false;
+        for (size_t i = 0; i < kept; ++i) {
+            if (after.packedAt(i) != before.packedAt(i)) return "snake moved while leaving a portal";
+        }
+        return nullptr;
+    }
+
+    // Everything behind the head shifts back by one; growing duplicates
+    // the new tail
+    for (size_t i = 1; i < kept; ++i) {
+        if (after.packedAt(i) != before.packedAt(i - 1)) return "body did not follow the head";
+    }
+    if (ate && after.packedAt(kept) != after.packedAt(kept - 1)) return "tail did not grow in place";
+
+    Point from = before.front();
+    Point to = after.front();
+    if (singleStep(from, to, config)) return nullptr;
+    if (!config || portalJump(from, to, *config)) {
+        waiting = true;
+        return nullptr;
+    }
+    return "head jumped";
+}
+
+ReplayVerdict verifyReplay(const std::string& path) {
+    ReplayVerdict verdict = {false, 0, 0, std::string()};
+    ReplayReader reader;
+    if (!reader.open(path)) {
+        verdict.error = "unreadable or corrupt";
+        return verdict;
+    }
+
+    // Re-running an input log applies the rules by construction
+    if (const InputLog* log = reader.getInputLog()) {
+        InputLogCheck check = verifyInputLog(*log, reader.getFinalScore());
+        verdict.ticks = static_cast<uint32_t>(check.ticks);
+        verdict.valid = check.matches;
+        if (!check.matches) {
+            verdict.failedTick = static_cast<uint32_t>(check.ticks);
+            verdict.error = check.outOfSteps
+                                ? "longer than the " + std::to_string(MAX_LOG_TICKS) + "-tick step budget"
+                                : "re-simulated score " + std::to_string(check.score) + " instead of " +
+                                      std::to_string(reader.getFinalScore());
+        }
+        return verdict;
+    }
+
+    const GameConfig* config = reader.getConfig();
+    ReplayFrame previous = reader.frame();
+    bool waiting = false;
+    while (reader.next()) {
+        const ReplayFrame& current = reader.frame();
+        if (const char* error = checkReplayStep(previous, current, config, waiting)) {
+            verdict.failedTick = reader.position();
+            verdict.ticks = reader.position();
+            verdict.error = error;
+            return verdict;
+        }
+        previous = current;
+    }
+
+    verdict.ticks = reader.tickCount();
+    if (reader.position() + 1 != reader.tickCount()) {
+        verdict.failedTick = reader.position() + 1;
+        verdict.error = "damaged block";
+        return verdict;
+    }
+    if (previous.score != reader.getFinalScore()) {
+        verdict.failedTick = reader.position();
+        verdict.error = "final score " + std::to_string(previous.score) + " does not match the recorded " +
+                        std::to_string(reader.getFinalScore());
+        return verdict;
+    }
+    verdict.valid = true;
+    return verdict;
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "constants.h"
+#include "replay_format.h"
+
+namespace SnakeGame {
+
+struct ReplayVerdict {
+    bool valid;
+    uint32_t ticks;       // ticks checked
+    uint32_t failedTick;  // first tick that broke a rule, when !valid
+    std::string error;
+};
+
+// Checks a saved replay against the game rules without loading it whole.
+//
+// Frame replays are streamed through ReplayReader and every tick must
+// follow from the one before: the head moves one cell (wrapping on a
+// wrap-around board) or jumps through a portal and then waits a tick, the
+// body follows it, the score only rises by 10-50 when the head lands on
+// the food and the snake grows by one, food only moves when eaten, and
+// the last score matches the recorded final score. Wraps and portal jumps
+// are only checked against the board when the file records its config.
+// Input replays are re-simulated and must reach their recorded score.
+ReplayVerdict verifyReplay(const std::string& path);
+
+// Rule check for one transition between consecutive frames. waiting is
+// true on the tick after a portal jump and is updated for the next call.
+// Returns nullptr when the step is legal, otherwise the reason.
+const char* checkReplayStep(const ReplayFrame& previous, const ReplayFrame& current,
+                            const GameConfig* config, bool& waiting);
+
+} // namespace SnakeGame
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+namespace SnakeGame {
+
+// splitmix64, the generator BatchSim steps by hand, cut to 32-bit draws.
+// One word of state against std::mt19937's 5 KB, for games that save their
+// generator every tick (Arena snapshots for rollback).
+class SplitMix64 {
+public:
+    using result_type = uint32_t;
+
+    explicit SplitMix64(uint64_t seed = 0) : state(seed) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+    result_type operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<result_type>((z ^ (z >> 31)) >> 32);
+    }
+
+private:
+    uint64_t state;
+};
+
+// std::mt19937's output sequence is fixed by the standard but the
+// distributions built on it are not, so replays recorded with one standard
+// library would desync under another. These reductions only depend on the
+// raw 32-bit draws, from std::mt19937 or SplitMix64.
+
+// Uniform in [0, n) for n >= 1 (multiply-shift; bias below 2^-32 * n)
+template <typename Rng>
+inline uint32_t boundedRandom(Rng& rng, uint32_t n) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(rng()) * n) >> 32);
+}
+
+// Uniform in [0, 1)
+template <typename Rng>
+inline double unitRandom(Rng& rng) {
+    return static_cast<uint32_t>(rng()) * (1.0 / 4294967296.0);
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,73 @@
+#include "rollback.h"
+#include <algorithm>
+
+namespace SnakeGame {
+
+RollbackSession::RollbackSession(const Arena& start, int localSeat, int maxPrediction)
+    : arena(start)
+    , localSeat(localSeat)
+    , maxPrediction(static_cast<uint64_t>(maxPrediction))
+    , confirmedTick(start.getTick())
+    , firstWrong(0)
+    // The peer runs up to maxPrediction ticks ahead and rollbacks reach
+    // as far back, so inputs for both ends of that span are held at once
+    , ring(2 * static_cast<size_t>(maxPrediction) + 2)
+    , stats() {
+    arena.setHuman(0, true);
+    arena.setHuman(1, true);
+}
+
+void RollbackSession::addRemoteInput(uint64_t tick, Direction input) {
+    if (tick != confirmedTick + 1) return;
+    Slot& s = slot(tick);
+    if (tick <= arena.getTick() && s.remote != input) {
+        stats.mispredictions++;
+        if (firstWrong == 0 || tick < firstWrong) firstWrong = tick;
+    }
+    s.remote = input;
+    confirmedTick = tick;
+}
+
+RollbackFrame RollbackSession::advance(Direction local) {
+    RollbackFrame frame = resolve();
+    uint64_t tick = arena.getTick() + 1;
+    Slot& s = slot(tick);
+    arena.save(s.before);
+    s.local = local;
+    if (tick > confirmedTick) s.remote = Direction::NONE;
+    step(s);
+    stats.ticks++;
+    return frame;
+}
+
+RollbackFrame RollbackSession::resolve() {
+    RollbackFrame frame;
+    if (firstWrong == 0) return frame;
+
+    auto began = std::chrono::steady_clock::now();
+    uint64_t now = arena.getTick();
+    arena.restore(slot(firstWrong).before);
+    for (uint64_t tick = firstWrong; tick <= now; ++tick) {
+        Slot& s = slot(tick);
+        // States after the corrected tick changed, so their saves did too
+        if (tick != firstWrong) arena.save(s.before);
+        step(s);
+    }
+    frame.resim = std::chrono::steady_clock::now() - began;
+    frame.depth = static_cast<int>(now - firstWrong + 1);
+
+    stats.rollbacks++;
+    stats.resimulatedTicks += static_cast<uint64_t>(frame.depth);
+    stats.maxDepth = std::max(stats.maxDepth, frame.depth);
+    firstWrong = 0;
+    return frame;
+}
+
+void RollbackSession::step(Slot& s) {
+    Direction inputs[2];
+    inputs[localSeat] = s.local;
+    inputs[1 - localSeat] = s.remote;
+    arena.step(inputs);
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "arena.h"
+#include "direction.h"
+
+namespace SnakeGame {
+
+// What one advance() did besides stepping the new tick
+struct RollbackFrame {
+    int depth = 0;                      // ticks re-simulated, 0 for none
+    std::chrono::nanoseconds resim{0};  // restoring plus re-simulating them
+};
+
+struct RollbackStats {
+    uint64_t ticks;             // advanced
+    uint64_t rollbacks;
+    uint64_t resimulatedTicks;
+    uint64_t mispredictions;    // remote inputs that differed from the guess
+    int maxDepth;
+};
+
+// One peer of a rollback (GGPO-style) versus game: two human snakes in an
+// Arena, one steered here and one by the peer.
+//
+// The local input applies on the tick it is given. The peer's input for a
+// tick is usually still in flight, so it is predicted as Direction::NONE,
+// which keeps the snake going the way it was heading. That is what most
+// ticks are. Before each tick the arena is saved into a ring of
+// ArenaSnapshots. When the peer's real input arrives and differs from the
+// guess, the next advance() restores the state from before that tick and
+// re-simulates up to the present with the corrected inputs. The game is
+// then exactly what it would have been had the input arrived in time.
+//
+// Both peers start from the same Arena, and the arena draws only from its
+// own generator, so they reach the same state once all inputs are known.
+// Prediction is capped at maxPrediction ticks past the last confirmed
+// remote input: canAdvance() turns false there and the caller waits,
+// which also bounds how far a rollback reaches back.
+//
+// Transport is the caller's: send each tick's local input as advance()
+// returns, and hand the peer's to addRemoteInput() in tick order.
+class RollbackSession {
+public:
+    RollbackSession(const Arena& start, int localSeat, int maxPrediction = 8);
+
+    // The peer's input for one tick; ticks must arrive in order, from
+    // getTick() + 1 of the peer's first call onwards
+    void addRemoteInput(uint64_t tick, Direction input);
+    // Whether advance() would stay within the prediction window
+    bool canAdvance() const { return arena.getTick() < confirmedTick + maxPrediction; }
+    // Re-simulates if a confirmed input contradicted its prediction, then
+    // steps getTick() + 1 with the local input
+    RollbackFrame advance(Direction local);
+    // Just the re-simulation, for when every input is in and no tick is due
+    RollbackFrame resolve();
+
+    const Arena& getArena() const { return arena; }
+    uint64_t getTick() const { return arena.getTick(); }
+    // Last tick with the peer's input known
+    uint64_t getConfirmedTick() const { return confirmedTick; }
+    int getLocalSeat() const { return localSeat; }
+    const RollbackStats& getStats() const { return stats; }
+
+private:
+    struct Slot {
+        ArenaSnapshot before;  // the arena just before stepping this tick
+        Direction local = Direction::NONE;
+        Direction remote = Direction::NONE;  // confirmed or predicted
+    };
+
+    Arena arena;
+    int localSeat;
+    uint64_t maxPrediction;
+    uint64_t confirmedTick;
+    uint64_t firstWrong;  // earliest tick stepped on a wrong guess, 0 for none
+    std::vector<Slot> ring;
+    RollbackStats stats;
+
+    Slot& slot(uint64_t tick) { return ring[tick % ring.size()]; }
+    void step(Slot& slot);
+};
+
+} // namespace SnakeGame
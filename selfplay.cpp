@@ -0,0 +1,331 @@
+// Headless self-play harness.
+// Plays independent games on a work-stealing thread pool, each with its
+// own SimState seeded from the run seed plus the game number, so the
+// results do not depend on the thread count. Every worker keeps its own
+// counters and histograms on separate cache lines; they are merged once
+// the pool has finished into score, length, game length and death-cause
+// distributions. --sweep repeats the run on 1, 2, 4, ... threads up to -j
+// and prints the scaling.
+// Usage: snake_selfplay [-n games] [-j threads] [--bot greedy|astar|cycle|neural]
+//                       [--net file] [--size WxH] [--walls] [--no-portals]
+//                       [--max-ticks N] [--seed N] [--sweep]
+
+#include "autopilot.h"
+#include "hamiltonian.h"
+#include "neural.h"
+#include "rng.h"
+#include "sim.h"
+#include "work_stealing.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr int POINTS_PER_FOOD = 10;
+
+enum class Bot {
+    GREEDY,
+    ASTAR,
+    CYCLE,
+    NEURAL
+};
+
+enum Outcome {
+    OUTCOME_SELF,
+    OUTCOME_WALL,
+    OUTCOME_WON,
+    OUTCOME_TIMEOUT,
+    OUTCOME_COUNT
+};
+
+const char* const OUTCOME_NAMES[OUTCOME_COUNT] = {"self collision", "wall", "board filled", "tick limit"};
+
+struct Options {
+    uint64_t games = 100000;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    Bot bot = Bot::GREEDY;
+    GameConfig config = GameConfig::defaultConfig();
+    bool portals = true;
+    uint64_t maxTicks = 100000;
+    uint32_t seed = 1;
+    bool sweep = false;
+    NeuralNet network;  // for --bot neural, from --net
+};
+
+// Exact counts per value, grown on demand
+class Histogram {
+public:
+    void add(uint64_t value) {
+        if (value >= counts.size()) counts.resize(value + 1, 0);
+        counts[value]++;
+        total++;
+        sum += value;
+    }
+    void merge(const Histogram& other) {
+        if (other.counts.size() > counts.size()) counts.resize(other.counts.size(), 0);
+        for (size_t i = 0; i < other.counts.size(); ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum += other.sum;
+    }
+    uint64_t percentile(double p) const {
+        uint64_t rank = static_cast<uint64_t>(p * (total - 1));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen > rank) return i;
+        }
+        return 0;
+    }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+    uint64_t max() const { return counts.empty() ? 0 : counts.size() - 1; }
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t sum = 0;
+};
+
+// Everything one worker accumulates; padded so neighbours never share a line
+struct alignas(64) WorkerStats {
+    uint64_t games = 0;
+    uint64_t ticks = 0;
+    uint64_t outcomes[OUTCOME_COUNT] = {};
+    Histogram apples;  // score / 10
+    Histogram length;
+    Histogram gameTicks;
+};
+
+// Per-worker bot state: search buffers and cycles are built once per thread
+struct alignas(64) Player {
+    std::unique_ptr<Autopilot> autopilot;
+    std::unique_ptr<HamiltonianSolver> solver;
+    std::unique_ptr<NeuralPilot> neural;
+    std::mt19937 rng;
+};
+
+// Heads for the food along the longer axis first, avoiding any move that
+// runs straight into the body or off a walled board
+Direction greedyMove(const SimState& state, std::mt19937& rng) {
+    const Snake& snake = state.snake;
+    const GameConfig& config = state.config;
+    Point head = snake.getHead();
+    Point food = state.food.getPosition();
+    Direction current = snake.getCurrentDirection();
+
+    Direction preferred[4];
+    int count = 0;
+    Direction horizontal = food.x < head.x ? Direction::LEFT : Direction::RIGHT;
+    Direction vertical = food.y < head.y ? Direction::UP : Direction::DOWN;
+    if (std::abs(food.x - head.x) >= std::abs(food.y - head.y)) {
+        if (food.x != head.x) preferred[count++] = horizontal;
+        if (food.y != head.y) preferred[count++] = vertical;
+    } else {
+        if (food.y != head.y) preferred[count++] = vertical;
+        if (food.x != head.x) preferred[count++] = horizontal;
+    }
+    preferred[count++] = current;
+    preferred[count++] = static_cast<Direction>(boundedRandom(rng, 4));
+
+    for (int i = 0; i < count; ++i) {
+        Direction dir = preferred[i];
+        if (DirectionManager::isOpposite(dir, current)) continue;
+        Point next = head + DirectionManager::getDirectionVector(dir);
+        if (config.wrapAround) {
+            next = next.wrap(config.width, config.height);
+        } else if (next.x < 0 || next.x >= config.width || next.y < 0 || next.y >= config.height) {
+            continue;
+        }
+        if (next != snake.getBody().back() && snake.checkCollision(next)) continue;
+        return dir;
+    }
+    return current;
+}
+
+void playGame(const Options& options, uint64_t game, Player& player, WorkerStats& stats) {
+    SimState state(options.config, options.seed + static_cast<uint32_t>(game), options.portals);
+    player.rng.seed(options.seed ^ static_cast<uint32_t>(game * 0x9E3779B9u));
+
+    Outcome outcome = OUTCOME_TIMEOUT;
+    while (state.tick < options.maxTicks) {
+        Direction input;
+        switch (options.bot) {
+            case Bot::ASTAR: input = player.autopilot->decide(state); break;
+            case Bot::CYCLE: input = player.solver->decide(state); break;
+            case Bot::NEURAL: input = player.neural->decide(state); break;
+            default:         input = greedyMove(state, player.rng); break;
+        }
+        StepEvents events = step(state, input);
+        if (state.gameOver) {
+            if (state.won) {
+                outcome = OUTCOME_WON;
+            } else {
+                outcome = events.deathCause == DeathCause::WALL_COLLISION ? OUTCOME_WALL : OUTCOME_SELF;
+            }
+            break;
+        }
+    }
+
+    stats.games++;
+    stats.ticks += state.tick;
+    stats.outcomes[outcome]++;
+    stats.apples.add(static_cast<uint64_t>(state.score / POINTS_PER_FOOD));
+    stats.length.add(static_cast<uint64_t>(state.snake.getLength()));
+    stats.gameTicks.add(state.tick);
+}
+
+struct RunResult {
+    double seconds;
+    uint64_t steals;
+    std::vector<WorkerStats> workers;
+};
+
+RunResult run(const Options& options, unsigned threads) {
+    RunResult result;
+    result.workers.resize(threads);
+    std::vector<Player> players(threads);
+    for (auto& player : players) {
+        if (options.bot == Bot::ASTAR) player.autopilot = std::make_unique<Autopilot>();
+        if (options.bot == Bot::CYCLE) player.solver = std::make_unique<HamiltonianSolver>(options.config);
+        if (options.bot == Bot::NEURAL) player.neural = std::make_unique<NeuralPilot>(options.network);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    result.steals = runWorkStealing(options.games, threads, [&](unsigned worker, uint64_t game) {
+        playGame(options, game, players[worker], result.workers[worker]);
+    });
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void printDistribution(const char* name, const Histogram& histogram, uint64_t scale) {
+    std::printf("%-12s mean %10.1f  p10 %8llu  p50 %8llu  p90 %8llu  p99 %8llu  max %8llu\n",
+                name, histogram.mean() * scale,
+                static_cast<unsigned long long>(histogram.percentile(0.10) * scale),
+                static_cast<unsigned long long>(histogram.percentile(0.50) * scale),
+                static_cast<unsigned long long>(histogram.percentile(0.90) * scale),
+                static_cast<unsigned long long>(histogram.percentile(0.99) * scale),
+                static_cast<unsigned long long>(histogram.max() * scale));
+}
+
+void report(const RunResult& result, unsigned threads) {
+    WorkerStats total;
+    uint64_t fewest = UINT64_MAX;
+    uint64_t most = 0;
+    for (const auto& worker : result.workers) {
+        total.games += worker.games;
+        total.ticks += worker.ticks;
+        for (int i = 0; i < OUTCOME_COUNT; ++i) {
+            total.outcomes[i] += worker.outcomes[i];
+        }
+        total.apples.merge(worker.apples);
+        total.length.merge(worker.length);
+        total.gameTicks.merge(worker.gameTicks);
+        fewest = std::min(fewest, worker.games);
+        most = std::max(most, worker.games);
+    }
+
+    std::printf("%llu games on %u threads in %.3f s: %.0f games/s, %.0f ticks/s\n",
+                static_cast<unsigned long long>(total.games), threads, result.seconds,
+                total.games / result.seconds, total.ticks / result.seconds);
+    std::printf("per thread %llu-%llu games, %llu steals\n\n", static_cast<unsigned long long>(fewest),
+                static_cast<unsigned long long>(most), static_cast<unsigned long long>(result.steals));
+    printDistribution("score", total.apples, POINTS_PER_FOOD);
+    printDistribution("length", total.length, 1);
+    printDistribution("ticks", total.gameTicks, 1);
+    std::printf("\n");
+    for (int i = 0; i < OUTCOME_COUNT; ++i) {
+        std::printf("%-16s %10llu  %5.1f%%\n", OUTCOME_NAMES[i],
+                    static_cast<unsigned long long>(total.outcomes[i]),
+                    100.0 * total.outcomes[i] / std::max<uint64_t>(1, total.games));
+    }
+}
+
+bool parse(int argc, char** argv, Options& options) {
+    const char* network = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "-n") == 0 && hasValue) {
+            options.games = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "-j") == 0 && hasValue) {
+            options.threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(arg, "--bot") == 0 && hasValue) {
+            std::string name = argv[++i];
+            if (name == "greedy") options.bot = Bot::GREEDY;
+            else if (name == "astar") options.bot = Bot::ASTAR;
+            else if (name == "cycle") options.bot = Bot::CYCLE;
+            else if (name == "neural") options.bot = Bot::NEURAL;
+            else return false;
+        } else if (std::strcmp(arg, "--net") == 0 && hasValue) {
+            network = argv[++i];
+        } else if (std::strcmp(arg, "--size") == 0 && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.config.width, &options.config.height) != 2) return false;
+        } else if (std::strcmp(arg, "--walls") == 0) {
+            options.config.wrapAround = false;
+        } else if (std::strcmp(arg, "--no-portals") == 0) {
+            options.portals = false;
+        } else if (std::strcmp(arg, "--max-ticks") == 0 && hasValue) {
+            options.maxTicks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--sweep") == 0) {
+            options.sweep = true;
+        } else {
+            return false;
+        }
+    }
+    if (options.bot == Bot::NEURAL) {
+        NeuralCheckpoint checkpoint;
+        if (!network || !checkpoint.load(network)) return false;
+        options.network = checkpoint.networks.front();
+    }
+    return options.config.width > 2 && options.config.height > 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        std::fprintf(stderr, "usage: snake_selfplay [-n games] [-j threads] [--bot greedy|astar|cycle|neural]\n"
+                             "                      [--net file] [--size WxH] [--walls] [--no-portals]\n"
+                             "                      [--max-ticks N] [--seed N] [--sweep]\n");
+        return 2;
+    }
+    if (options.bot == Bot::CYCLE) {
+        options.portals = false;  // a teleport would take the snake off its cycle
+        if (!HamiltonianSolver(options.config).isValid()) {
+            std::fprintf(stderr, "snake_selfplay: no Hamiltonian cycle fits a %dx%d board\n",
+                         options.config.width, options.config.height);
+            return 2;
+        }
+    }
+
+    if (!options.sweep) {
+        report(run(options, options.threads), options.threads);
+        return 0;
+    }
+
+    double baseline = 0;
+    for (unsigned threads = 1;; threads = std::min(threads * 2, options.threads)) {
+        RunResult result = run(options, threads);
+        double rate = options.games / result.seconds;
+        if (threads == 1) baseline = rate;
+        std::printf("%4u threads %12.0f games/s  speedup %6.2f  efficiency %5.1f%%  %llu steals\n",
+                    threads, rate, rate / baseline, 100.0 * rate / baseline / threads,
+                    static_cast<unsigned long long>(result.steals));
+        if (threads == options.threads) break;
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Authoritative 1v1 game server. Clients connect over TCP or a Unix
+// socket, send JOIN and are paired into rooms, or send WATCH to spectate;
+// each tick the server steps every room and sends its players and
+// spectators a DELTA frame (see net_protocol.h).
+// Prints its counters every --stats seconds and once more on exit
+// (SIGINT or SIGTERM).
+// Usage: snake_server [--port N] [--address A] [--unix PATH] [--size WxH]
+//                     [--walls] [--tick ms] [--max-ticks N] [--stats s]
+
+#include "game_server.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr int DEFAULT_PORT = 7777;
+
+GameServer* running = nullptr;
+
+void onSignal(int) {
+    if (running) running->stop();
+}
+
+void printStats(const ServerStats& stats) {
+    std::printf("ticks %llu (%llu skipped)  rooms %zu  clients %zu (%zu watching)  games %llu/%llu  "
+                "dropped %llu  backlogs skipped %llu  sent %.1f MB  "
+                "tick work p50 %lld us p99 %lld us max %lld us  late p99 %lld us\n",
+                static_cast<unsigned long long>(stats.ticks),
+                static_cast<unsigned long long>(stats.skippedTicks), stats.rooms, stats.clients, stats.spectators,
+                static_cast<unsigned long long>(stats.gamesFinished),
+                static_cast<unsigned long long>(stats.gamesStarted),
+                static_cast<unsigned long long>(stats.dropped),
+                static_cast<unsigned long long>(stats.keyframeSkips), stats.bytesSent / 1048576.0,
+                static_cast<long long>(stats.tickP50.count()), static_cast<long long>(stats.tickP99.count()),
+                static_cast<long long>(stats.tickMax.count()),
+                static_cast<long long>(stats.schedule.jitterP99.count()));
+    std::fflush(stdout);
+}
+
+bool parseArgs(int argc, char** argv, ServerOptions& options, int& statsSeconds) {
+    options.port = DEFAULT_PORT;
+    options.config.wrapAround = true;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--port") == 0 && hasValue) {
+            options.port = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--address") == 0 && hasValue) {
+            options.address = argv[++i];
+        } else if (std::strcmp(arg, "--unix") == 0 && hasValue) {
+            options.unixPath = argv[++i];
+        } else if (std::strcmp(arg, "--size") == 0 && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.config.width, &options.config.height) != 2) return false;
+        } else if (std::strcmp(arg, "--walls") == 0) {
+            options.config.wrapAround = false;
+        } else if (std::strcmp(arg, "--tick") == 0 && hasValue) {
+            options.tick = std::chrono::milliseconds(std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--max-ticks") == 0 && hasValue) {
+            options.maxTicks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--stats") == 0 && hasValue) {
+            statsSeconds = std::atoi(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return options.config.width >= MIN_WORLD_SIZE && options.config.height >= MIN_WORLD_SIZE &&
+           options.config.width <= MAX_WORLD_SIZE && options.config.height <= MAX_WORLD_SIZE &&
+           options.tick.count() > 0 && options.port <= 65535;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ServerOptions options;
+    int statsSeconds = 10;
+    if (!parseArgs(argc, argv, options, statsSeconds)) {
+        std::fprintf(stderr, "usage: snake_server [--port N] [--address A] [--unix PATH] [--size WxH]\n"
+                             "                    [--walls] [--tick ms] [--max-ticks N] [--stats s]\n");
+        return 1;
+    }
+
+    GameServer server(options);
+    if (!server.start()) {
+        std::fprintf(stderr, "snake_server: %s\n", server.getError().c_str());
+        return 1;
+    }
+    std::printf("snake_server: %dx%d %s, %lld ms ticks", options.config.width, options.config.height,
+                options.config.wrapAround ? "wrap-around" : "walls",
+                static_cast<long long>(options.tick.count()));
+    if (server.getPort() >= 0) std::printf(", tcp %s:%d", options.address.c_str(), server.getPort());
+    if (!options.unixPath.empty()) std::printf(", unix %s", options.unixPath.c_str());
+    std::printf("\n");
+    std::fflush(stdout);
+
+    running = &server;
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (statsSeconds > 0) {
+        auto ticks = std::chrono::seconds(statsSeconds) / options.tick;
+        server.setReporter(static_cast<uint64_t>(std::max<long long>(ticks, 1)), printStats);
+    }
+    server.run();
+    printStats(server.getStats());
+    return 0;
+}
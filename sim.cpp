@@ -0,0 +1,96 @@
+#include "sim.h"
+
+namespace SnakeGame {
+
+SimState::SimState(const GameConfig& config, uint32_t seed, bool enablePortals)
+    : config(config)
+    , snake(config.width / 2, config.height / 2, 3, config.width, config.height)
+    , food(config, seed)
+    , seed(seed)
+    , tick(0)
+    , score(0)
+    , gameOver(false)
+    , won(false)
+    , tickDuration(config.initialSpeed)
+    , clock() {
+    if (enablePortals) {
+        portals = makeCornerPortals(config);
+    }
+    for (const auto& portal : portals) {
+        snake.excludeFromSpawning(portal.position);
+    }
+    if (!food.place(snake, config)) {
+        gameOver = true;
+        won = true;
+    }
+}
+
+std::vector<Portal> makeCornerPortals(const GameConfig& config) {
+    Point topLeft(1, 1);
+    Point bottomRight(config.width - 2, config.height - 2);
+    return {
+        {topLeft, bottomRight, true},
+        {bottomRight, topLeft, true}
+    };
+}
+
+StepEvents step(SimState& state, Direction input) {
+    StepEvents events;
+    if (state.gameOver) return events;
+
+    Snake& snake = state.snake;
+    const GameConfig& config = state.config;
+
+    state.tick++;
+    state.clock += state.tickDuration;
+
+    Direction dir = snake.getCurrentDirection();
+    if (input != Direction::NONE && !DirectionManager::isOpposite(input, dir)) {
+        dir = input;
+    }
+
+    // A snake that just came out of a portal sits still for one tick
+    bool wasTeleporting = snake.isTeleporting();
+    snake.move(dir, config);
+    events.moved = !wasTeleporting;
+
+    if (snake.checkSelfCollision()) {
+        events.deathCause = DeathCause::SELF_COLLISION;
+    } else if (config.mode == GameMode::CLASSIC && snake.checkWallCollision(config)) {
+        events.deathCause = DeathCause::WALL_COLLISION;
+    }
+    if (events.deathCause != DeathCause::NONE) {
+        events.died = true;
+        state.gameOver = true;
+        return events;
+    }
+
+    if (wasTeleporting) {
+        snake.setTeleporting(false);
+    } else {
+        Point head = snake.getHead();
+        for (const auto& portal : state.portals) {
+            if (portal.active && head == portal.position) {
+                snake.teleportTo(portal.destination);
+                events.teleported = true;
+                break;
+            }
+        }
+    }
+
+    if (snake.getHead() == state.food.getPosition()) {
+        snake.grow(state.clock);
+        events.ateFood = true;
+        events.pointsGained = 10 * snake.getComboMultiplier();
+        state.score += events.pointsGained;
+        if (!state.food.respawn(snake)) {
+            events.boardFull = true;
+            state.gameOver = true;
+            state.won = true;
+        }
+    }
+
+    return events;
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include "constants.h"
+#include "direction.h"
+#include "snake.h"
+#include "food.h"
+#include "portal.h"
+
+namespace SnakeGame {
+
+enum class DeathCause {
+    NONE,
+    SELF_COLLISION,
+    WALL_COLLISION,
+    // Arena only: into any snake's body (its own included), or two heads
+    // into one cell
+    SNAKE_COLLISION,
+    HEAD_ON_COLLISION
+};
+
+// Everything that happened during a single tick
+struct StepEvents {
+    bool moved = false;
+    bool ateFood = false;
+    bool teleported = false;
+    bool died = false;
+    bool boardFull = false;  // no cell left for food: the player has won
+    DeathCause deathCause = DeathCause::NONE;
+    int pointsGained = 0;
+};
+
+// Complete state of one game. Holds no console or timing resources, so it
+// can be stepped headless and copied freely.
+struct SimState {
+    SimState(const GameConfig& config, uint32_t seed, bool enablePortals = true);
+
+    GameConfig config;
+    Snake snake;
+    Food food;
+    std::vector<Portal> portals;
+    uint32_t seed;
+    uint64_t tick;
+    int score;
+    bool gameOver;
+    bool won;
+
+    // Simulated clock used for the combo window. Advances by tickDuration
+    // on every step so results depend only on the inputs.
+    std::chrono::milliseconds tickDuration;
+    std::chrono::steady_clock::time_point clock;
+};
+
+// Two linked portals at opposite corners of the playfield
+std::vector<Portal> makeCornerPortals(const GameConfig& config);
+
+// Advance the game by one tick. Direction::NONE keeps the current heading
+// and a reversal onto the snake's own neck is ignored.
+StepEvents step(SimState& state, Direction input);
+
+} // namespace SnakeGame
@@ -4,15 +4,23 @@
 
 namespace SnakeGame {
 
-Snake::Snake(int startX, int startY, int initialLength)
-    : currentDirection(Direction::RIGHT)
+Snake::Snake(int startX, int startY, int initialLength, int gridWidth, int gridHeight)
+    : occupancy(gridWidth, gridHeight)
+    , currentDirection(Direction::RIGHT)
     , isReversed(false)
     , isInPortal(false)
-    , comboState{0, std::chrono::steady_clock::now()} {
-    // Initialize snake body
+    , headOffBoard(false)
+    , comboState{0, std::chrono::steady_clock::now()}
+    , moveCount(0)
+    , growCount(0) {
+    // Initialize snake body with the head at the start position, trailing left
     for (int i = 0; i < initialLength; ++i) {
-        body.push_front(Point(startX - i, startY));
+        body.pushBack(Point(startX - i, startY));
+        occupancy.add(body.back());
     }
+    
+    // Food spawns strictly inside the border walls
+    occupancy.enableFreeCellIndex(1, 1, gridWidth - 2, gridHeight - 2);
 }
 
 void Snake::move(Direction dir, const GameConfig& config) {
@@ -30,6 +38,7 @@ void Snake::move(Direction dir, const GameConfig& config) {
             case Direction::DOWN: currentDirection = Direction::UP; break;
             case Direction::LEFT: currentDirection = Direction::RIGHT; break;
             case Direction::RIGHT: currentDirection = Direction::LEFT; break;
+            default: currentDirection = dir; break;
         }
     }
     
@@ -39,21 +48,23 @@ void Snake::move(Direction dir, const GameConfig& config) {
         case Direction::DOWN: newHead.y++; break;
         case Direction::LEFT: newHead.x--; break;
         case Direction::RIGHT: newHead.x++; break;
+        default: break;
     }
     
     updatePosition(newHead, config);
 }
 
-void Snake::grow() {
+void Snake::grow(std::chrono::steady_clock::time_point now) {
     // Add new segment at the end
-    body.push_back(body.back());
+    body.pushBack(body.back());
+    occupancy.add(body.back());
+    ++growCount;
     
     // Update combo
-    updateCombo();
+    updateCombo(now);
 }
 
-void Snake::updateCombo() {
-    auto now = std::chrono::steady_clock::now();
+void Snake::updateCombo(std::chrono::steady_clock::time_point now) {
     auto timeSinceLastFood = std::chrono::duration_cast<std::chrono::milliseconds>(
         now - comboState.lastFoodTime).count();
     
@@ -72,10 +83,12 @@ int Snake::getComboMultiplier() const {
 
 void Snake::teleportTo(const Point& newPosition) {
     isInPortal = true;
-    body.front() = newPosition;
+    occupancy.remove(body.front());
+    body.setFront(newPosition);
+    occupancy.add(body.front());
 }
 
-void Snake::updatePosition(const Point& newHead, const GameConfig& config) {
+void Snake::updatePosition(Point newHead, const GameConfig& config) {
     // Handle wrapping around the screen
     if (config.wrapAround) {
         if (newHead.x < 0) newHead.x = config.width - 1;
@@ -84,21 +97,41 @@ void Snake::updatePosition(const Point& newHead, const GameConfig& config) {
         if (newHead.y >= config.height) newHead.y = 0;
     }
     
-    body.push_front(newHead);
-    body.pop_back();
+    headOffBoard = newHead.x < 0 || newHead.x >= config.width || newHead.y < 0 || newHead.y >= config.height;
+    
+    Point tail = body.back();
+    body.advance(newHead);
+    occupancy.add(body.front());
+    occupancy.remove(tail);
+    ++moveCount;
 }
 
 bool Snake::checkCollision(const Point& point) const {
-    return std::find(body.begin(), body.end(), point) != body.end();
+    if (occupancy.contains(point)) {
+        return occupancy.isOccupied(point);
+    }
+    return scanBody(point, 0);
 }
 
 bool Snake::checkSelfCollision() const {
     auto head = body.front();
-    return std::find(body.begin() + 1, body.end(), head) != body.end();
+    if (occupancy.contains(head)) {
+        return occupancy.count(head) > 1;
+    }
+    return scanBody(head, 1);
+}
+
+bool Snake::scanBody(const Point& point, size_t from) const {
+    uint32_t packed = SnakeBody::pack(point);
+    for (size_t i = from; i < body.size(); ++i) {
+        if (body.packedAt(i) == packed) return true;
+    }
+    return false;
 }
 
 bool Snake::checkWallCollision(const GameConfig& config) const {
     if (config.wrapAround) return false;
+    if (headOffBoard) return true;
     
     auto head = body.front();
     return head.x < 0 || head.x >= config.width || 
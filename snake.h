@@ -1,10 +1,13 @@
 #pragma once
 
-#include <deque>
 #include <memory>
 #include <chrono>
+#include <cstdint>
 #include "point.h"
 #include "direction.h"
+#include "constants.h"
+#include "occupancy.h"
+#include "snake_body.h"
 
 namespace SnakeGame {
 
@@ -16,22 +19,34 @@ struct ComboState {
 
 class Snake {
 public:
-    Snake(int startX, int startY, int initialLength = 3);
+    // The grid size bounds the occupancy index; segments outside it are
+    // still handled, just without the constant-time lookup.
+    Snake(int startX, int startY, int initialLength = 3,
+          int gridWidth = DEFAULT_WIDTH, int gridHeight = DEFAULT_HEIGHT);
     
     void move(Direction dir, const GameConfig& config);
-    void grow();
+    // Growth is timestamped so headless runs can drive the combo window
+    // from a simulated clock instead of the wall clock.
+    void grow(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
     bool checkCollision(const Point& point) const;
     bool checkSelfCollision() const;
     bool checkWallCollision(const GameConfig& config) const;
     
-    const std::deque<Point>& getBody() const { return body; }
+    const SnakeBody& getBody() const { return body; }
+    const OccupancyGrid& getOccupancy() const { return occupancy; }
+    // Keep food from spawning on a cell the snake does not own (e.g. a portal)
+    void excludeFromSpawning(const Point& cell) { occupancy.excludeFromFreeCells(cell); }
     Point getHead() const { return body.front(); }
-    int getLength() const { return body.size(); }
+    int getLength() const { return static_cast<int>(body.size()); }
     Direction getCurrentDirection() const { return currentDirection; }
+    // Monotonic counters so observers (e.g. the replay encoder) can tell
+    // what changed since they last looked without diffing the body
+    uint64_t getMoveCount() const { return moveCount; }
+    uint64_t getGrowCount() const { return growCount; }
     
     // Combo system
     int getCurrentCombo() const { return comboState.currentCombo; }
-    void updateCombo();
+    void updateCombo(std::chrono::steady_clock::time_point now);
     int getComboMultiplier() const;
     
     // Portal system
@@ -40,13 +55,21 @@ public:
     void setTeleporting(bool value) { isInPortal = value; }
 
 private:
-    std::deque<Point> body;
+    SnakeBody body;
+    OccupancyGrid occupancy;
     Direction currentDirection;
     bool isReversed;
     bool isInPortal;
+    // Cells are packed modulo 65536 (see SnakeBody), so on a 65536-wide
+    // board the cell past the wall reads back as an edge cell; the last
+    // move remembers whether it left the board instead
+    bool headOffBoard;
     ComboState comboState;
+    uint64_t moveCount;
+    uint64_t growCount;
 
-    void updatePosition(const Point& newHead, const GameConfig& config);
+    void updatePosition(Point newHead, const GameConfig& config);
+    bool scanBody(const Point& point, size_t from) const;
 };
 
 } // namespace SnakeGame 
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "snake_body.h"
+#include <algorithm>
+
+namespace SnakeGame {
+
+namespace {
+
+size_t roundUpToPowerOfTwo(size_t n) {
+    size_t capacity = 1;
+    while (capacity < n) capacity <<= 1;
+    return capacity;
+}
+
+} // namespace
+
+SnakeBody::SnakeBody(size_t initialCapacity)
+    : cells(roundUpToPowerOfTwo(initialCapacity > 0 ? initialCapacity : 1), 0)
+    , start(0)
+    , count(0)
+    , mask(cells.size() - 1) {
+}
+
+void SnakeBody::pushFront(const Point& p) {
+    reserveForOneMore();
+    start = (start - 1) & mask;
+    cells[start] = pack(p);
+    ++count;
+}
+
+void SnakeBody::pushBack(const Point& p) {
+    reserveForOneMore();
+    cells[(start + count) & mask] = pack(p);
+    ++count;
+}
+
+std::pair<SnakeBody::Span, SnakeBody::Span> SnakeBody::spans() const {
+    size_t firstSize = std::min(count, cells.size() - start);
+    Span first{cells.data() + start, firstSize};
+    Span second{cells.data(), count - firstSize};
+    return {first, second};
+}
+
+void SnakeBody::reserveForOneMore() {
+    if (count < cells.size()) return;
+
+    // Unroll into a fresh buffer twice the size, head at slot 0
+    std::vector<uint32_t> grown(cells.size() * 2, 0);
+    for (size_t i = 0; i < count; ++i) {
+        grown[i] = cells[(start + i) & mask];
+    }
+    cells.swap(grown);
+    start = 0;
+    mask = cells.size() - 1;
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "point.h"
+
+namespace SnakeGame {
+
+// Snake segments stored head-first in a power-of-two ring of packed cells.
+// Each cell is 32 bits: x in the low half, y in the high half, both kept
+// modulo 65536, so an off-board coordinate such as -1 reads back as 65535.
+// Moving the snake rewrites a single slot and never allocates; the ring
+// only reallocates when pushBack outgrows the capacity.
+class SnakeBody {
+public:
+    // Contiguous run of packed cells; a ring exposes at most two of them
+    struct Span {
+        const uint32_t* data;
+        size_t size;
+    };
+
+    class const_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Point;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Point*;
+        using reference = Point;
+
+        const_iterator(const SnakeBody* body = nullptr, size_t index = 0)
+            : body(body), index(index) {}
+
+        Point operator*() const { return (*body)[index]; }
+        const_iterator& operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++index; return old; }
+        const_iterator operator+(difference_type n) const { return const_iterator(body, index + n); }
+        difference_type operator-(const const_iterator& other) const {
+            return static_cast<difference_type>(index) - static_cast<difference_type>(other.index);
+        }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+
+    private:
+        const SnakeBody* body;
+        size_t index;
+    };
+
+    explicit SnakeBody(size_t initialCapacity = 16);
+
+    static uint32_t pack(const Point& p) {
+        return static_cast<uint32_t>(static_cast<uint16_t>(p.x)) |
+               (static_cast<uint32_t>(static_cast<uint16_t>(p.y)) << 16);
+    }
+    static Point unpack(uint32_t cell) {
+        return Point(static_cast<int>(cell & 0xFFFF), static_cast<int>(cell >> 16));
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return cells.size(); }
+
+    Point operator[](size_t i) const { return unpack(cells[(start + i) & mask]); }
+    Point front() const { return unpack(cells[start]); }
+    Point back() const { return unpack(cells[(start + count - 1) & mask]); }
+    uint32_t packedAt(size_t i) const { return cells[(start + i) & mask]; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+
+    // Pop the tail and push a new head in one slot write
+    void advance(const Point& newHead) {
+        start = (start - 1) & mask;
+        cells[start] = pack(newHead);
+    }
+    void setFront(const Point& p) { cells[start] = pack(p); }
+    void pushFront(const Point& p);
+    void pushBack(const Point& p);
+    void popBack() { --count; }
+    void clear() { start = 0; count = 0; }
+
+    // Head-to-tail order: first span, then second (possibly empty)
+    std::pair<Span, Span> spans() const;
+
+private:
+    std::vector<uint32_t> cells;
+    size_t start;
+    size_t count;
+    size_t mask;
+
+    void reserveForOneMore();
+};
+
+} // namespace SnakeGame
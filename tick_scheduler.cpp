@@ -0,0 +1,94 @@
+#include "tick_scheduler.h"
+#include <algorithm>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <time.h>
+#endif
+
+namespace SnakeGame {
+
+TickScheduler::TickScheduler(std::chrono::nanoseconds period, int maxCatchUp)
+    : period(period)
+    , maxCatchUp(std::max(maxCatchUp, 1))
+    , deadline(Clock::now() + period)
+    , ticks(0)
+    , skippedTicks(0)
+    , jitterMax(0) {
+    jitterHistogram.fill(0);
+}
+
+void TickScheduler::start(Clock::time_point now) {
+    deadline = now + period;
+}
+
+int TickScheduler::ticksDue(Clock::time_point now) {
+    int due = 0;
+    while (now >= deadline && due < maxCatchUp) {
+        recordJitter(now - deadline);
+        deadline += period;
+        due++;
+    }
+
+    if (now >= deadline) {
+        // Too far behind to catch up: drop whole periods, keep the phase
+        auto behind = (now - deadline) / period + 1;
+        deadline += behind * period;
+        skippedTicks += static_cast<uint64_t>(behind);
+    }
+
+    ticks += due;
+    return due;
+}
+
+void TickScheduler::setPeriod(std::chrono::nanoseconds newPeriod) {
+    if (newPeriod == period || newPeriod.count() <= 0) return;
+    Clock::time_point lastDeadline = deadline - period;
+    period = newPeriod;
+    deadline = lastDeadline + period;
+}
+
+void TickScheduler::sleepUntil(Clock::time_point when) {
+#ifdef _WIN32
+    std::this_thread::sleep_until(when);
+#else
+    // steady_clock is CLOCK_MONOTONIC on the platforms we build for
+    auto since = std::chrono::duration_cast<std::chrono::nanoseconds>(when.time_since_epoch());
+    struct timespec target;
+    target.tv_sec = static_cast<time_t>(since.count() / 1000000000);
+    target.tv_nsec = static_cast<long>(since.count() % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr) == EINTR) {
+    }
+#endif
+}
+
+TickStats TickScheduler::getStats() const {
+    return {ticks, skippedTicks, percentile(0.50), percentile(0.99), jitterMax};
+}
+
+void TickScheduler::recordJitter(std::chrono::nanoseconds lateness) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(lateness);
+    jitterMax = std::max(jitterMax, us);
+    size_t bucket = std::min(static_cast<size_t>(us.count() / BUCKET_US), BUCKETS);
+    jitterHistogram[bucket]++;
+}
+
+std::chrono::microseconds TickScheduler::percentile(double fraction) const {
+    uint64_t total = 0;
+    for (uint32_t count : jitterHistogram) total += count;
+    if (total == 0) return std::chrono::microseconds(0);
+
+    uint64_t target = static_cast<uint64_t>(fraction * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket <= BUCKETS; ++bucket) {
+        seen += jitterHistogram[bucket];
+        if (seen >= target) {
+            if (bucket == BUCKETS) return jitterMax;
+            return std::chrono::microseconds((bucket + 1) * BUCKET_US);
+        }
+    }
+    return jitterMax;
+}
+
+} // namespace SnakeGame
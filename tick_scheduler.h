@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace SnakeGame {
+
+// Tick timing statistics. Jitter is how late each tick ran relative to its
+// scheduled deadline.
+struct TickStats {
+    uint64_t ticks;
+    uint64_t skippedTicks;  // dropped because catch-up hit its limit
+    std::chrono::microseconds jitterP50;
+    std::chrono::microseconds jitterP99;
+    std::chrono::microseconds jitterMax;
+};
+
+// Fixed-timestep scheduler. Deadlines advance by exactly one period per
+// tick from the start time, so lateness in one tick never shifts the ones
+// after it. When the caller falls behind it may run up to maxCatchUp ticks
+// in a burst; beyond that whole periods are skipped, keeping the phase.
+class TickScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TickScheduler(std::chrono::nanoseconds period, int maxCatchUp = 5);
+
+    // Anchor the first deadline one period after now
+    void start(Clock::time_point now = Clock::now());
+
+    // How many ticks to run now; each one is counted as executed
+    int ticksDue(Clock::time_point now = Clock::now());
+
+    // Change the period, measured from the last deadline so the tick
+    // already in progress keeps its phase
+    void setPeriod(std::chrono::nanoseconds newPeriod);
+    std::chrono::nanoseconds getPeriod() const { return period; }
+
+    Clock::time_point nextDeadline() const { return deadline; }
+
+    // Sleep until an absolute time (clock_nanosleep TIMER_ABSTIME on POSIX)
+    static void sleepUntil(Clock::time_point when);
+
+    TickStats getStats() const;
+
+private:
+    // Jitter histogram: 10 us buckets up to 100 ms, plus an overflow bucket
+    static constexpr int BUCKET_US = 10;
+    static constexpr size_t BUCKETS = 10000;
+
+    std::chrono::nanoseconds period;
+    int maxCatchUp;
+    Clock::time_point deadline;
+    uint64_t ticks;
+    uint64_t skippedTicks;
+    std::chrono::microseconds jitterMax;
+    std::array<uint32_t, BUCKETS + 1> jitterHistogram;
+
+    void recordJitter(std::chrono::nanoseconds lateness);
+    std::chrono::microseconds percentile(double fraction) const;
+};
+
+} // namespace SnakeGame
@@ -0,0 +1,274 @@
+// Neuroevolution trainer for NeuralNet controllers.
+// Each generation, every network plays the same few headless games; a
+// game ends on death, on a full board or when the snake goes too long
+// without eating. Networks are scored on apples eaten, with a small bonus
+// per tick survived to break ties early on. Networks go through the pool in
+// blocks of NeuralBatch::LANES that play in lockstep, so one SIMD forward
+// pass moves every snake in the block. The next generation keeps the best
+// twentieth as is and breeds the rest by tournament selection, uniform
+// crossover and Gaussian mutation. The population is saved, best first,
+// after every generation; snake_game --neural plays the first network.
+// Usage: snake_train [-p population] [-g generations] [--games N] [-j threads]
+//                    [--size WxH] [--walls] [--no-portals] [--max-ticks N]
+//                    [--seed N] [--out file] [--resume file]
+
+#include "neural.h"
+#include "rng.h"
+#include "sim.h"
+#include "work_stealing.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SnakeGame;
+
+namespace {
+
+constexpr int LANES = NeuralBatch::LANES;
+constexpr int INITIAL_LENGTH = 3;
+constexpr double TICK_BONUS = 0.001;
+constexpr int TOURNAMENT = 3;
+constexpr double MUTATION_RATE = 0.05;
+constexpr double MUTATION_SIGMA = 0.2;
+
+struct Options {
+    size_t population = 1000;
+    uint32_t generations = 50;
+    uint32_t games = 4;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    GameConfig config = GameConfig::defaultConfig();
+    bool portals = true;
+    uint64_t maxTicks = 5000;
+    uint32_t seed = 1;
+    std::string out = "snake_net.bin";
+    std::string resume;
+};
+
+// Per worker; padded so neighbours never share a line
+struct alignas(64) Worker {
+    NeuralBatch batch;
+    uint64_t ticks = 0;
+};
+
+// Standard normal draw (Box-Muller)
+double gaussian(std::mt19937& rng) {
+    double u = 1.0 - unitRandom(rng);  // (0, 1], so the log is finite
+    double v = unitRandom(rng);
+    return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * v);
+}
+
+NeuralNet randomNet(std::mt19937& rng) {
+    NeuralNet net;
+    auto fill = [&](size_t begin, int units, int fanIn) {
+        float scale = 1.0f / std::sqrt(static_cast<float>(fanIn));
+        for (size_t i = begin; i < begin + static_cast<size_t>(units) * (fanIn + 1); ++i) {
+            net.weights[i] = static_cast<float>((2.0 * unitRandom(rng) - 1.0) * scale);
+        }
+    };
+    fill(0, NeuralNet::HIDDEN, NeuralNet::INPUTS);
+    fill(static_cast<size_t>(NeuralNet::HIDDEN) * (NeuralNet::INPUTS + 1), NeuralNet::OUTPUTS, NeuralNet::HIDDEN);
+    return net;
+}
+
+// Plays `options.games` games with up to LANES networks side by side and
+// stores each network's mean fitness in fitness[0..count)
+void evaluateBlock(const Options& options, uint32_t generation, const NeuralNet* const* nets, int count,
+                   Worker& worker, float* fitness) {
+    worker.batch.load(nets, count);
+    // No apple in this many ticks ends the game; enough to cross the board
+    // a few times, too few to circle forever
+    const uint64_t starveTicks = std::max(100, options.config.width * options.config.height / 4);
+
+    float features[NeuralNet::INPUTS];
+    float inputs[NeuralNet::INPUTS * LANES] = {};
+    float outputs[NeuralNet::OUTPUTS * LANES];
+    double total[LANES] = {};
+    for (uint32_t game = 0; game < options.games; ++game) {
+        // Every network plays the same boards within a generation
+        uint32_t seed = options.seed + generation * options.games + game;
+        std::vector<SimState> states(count, SimState(options.config, seed, options.portals));
+        uint64_t sinceFood[LANES] = {};
+        bool live[LANES] = {};
+        int playing = count;
+        std::fill(live, live + count, true);
+
+        while (playing > 0) {
+            for (int l = 0; l < count; ++l) {
+                if (!live[l]) continue;
+                extractFeatures(states[l], features);
+                for (int i = 0; i < NeuralNet::INPUTS; ++i) inputs[i * LANES + l] = features[i];
+            }
+            worker.batch.forward(inputs, outputs);
+
+            for (int l = 0; l < count; ++l) {
+                if (!live[l]) continue;
+                SimState& state = states[l];
+                Direction input = state.snake.isTeleporting()
+                    ? Direction::NONE
+                    : relativeMove(state.snake.getCurrentDirection(), bestMove(outputs + l, LANES));
+                StepEvents events = step(state, input);
+                sinceFood[l] = events.ateFood ? 0 : sinceFood[l] + 1;
+                if (state.gameOver || sinceFood[l] > starveTicks || state.tick >= options.maxTicks) {
+                    live[l] = false;
+                    playing--;
+                    worker.ticks += state.tick;
+                    total[l] += (state.snake.getLength() - INITIAL_LENGTH) + TICK_BONUS * state.tick;
+                }
+            }
+        }
+    }
+    for (int l = 0; l < count; ++l) {
+        fitness[l] = static_cast<float>(total[l] / options.games);
+    }
+}
+
+// Winner of a size-TOURNAMENT tournament, as an index into the population
+size_t tournament(const std::vector<float>& fitness, std::mt19937& rng) {
+    size_t best = boundedRandom(rng, static_cast<uint32_t>(fitness.size()));
+    for (int i = 1; i < TOURNAMENT; ++i) {
+        size_t other = boundedRandom(rng, static_cast<uint32_t>(fitness.size()));
+        if (fitness[other] > fitness[best]) best = other;
+    }
+    return best;
+}
+
+// The next generation from one sorted best first
+std::vector<NeuralNet> breed(const std::vector<NeuralNet>& sorted, const std::vector<float>& fitness,
+                             std::mt19937& rng) {
+    size_t elites = std::max<size_t>(1, sorted.size() / 20);
+    std::vector<NeuralNet> next(sorted.begin(), sorted.begin() + elites);
+    next.reserve(sorted.size());
+    while (next.size() < sorted.size()) {
+        const NeuralNet& mother = sorted[tournament(fitness, rng)];
+        const NeuralNet& father = sorted[tournament(fitness, rng)];
+        NeuralNet child;
+        for (int k = 0; k < NeuralNet::WEIGHTS; ++k) {
+            float w = (rng() & 1) ? mother.weights[k] : father.weights[k];
+            if (unitRandom(rng) < MUTATION_RATE) {
+                w += static_cast<float>(MUTATION_SIGMA * gaussian(rng));
+            }
+            child.weights[k] = w;
+        }
+        next.push_back(std::move(child));
+    }
+    return next;
+}
+
+bool parse(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "-p") == 0 && hasValue) {
+            options.population = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "-g") == 0 && hasValue) {
+            options.generations = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--games") == 0 && hasValue) {
+            options.games = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(arg, "-j") == 0 && hasValue) {
+            options.threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(arg, "--size") == 0 && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.config.width, &options.config.height) != 2) return false;
+        } else if (std::strcmp(arg, "--walls") == 0) {
+            options.config.wrapAround = false;
+        } else if (std::strcmp(arg, "--no-portals") == 0) {
+            options.portals = false;
+        } else if (std::strcmp(arg, "--max-ticks") == 0 && hasValue) {
+            options.maxTicks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--out") == 0 && hasValue) {
+            options.out = argv[++i];
+        } else if (std::strcmp(arg, "--resume") == 0 && hasValue) {
+            options.resume = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return options.population >= 2 && options.config.width > 3 && options.config.height > 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        std::fprintf(stderr, "usage: snake_train [-p population] [-g generations] [--games N] [-j threads]\n"
+                             "                   [--size WxH] [--walls] [--no-portals] [--max-ticks N]\n"
+                             "                   [--seed N] [--out file] [--resume file]\n");
+        return 2;
+    }
+
+    std::mt19937 rng(options.seed);
+    std::vector<NeuralNet> population;
+    uint32_t generation = 0;
+    if (!options.resume.empty()) {
+        NeuralCheckpoint checkpoint;
+        if (!checkpoint.load(options.resume)) {
+            std::fprintf(stderr, "snake_train: cannot load checkpoint %s\n", options.resume.c_str());
+            return 1;
+        }
+        // Keep training under the rules the networks learned
+        options.config = checkpoint.config;
+        generation = checkpoint.generation;
+        // The saved generation has been scored already; carry on from its children
+        population = breed(checkpoint.networks, checkpoint.fitness, rng);
+        population.resize(std::min(population.size(), options.population));
+    }
+    while (population.size() < options.population) {
+        population.push_back(randomNet(rng));
+    }
+
+    std::vector<Worker> workers(options.threads);
+    std::vector<float> fitness(population.size());
+    std::printf("%zu networks, %u games each, %dx%d %s%s, %u threads\n", population.size(), options.games,
+                options.config.width, options.config.height,
+                options.config.wrapAround ? "wrap-around" : "walls", options.portals ? " with portals" : "",
+                options.threads);
+
+    for (uint32_t end = generation + options.generations; generation < end; ++generation) {
+        for (auto& worker : workers) worker.ticks = 0;
+        uint64_t blocks = (population.size() + LANES - 1) / LANES;
+        auto start = std::chrono::steady_clock::now();
+        runWorkStealing(blocks, options.threads, [&](unsigned worker, uint64_t block) {
+            size_t first = static_cast<size_t>(block) * LANES;
+            int count = static_cast<int>(std::min<size_t>(LANES, population.size() - first));
+            const NeuralNet* nets[LANES];
+            for (int l = 0; l < count; ++l) nets[l] = &population[first + l];
+            evaluateBlock(options, generation, nets, count, workers[worker], fitness.data() + first);
+        });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<size_t> order(population.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return fitness[a] > fitness[b]; });
+        NeuralCheckpoint checkpoint;
+        checkpoint.generation = generation + 1;
+        checkpoint.config = options.config;
+        for (size_t i : order) {
+            checkpoint.networks.push_back(population[i]);
+            checkpoint.fitness.push_back(fitness[i]);
+        }
+
+        uint64_t ticks = 0;
+        for (const auto& worker : workers) ticks += worker.ticks;
+        double mean = std::accumulate(fitness.begin(), fitness.end(), 0.0) / fitness.size();
+        std::printf("gen %4u  best %7.2f  mean %7.2f  %6.2f s  %8.0f networks/s  %6.1fM ticks/s\n",
+                    generation + 1, checkpoint.fitness[0], mean, seconds, population.size() / seconds,
+                    ticks / seconds / 1e6);
+        std::fflush(stdout);
+        if (!checkpoint.save(options.out)) {
+            std::fprintf(stderr, "snake_train: cannot write %s\n", options.out.c_str());
+            return 1;
+        }
+
+        population = breed(checkpoint.networks, checkpoint.fitness, rng);
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "viewport.h"
+#include <algorithm>
+
+namespace SnakeGame {
+
+Viewport::Viewport(int worldWidth, int worldHeight, bool wraps)
+    : worldWidth(std::max(worldWidth, 0))
+    , worldHeight(std::max(worldHeight, 0))
+    , wraps(wraps)
+    , columns(this->worldWidth)
+    , rows(this->worldHeight)
+    , originX(0)
+    , originY(0) {
+}
+
+void Viewport::resize(int newColumns, int newRows) {
+    columns = std::clamp(newColumns, 0, worldWidth);
+    rows = std::clamp(newRows, 0, worldHeight);
+    originX = settle(originX, columns, worldWidth);
+    originY = settle(originY, rows, worldHeight);
+}
+
+void Viewport::follow(const Point& focus) {
+    originX = scroll(originX, focus.x, columns, worldWidth);
+    originY = scroll(originY, focus.y, rows, worldHeight);
+}
+
+void Viewport::centerOn(const Point& focus) {
+    originX = settle(focus.x - columns / 2, columns, worldWidth);
+    originY = settle(focus.y - rows / 2, rows, worldHeight);
+}
+
+Point Viewport::toWorld(const Point& screen) const {
+    int x = originX + screen.x;
+    int y = originY + screen.y;
+    if (wraps) {
+        if (x >= worldWidth) x -= worldWidth;
+        if (y >= worldHeight) y -= worldHeight;
+    }
+    return Point(x, y);
+}
+
+int Viewport::scroll(int origin, int focus, int window, int world) const {
+    if (window >= world) return 0;
+    int margin = window / 4;
+    int offset = focus - origin;
+    if (wraps) {
+        // The short way round, so a head just past the left edge scrolls left
+        if (offset >= world / 2) offset -= world;
+        if (offset < -world / 2) offset += world;
+    }
+    if (offset < margin) {
+        origin = focus - margin;
+    } else if (offset > window - 1 - margin) {
+        origin = focus - (window - 1 - margin);
+    }
+    return settle(origin, window, world);
+}
+
+int Viewport::settle(int origin, int window, int world) const {
+    if (window >= world) return 0;
+    if (wraps) {
+        origin %= world;
+        return origin < 0 ? origin + world : origin;
+    }
+    return std::clamp(origin, 0, world - window);
+}
+
+} // namespace SnakeGame
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "point.h"
+
+namespace SnakeGame {
+
+// The window of the world that is on screen. A world that fits is shown
+// whole from its top-left corner. A larger one scrolls: follow() keeps the
+// focus (the snake's head) at least a quarter of the window from each
+// edge, so the view only moves when the head nears an edge. On
+// wrap-around worlds the window may straddle the seam and positions wrap
+// with it; otherwise it stays inside the world.
+class Viewport {
+public:
+    Viewport(int worldWidth = 0, int worldHeight = 0, bool wraps = false);
+
+    // Window size in cells; clamped to the world
+    void resize(int columns, int rows);
+    void follow(const Point& focus);
+    void centerOn(const Point& focus);
+
+    // Screen position of a world cell; false when it is out of view
+    bool toScreen(const Point& world, Point& screen) const {
+        int dx = world.x - originX;
+        int dy = world.y - originY;
+        if (wraps) {
+            if (dx < 0) dx += worldWidth;
+            if (dy < 0) dy += worldHeight;
+        }
+        if (dx < 0 || dx >= columns || dy < 0 || dy >= rows) return false;
+        screen = Point(dx, dy);
+        return true;
+    }
+    // World cell under a screen position inside the window
+    Point toWorld(const Point& screen) const;
+
+    bool showsWholeWorld() const { return columns == worldWidth && rows == worldHeight; }
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+    Point getOrigin() const { return Point(originX, originY); }
+
+private:
+    int worldWidth;
+    int worldHeight;
+    bool wraps;
+    int columns;
+    int rows;
+    int originX;
+    int originY;
+
+    int scroll(int origin, int focus, int window, int world) const;
+    int settle(int origin, int window, int world) const;
+};
+
+} // namespace SnakeGame
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace SnakeGame {
+
+// Runs body(worker, item) once for every item in [0, count) on `threads`
+// threads and returns how many steals it took.
+//
+// Every worker starts with an equal slice of the items, kept as a
+// [begin, end) pair packed into one atomic word on its own cache line. The
+// owner takes items from the front of its slice; a worker whose slice has
+// run dry takes the back half of another's. Both are single
+// compare-and-swaps on the victim's word, so there are no locks and an
+// owner only contends with a thief when one is actually stealing. A worker
+// leaves once it finds every slice empty.
+//
+// body must be safe to call concurrently for different workers; per-worker
+// results indexed by `worker` need no synchronisation until this returns.
+template <typename Body>
+uint64_t runWorkStealing(uint64_t count, unsigned threads, Body body) {
+    // Slices hold 32-bit item numbers; larger runs go through in batches
+    constexpr uint64_t MAX_BATCH = 0xFFFFFFFFu;
+
+    struct alignas(64) Slice {
+        std::atomic<uint64_t> range{0};
+    };
+    auto pack = [](uint32_t begin, uint32_t end) {
+        return static_cast<uint64_t>(end) << 32 | begin;
+    };
+
+    threads = std::max(1u, threads);
+    std::unique_ptr<Slice[]> slices(new Slice[threads]);
+    std::atomic<uint64_t> steals(0);
+
+    for (uint64_t base = 0; base < count; base += MAX_BATCH) {
+        uint64_t batch = std::min(count - base, MAX_BATCH);
+        for (unsigned t = 0; t < threads; ++t) {
+            slices[t].range.store(pack(static_cast<uint32_t>(batch * t / threads),
+                                       static_cast<uint32_t>(batch * (t + 1) / threads)));
+        }
+
+        auto worker = [&](unsigned self) {
+            std::atomic<uint64_t>& own = slices[self].range;
+            uint64_t stolen = 0;
+            for (;;) {
+                uint64_t r = own.load(std::memory_order_acquire);
+                uint32_t begin = static_cast<uint32_t>(r);
+                uint32_t end = static_cast<uint32_t>(r >> 32);
+                if (begin < end) {
+                    if (own.compare_exchange_weak(r, pack(begin + 1, end), std::memory_order_acq_rel)) {
+                        body(self, base + begin);
+                    }
+                    continue;
+                }
+
+                // Out of work: take the back half of the first slice that
+                // has some, looking at the neighbours first
+                bool found = false;
+                for (unsigned k = 1; k < threads && !found; ++k) {
+                    std::atomic<uint64_t>& victim = slices[(self + k) % threads].range;
+                    uint64_t v = victim.load(std::memory_order_acquire);
+                    while (static_cast<uint32_t>(v) < static_cast<uint32_t>(v >> 32)) {
+                        uint32_t vBegin = static_cast<uint32_t>(v);
+                        uint32_t vEnd = static_cast<uint32_t>(v >> 32);
+                        uint32_t mid = vBegin + (vEnd - vBegin) / 2;
+                        if (victim.compare_exchange_weak(v, pack(vBegin, mid), std::memory_order_acq_rel)) {
+                            // Our slice is empty, so no thief can have
+                            // changed it in the meantime
+                            own.store(pack(mid, vEnd), std::memory_order_release);
+                            stolen++;
+                            found = true;
+                            break;
+                        }
+                    }
+                }
+                if (!found) break;
+            }
+            steals.fetch_add(stolen, std::memory_order_relaxed);
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t) {
+            pool.emplace_back(worker, t);
+        }
+        worker(0);
+        for (auto& thread : pool) {
+            thread.join();
+        }
+    }
+    return steals.load();
+}
+
+} // namespace SnakeGame